@@ -10,6 +10,7 @@
 
 #include <cal/calibration.hpp>
 #include <scorep/scorep.hpp>
+#include <util/hash.hpp>
 #include <util/log.hpp>
 
 #include <array>
@@ -26,15 +27,15 @@ namespace std
 // required hasher for unordered maps with array keys like e_state_state_map
 template <class T, size_t N> struct hash<std::array<T, N>>
 {
-    auto operator()(const std::array<T, N> &key) const
+    size_t operator()(const std::array<T, N> &key) const noexcept
     {
         std::hash<T> hasher;
-        size_t result = 0;
-        for (T t : key)
+        std::uint64_t result = N;
+        for (const T &t : key)
         {
-            result = result * 31 + hasher(t); // 31 to decrease possibility of collisions
+            result = rrl::hash::combine(result, hasher(t));
         }
-        return result;
+        return rrl::hash::finalize(result);
     }
 };
 } // namespace std
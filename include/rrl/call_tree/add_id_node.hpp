@@ -28,15 +28,16 @@ public:
     virtual std::vector<tmm::simple_callpath_element> build_callpath(std::string& value);
     virtual base_node* return_to_parent() override;
     virtual void reset_state() override;
+    virtual void invalidate() override;
     virtual bool callibrate_region(std::chrono::milliseconds significant_duration) override;
 
 private:
     std::string name_;
 
     std::hash<std::string> name_hash;
-    std::unordered_map<std::uint64_t, std::unique_ptr<value_node<std::uint64_t>>> child_uints;
-    std::unordered_map<std::int64_t, std::unique_ptr<value_node<std::int64_t>>> child_ints;
-    std::unordered_map<std::string, std::unique_ptr<value_node<std::string>>> child_string;
+    child_map<std::uint64_t, value_node<std::uint64_t>> child_uints;
+    child_map<std::int64_t, value_node<std::int64_t>> child_ints;
+    child_map<std::string, value_node<std::string>, 1> child_string;
 };
 }
 }
@@ -8,6 +8,11 @@
 
 #include <tmm/tuning_model_manager.hpp>
 
+#include <rrl/cm/parameter_slots.hpp>
+
+#include <rrl/call_tree/child_map.hpp>
+#include <rrl/call_tree/node_arena.hpp>
+
 namespace rrl
 {
 namespace call_tree
@@ -54,6 +59,7 @@ struct node_info
               additionalidentifier is left. See rts_handler::exit_region() for details*/
     bool child_with_configuration =
         false; /*< set to true if some child, no matter how deep, has already a configuration.*/
+    double energy_begin = 0; /*< energy metric when the node was entered for calibration */
 };
 
 class not_implemented : public std::logic_error
@@ -97,11 +103,27 @@ public:
      */
     virtual void reset_state();
 
+    /** resets the state of this node only, like reset_state() does for each node. Used if a change
+     * of the tuning model affects only some nodes.
+     */
+    virtual void invalidate();
+
     /** returns the callpath from root to the current call_tree node element
      *
      */
     virtual std::vector<tmm::simple_callpath_element> build_callpath();
 
+    /** returns the id of the callpath of this node in table. The callpath is only built and
+     * interned at the first call, later calls return the cached id.
+     *
+     * All calls to one node have to pass the same table.
+     */
+    tmm::callpath_id callpath_id(tmm::callpath_table &table);
+
+    /** returns true and sets id, if the callpath of this node is interned already
+     */
+    bool cached_callpath_id(tmm::callpath_id &id) const noexcept;
+
     /** This function wights the amount of siginificant regions versus the amount of not
      * siginificnat regions, that are called from this element.
      *
@@ -134,61 +156,76 @@ public:
     virtual bool callibrate_region(std::chrono::milliseconds significant_threshold);
 
     /** saves the configuration, and triggers parent_->set_child_with_configuration().
+     *
+     * The configuration is converted to slots when it is assigned, see
+     * \ref parameter_controller::to_slots, so entering the node does not look up the parameters.
      */
-    virtual void set_configuration(const std::vector<tmm::parameter_tuple> &configuration);
+    virtual void set_configuration(const cm::slot_setting &configuration);
 
     /** returns the configuration
      *
      */
-    virtual const std::vector<tmm::parameter_tuple> &get_configuration();
+    virtual const cm::slot_setting &get_configuration();
 
     /** ensures that the parent knows that a some child, a child of a child, ... has a config set.
      *
      */
     virtual void set_child_with_configuration();
 
+    /** returns the arena, which holds all nodes of the call tree of this node
+     */
+    inline node_arena &arena() noexcept
+    {
+        return *arena_;
+    }
+
     base_node *parent_;
     node_info info;
 
 private:
+    std::unique_ptr<node_arena> owned_arena_; /**< only set for the root of a call tree */
+    node_arena *arena_;
+
+    bool has_callpath_id_ = false;
+    tmm::callpath_id callpath_id_ = 0;
+
     std::chrono::high_resolution_clock::time_point node_start;
     std::chrono::high_resolution_clock::time_point node_stop;
-    std::vector<tmm::parameter_tuple> configuration_;
+    cm::slot_setting configuration_;
 };
 
-template <typename NodeType, typename ParentType, typename ValueType>
+/** Returns the child node of parent for value. If it does not exist yet, it is created in the
+ * arena of the call tree.
+ */
+template <typename NodeType, typename ParentType, typename ValueType, std::size_t InlineCapacity>
 NodeType *add_and_get(ParentType *parent,
     node_info info,
     ValueType value,
-    std::unordered_map<ValueType, std::unique_ptr<NodeType>> &map)
+    child_map<ValueType, NodeType, InlineCapacity> &map)
 {
-    auto node_it = map.find(value);
-    if (node_it != map.end())
-    {
-        return node_it->second.get();
-    }
-    else
+    auto node = map.find(value);
+    if (node == nullptr)
     {
-        auto node = map.emplace(value, std::make_unique<NodeType>(parent, info, value));
-        return node.first->second.get();
+        node = parent->arena().template create<NodeType>(parent, info, value);
+        map.insert(value, node);
     }
+    return node;
 }
 
-template <typename NodeType, typename ParentType>
-NodeType *add_and_get(ParentType *parent,
-    node_info info,
-    std::unordered_map<std::uint32_t, std::unique_ptr<NodeType>> &map)
+/** Returns the child region node of parent for info.region_id. If it does not exist yet, it is
+ * created in the arena of the call tree.
+ */
+template <typename NodeType, typename ParentType, std::size_t InlineCapacity>
+NodeType *add_and_get(
+    ParentType *parent, node_info info, child_map<std::uint32_t, NodeType, InlineCapacity> &map)
 {
-    auto node_it = map.find(info.region_id);
-    if (node_it != map.end())
-    {
-        return node_it->second.get();
-    }
-    else
+    auto node = map.find(info.region_id);
+    if (node == nullptr)
     {
-        auto node = map.emplace(info.region_id, std::make_unique<NodeType>(parent, info));
-        return node.first->second.get();
+        node = parent->arena().template create<NodeType>(parent, info);
+        map.insert(info.region_id, node);
     }
+    return node;
 }
 
 inline void get_durations(std::chrono::milliseconds significant_threshold,
@@ -199,17 +236,16 @@ inline void get_durations(std::chrono::milliseconds significant_threshold,
     return;
 }
 
-template <class NodeType, typename ValueType, class... RemainingMaps>
+template <class NodeType, typename ValueType, std::size_t InlineCapacity, class... RemainingMaps>
 void get_durations(std::chrono::milliseconds significant_threshold,
     std::chrono::milliseconds &significant_durations,
     std::chrono::milliseconds &insignificant_durations,
     bool &any_sig_child,
-    const std::unordered_map<ValueType, std::unique_ptr<NodeType>> &map,
+    const child_map<ValueType, NodeType, InlineCapacity> &map,
     const RemainingMaps &... maps)
 {
-    for (const auto &elem : map)
-    {
-        auto duration = elem.second->info.duration;
+    map.for_each([&](const NodeType *node) {
+        auto duration = node->info.duration;
         if (duration >= significant_threshold)
         {
             significant_durations += duration;
@@ -219,7 +255,7 @@ void get_durations(std::chrono::milliseconds significant_threshold,
         {
             insignificant_durations += duration;
         }
-    }
+    });
     get_durations(significant_threshold,
         significant_durations,
         insignificant_durations,
@@ -0,0 +1,108 @@
+#ifndef INCLUDE_RRL_CALL_TREE_CHILD_MAP_HPP_
+#define INCLUDE_RRL_CALL_TREE_CHILD_MAP_HPP_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+
+namespace rrl
+{
+namespace call_tree
+{
+/** Maps the keys of the children of a call tree node to the child nodes.
+ *
+ * Most nodes have only a few children. Up to InlineCapacity children are kept in arrays inside of
+ * the node and found by a linear search over the keys. When more children are added, all of them
+ * are moved to a hash map.
+ *
+ * The nodes are not owned by the map, see \ref node_arena.
+ */
+template <typename Key, typename NodeType, std::size_t InlineCapacity = 4> class child_map
+{
+public:
+    /** returns the child with the given key, or nullptr if there is none
+     */
+    inline NodeType *find(const Key &key) const noexcept
+    {
+        if (size_ <= InlineCapacity)
+        {
+            for (std::size_t i = 0; i < size_; i++)
+            {
+                if (keys_[i] == key)
+                {
+                    return nodes_[i];
+                }
+            }
+            return nullptr;
+        }
+        auto it = hashed_->find(key);
+        if (it != hashed_->end())
+        {
+            return it->second;
+        }
+        return nullptr;
+    }
+
+    /** adds a child. The key must not be present in the map yet.
+     */
+    void insert(const Key &key, NodeType *node)
+    {
+        if (size_ < InlineCapacity)
+        {
+            keys_[size_] = key;
+            nodes_[size_] = node;
+        }
+        else
+        {
+            if (size_ == InlineCapacity)
+            {
+                hashed_ = std::make_unique<std::unordered_map<Key, NodeType *>>();
+                for (std::size_t i = 0; i < InlineCapacity; i++)
+                {
+                    hashed_->emplace(keys_[i], nodes_[i]);
+                    keys_[i] = Key();
+                }
+            }
+            hashed_->emplace(key, node);
+        }
+        size_++;
+    }
+
+    inline std::size_t size() const noexcept
+    {
+        return size_;
+    }
+
+    /** calls function(node) for each child
+     */
+    template <typename Function> void for_each(Function function) const
+    {
+        if (size_ <= InlineCapacity)
+        {
+            for (std::size_t i = 0; i < size_; i++)
+            {
+                function(nodes_[i]);
+            }
+        }
+        else
+        {
+            for (const auto &elem : *hashed_)
+            {
+                function(elem.second);
+            }
+        }
+    }
+
+private:
+    std::array<Key, InlineCapacity> keys_;
+    std::array<NodeType *, InlineCapacity> nodes_;
+    std::uint32_t size_ = 0;
+    /** all children, once there are more than InlineCapacity */
+    std::unique_ptr<std::unordered_map<Key, NodeType *>> hashed_;
+};
+}
+}
+
+#endif /* INCLUDE_RRL_CALL_TREE_CHILD_MAP_HPP_ */
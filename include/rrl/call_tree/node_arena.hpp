@@ -0,0 +1,70 @@
+#ifndef INCLUDE_RRL_CALL_TREE_NODE_ARENA_HPP_
+#define INCLUDE_RRL_CALL_TREE_NODE_ARENA_HPP_
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace rrl
+{
+namespace call_tree
+{
+class base_node;
+
+/** Allocates the nodes of a call tree from large contiguous blocks.
+ *
+ * Nodes are never freed one by one, they live as long as the arena, which is owned by the root of
+ * the call tree. Nodes that are created one after another, like a parent and the first children
+ * entered from it, end up next to each other in memory.
+ *
+ * The arena is not thread safe. A call tree, and hence its arena, is only used by one thread.
+ */
+class node_arena
+{
+public:
+    node_arena() = default;
+    node_arena(const node_arena &) = delete;
+    node_arena &operator=(const node_arena &) = delete;
+    ~node_arena();
+
+    /** constructs a new node of type NodeType in the arena, and returns a pointer to it.
+     */
+    template <typename NodeType, typename... Args> NodeType *create(Args &&... args)
+    {
+        void *memory = allocate(sizeof(NodeType), alignof(NodeType));
+        auto node = new (memory) NodeType(std::forward<Args>(args)...);
+        nodes_.push_back(node);
+        return node;
+    }
+
+    /** calls function for each node of the arena, in the order of creation
+     */
+    template <typename Function> void for_each(Function function) const
+    {
+        for (auto node : nodes_)
+            function(node);
+    }
+
+    /** returns the number of nodes created in this arena
+     */
+    inline std::size_t size() const noexcept
+    {
+        return nodes_.size();
+    }
+
+private:
+    void *allocate(std::size_t size, std::size_t alignment);
+
+    static constexpr std::size_t block_size = 64 * 1024;
+
+    std::vector<std::unique_ptr<char[]>> blocks_;
+    char *current_ = nullptr; /**< next free byte in the last block */
+    std::size_t left_ = 0;    /**< free bytes in the last block */
+    std::vector<base_node *> nodes_; /**< all nodes, in order of creation */
+};
+}
+}
+
+#endif /* INCLUDE_RRL_CALL_TREE_NODE_ARENA_HPP_ */
@@ -22,11 +22,12 @@ public:
     virtual base_node* enter_node(std::string& name) override;
     virtual std::vector<tmm::simple_callpath_element> build_callpath() override;
     virtual void reset_state() override;
+    virtual void invalidate() override;
     virtual bool callibrate_region(std::chrono::milliseconds significant_duration) override;
 
 private:
-    std::unordered_map<std::uint32_t, std::unique_ptr<region_node>> child_regions;
-    std::unordered_map<std::string, std::unique_ptr<add_id_node>> child_add_ids;
+    child_map<std::uint32_t, region_node> child_regions;
+    child_map<std::string, add_id_node, 1> child_add_ids;
 };
 }
 }
@@ -27,14 +27,15 @@ public:
 
     virtual std::vector<tmm::simple_callpath_element> build_callpath() override;
     virtual void reset_state() override;
+    virtual void invalidate() override;
     virtual bool callibrate_region(std::chrono::milliseconds significant_duration) override;
 
 private:
     add_id_node* parent_;
     T value_;
 
-    std::unordered_map<std::uint32_t, std::unique_ptr<region_node>> child_regions;
-    std::unordered_map<std::string, std::unique_ptr<add_id_node>> child_add_ids;
+    child_map<std::uint32_t, region_node> child_regions;
+    child_map<std::string, add_id_node, 1> child_add_ids;
 };
 
 template class value_node<std::int64_t>;
@@ -13,12 +13,14 @@
 #include <cstring>
 #include <fstream>
 #include <iostream>
+#include <memory>
 #include <mutex>
 #include <sstream>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include <rrl/cm/parameter_slots.hpp>
 #include <tmm/parameter_tuple.hpp>
 #include <util/log.hpp>
 
@@ -31,41 +33,56 @@ using setting = std::vector<tmm::parameter_tuple>;
 
 /** This class controls the settings stack.
  *
+ * The configurations are \ref slot_setting's, indexed by the slots of the \ref parameter_slots of
+ * the \ref parameter_controller.
  */
 class cm_base
 {
 public:
-    inline constexpr cm_base() noexcept = default;
-    ~cm_base() = default;
-    virtual void set(setting config) = 0;
-    virtual setting unset() = 0;
+    inline cm_base() noexcept = default;
+    virtual ~cm_base() = default;
+
+    /** sets a new configuration, parameters missing in config keep their current values
+     *
+     * @param config new configuration
+     */
+    virtual void set(const slot_setting &config) = 0;
+
+    /** removes the last configuration
+     *
+     * @return the slots whose value changed, the restored values are in \ref current
+     */
+    virtual std::uint64_t unset() = 0;
 
     /** sets ATP
      *
      * If the ATP doesn't exist in the current configuration it will be saved there.
      *
-     * @param atp application tuning parameter
+     * @param slot slot of the application tuning parameter
+     * @param value value of the application tuning parameter
      *
      **/
-    virtual void atp_add(tmm::parameter_tuple hash) = 0;
+    virtual void atp_add(std::size_t slot, int value) = 0;
 
-    /** returns a copy of the current configuration.
+    /** returns the current configuration.
      *
-     * @return returns a copy of the current configuration.
+     * @return returns the current configuration, which is valid until the stack is changed.
      *
      */
-    virtual setting get_current_config() = 0;
+    virtual const slot_setting &current() const = 0;
 };
 
 /**Returns a concrete configuration manager
  *
- * If check_if_reset's value is "no_reset" the cm_no_reset variant is created.
+ * If check_if_reset's value is "no_reset" the cm_no_reset variant is created, if it is "delta"
+ * the cm_delta variant.
  * Otherwise the reset variant is created as it is the default.
  *
  * @return returns cm
  *
  */
-std::unique_ptr<cm_base> create_new_instance(setting config, std::string check_if_reset);
+std::unique_ptr<cm_base> create_new_instance(
+    const slot_setting &config, const std::string &check_if_reset);
 }
 }
 
@@ -0,0 +1,72 @@
+#ifndef INCLUDE_CM_DELTA_HPP_
+#define INCLUDE_CM_DELTA_HPP_
+
+#include <cstdint>
+#include <vector>
+
+#include <rrl/cm/cm_base.hpp>
+#include <util/log.hpp>
+
+namespace rrl
+{
+namespace cm
+{
+
+/** This class controls the settings stack, storing only the changes of every level.
+ *
+ * It behaves like \ref cm_reset, but instead of a copy of the whole configuration per level, only
+ * the previous values of the parameters that a level changes are stored. The levels and the old
+ * values are kept in two stacks, which are preallocated and only grow for deeply nested regions,
+ * so setting and unsetting a configuration does not allocate.
+ *
+ */
+class cm_delta : public cm_base
+{
+public:
+    /**
+     * Constructor
+     *
+     * @brief Constructor
+     *
+     * Initializes the configuration manager with the default configuration.
+     *
+     * @param default_configs default configuration
+     *
+     **/
+    cm_delta(const slot_setting &default_configs);
+
+    /** sets parameter
+     *
+     * Applies the new configuration, and saves the old values of the parameters that change. If
+     * parameters are missing in the new configuration the current ones will be used.
+     *
+     * @param new_configs new configuration
+     *
+     **/
+    void set(const slot_setting &new_configs) override;
+
+    /** removes last configuration by restoring the saved values.
+     *
+     * @return returns the slots whose value changed.
+     *
+     */
+    std::uint64_t unset() override;
+    void atp_add(std::size_t slot, int value) override;
+    const slot_setting &current() const override;
+
+private:
+    /** the changes of one level of the stack */
+    struct level
+    {
+        std::uint64_t changed; /**< slots whose old values are saved */
+        std::uint64_t added;   /**< slots which had no value before */
+    };
+
+    slot_setting current_;        /**< the configuration of the top level */
+    std::vector<level> levels_;   /**< one entry per set configuration */
+    std::vector<int> old_values_; /**< old values of the changed slots of all levels */
+};
+}
+}
+
+#endif /* INCLUDE_CM_DELTA_HPP_ */
@@ -47,7 +47,7 @@ public:
      * @param default_configs default configuration
      *
      **/
-    cm_no_reset(setting default_configs);
+    cm_no_reset(const slot_setting &default_configs);
 
     /**
  * Destructor
@@ -71,19 +71,19 @@ public:
      * @param new_configs new configuration
      *
      **/
-    void set(setting configs) override;
+    void set(const slot_setting &configs) override;
 
-    /** returns a copy of the current configuration.
+    /** keeps the current configuration.
      *
-     * @return returns a copy of the current configuration.
+     * @return returns 0, as no parameter changes.
      *
      */
-    setting unset() override;
-    void atp_add(tmm::parameter_tuple hash) override;
-    setting get_current_config() override;
+    std::uint64_t unset() override;
+    void atp_add(std::size_t slot, int value) override;
+    const slot_setting &current() const override;
 
 private:
-    setting settings; /**< settings stack with configurations consisting of parameter tuples*/
+    slot_setting settings; /**< settings stack with configurations consisting of parameter tuples*/
 };
 }
 }
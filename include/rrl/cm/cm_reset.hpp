@@ -47,7 +47,7 @@ public:
      * @param default_configs default configuration
      *
      **/
-    cm_reset(setting default_configs);
+    cm_reset(const slot_setting &default_configs);
 
     /**
      * Destructor
@@ -66,19 +66,19 @@ public:
      * @param new_configs new configuration
      *
      **/
-    void set(setting configs) override;
+    void set(const slot_setting &configs) override;
 
-    /** removes last configuration and returns a copy of the current configuration.
+    /** removes last configuration.
      *
-     * @return returns a copy of the current configuration.
+     * @return returns the slots whose value changed.
      *
      */
-    setting unset() override;
-    void atp_add(tmm::parameter_tuple hash) override;
-    setting get_current_config() override;
+    std::uint64_t unset() override;
+    void atp_add(std::size_t slot, int value) override;
+    const slot_setting &current() const override;
 
 private:
-    std::vector<setting>
+    std::vector<slot_setting>
         settings; /**< settings stack with configurations consisting of parameter tuples*/
 };
 }
@@ -0,0 +1,145 @@
+#ifndef INCLUDE_RRL_CM_PARAMETER_SLOTS_HPP_
+#define INCLUDE_RRL_CM_PARAMETER_SLOTS_HPP_
+
+#include <tmm/parameter_tuple.hpp>
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <unordered_set>
+#include <vector>
+
+namespace rrl
+{
+namespace cm
+{
+/** maximal number of distinct parameters, one bit of a mask per parameter */
+constexpr std::size_t max_slots = 64;
+
+/** A configuration of the parameters, indexed by the slots of \ref parameter_slots.
+ *
+ * A setting has a fixed size and does not allocate. The bit of a slot in the mask is set if the
+ * setting has a value for the parameter of this slot.
+ */
+struct slot_setting
+{
+    inline slot_setting() noexcept : mask(0)
+    {
+        values.fill(0);
+    }
+
+    inline bool has(std::size_t slot) const noexcept
+    {
+        return (mask >> slot) & 1;
+    }
+
+    inline void set(std::size_t slot, int value) noexcept
+    {
+        values[slot] = value;
+        mask |= std::uint64_t(1) << slot;
+    }
+
+    /** Overwrites the values of all slots of other. This is a branch free loop over all slots.
+     */
+    inline void merge(const slot_setting &other) noexcept
+    {
+        for (std::size_t slot = 0; slot < max_slots; slot++)
+        {
+            values[slot] = other.has(slot) ? other.values[slot] : values[slot];
+        }
+        mask |= other.mask;
+    }
+
+    /** Returns the slots of target, whose value differs from current, or which current does not
+     * have. This is a branch free loop over all slots.
+     */
+    static inline std::uint64_t changes(
+        const slot_setting &current, const slot_setting &target) noexcept
+    {
+        std::uint64_t differs = 0;
+        for (std::size_t slot = 0; slot < max_slots; slot++)
+        {
+            differs |= std::uint64_t(current.values[slot] != target.values[slot]) << slot;
+        }
+        return target.mask & (differs | ~current.mask);
+    }
+
+    std::array<int, max_slots> values;
+    std::uint64_t mask;
+};
+
+/** calls f(slot) for every slot whose bit is set in mask, in ascending order
+ */
+template <typename F> inline void for_each_slot(std::uint64_t mask, F f)
+{
+    while (mask != 0)
+    {
+        f(static_cast<std::size_t>(__builtin_ctzll(mask)));
+        mask &= mask - 1;
+    }
+}
+
+/** Assigns a dense slot to every parameter id, the hash of the parameter name.
+ *
+ * The parameters of the plugins get their slots when the plugins are loaded, ATPs when they are
+ * declared or first seen in a configuration. Slots are never removed. Looking up a slot does not
+ * lock, only adding a parameter does.
+ */
+class parameter_slots
+{
+public:
+    static constexpr std::size_t npos = max_slots;
+
+    parameter_slots() noexcept;
+
+    /** returns the slot of parameter_id, npos if the parameter has no slot
+     */
+    inline std::size_t find(std::size_t parameter_id) const noexcept
+    {
+        auto size = size_.load(std::memory_order_acquire);
+        for (std::size_t slot = 0; slot < size; slot++)
+        {
+            if (ids_[slot].load(std::memory_order_relaxed) == parameter_id)
+            {
+                return slot;
+            }
+        }
+        return npos;
+    }
+
+    /** returns the slot of parameter_id, and adds the parameter if it has no slot yet
+     *
+     * @return npos if all slots are used, which is logged once per parameter
+     */
+    std::size_t add(std::size_t parameter_id);
+
+    /** returns the parameter id of a slot
+     */
+    inline std::size_t id(std::size_t slot) const noexcept
+    {
+        return ids_[slot].load(std::memory_order_relaxed);
+    }
+
+    inline std::size_t size() const noexcept
+    {
+        return size_.load(std::memory_order_acquire);
+    }
+
+    /** converts a configuration, parameters without slot are added
+     */
+    slot_setting to_slots(const std::vector<tmm::parameter_tuple> &configs);
+
+    std::vector<tmm::parameter_tuple> to_tuples(const slot_setting &setting) const;
+
+private:
+    std::array<std::atomic<std::size_t>, max_slots> ids_;
+    std::atomic<std::size_t> size_;
+    std::mutex add_lock_;
+    std::unordered_set<std::size_t> ignored_; /**< parameters without slot, by add_lock_ */
+};
+} // namespace cm
+} // namespace rrl
+
+#endif /* INCLUDE_RRL_CM_PARAMETER_SLOTS_HPP_ */
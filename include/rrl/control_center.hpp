@@ -35,6 +35,7 @@
 #include <rrl/filter.hpp>
 #include <rrl/metric_manager.hpp>
 #include <rrl/oa_event_receiver.hpp>
+#include <rrl/overhead_statistics.hpp>
 #include <rrl/rts_handler.hpp>
 #include <scorep/scorep.hpp>
 
@@ -44,6 +45,7 @@
 #include <cstdint>
 #include <memory>
 #include <mutex>
+#include <unordered_map>
 
 /** This namespace holds all elements that are related to the RRL.
  *
@@ -133,6 +135,23 @@ public:
     }
 
 private:
+    void trace_region_event(
+        const char *event, struct SCOREP_Location *location, SCOREP_RegionHandle regionHandle);
+    bool is_included(SCOREP_RegionHandle regionHandle, std::uint32_t region_id);
+
+    /** Data that is kept for each location. It is only accessed by the thread of the location,
+     * except for its creation.
+     */
+    struct location_data
+    {
+        int fork_depth = 0;     /**< OpenMP thread teams forked by this location, and not joined */
+        rts_handler *rts = nullptr; /**< handler for the location, rts_ for location 0 */
+        std::unique_ptr<rts_handler> worker_rts; /**< owns the handler of a worker location */
+        team_registry::team team; /**< team of a worker location, set by create_location */
+    };
+
+    location_data &local_location(std::uint32_t location_id);
+
     std::shared_ptr<tmm::tuning_model_manager> tmm_; /**< holds the \ref tmm::tuning_model_manager*/
     std::shared_ptr<rrl::metric_manager> mm_;        /**< holds the \ref rrl::metric_manager*/
     std::shared_ptr<cal::calibration> cal_;          /**< holds the \ref cal::calibrationr*/
@@ -157,19 +176,18 @@ private:
         "delete_location_i",
         "user_parameter_i"}};
 
-    std::vector<std::uint64_t> invocation_count;
-    std::vector<std::chrono::nanoseconds> invocation_duration;
-    std::vector<std::uint64_t> invocation_variance_x_2;
-
     rts_handler rts_;                     /**< holds the @ref rts_handler*/
     oa_event_receiver oa_event_receiver_; /**< holds the @ref oa_event_receiver*/
     filter filter_;                       /**< holds the @ref filter*/
+    overhead_statistics statistics_;      /**< runtime of the RRL per event type */
 
     std::string hostname; /**< the hostname of the device we are curently on */
 
     std::mutex location_loock;
 
-    int count_forks_joins = 0;
+    bool per_location_tuning_ = false; /**< tune the regions of all locations, not just 0 */
+    std::unordered_map<std::uint32_t, std::unique_ptr<location_data>>
+        locations_; /**< data for all locations, protected by location_loock */
 };
 }
 
@@ -1,6 +1,12 @@
+#include <rrl/pattern_set.hpp>
 #include <util/environment.hpp>
 
+#include <array>
+#include <atomic>
+#include <cstdint>
 #include <fstream>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -13,6 +19,15 @@ namespace rrl
 class filter
 {
 public:
+    /** Result of the filter for a region, as cached in \ref region_decisions.
+     */
+    enum class decision : std::uint8_t
+    {
+        unknown, /**< the region was not checked yet */
+        include,
+        exclude
+    };
+
     filter();
     ~filter();
 
@@ -20,7 +35,36 @@ public:
 
     std::vector<std::string> splithelper(std::string str);
 
-    bool check_region(std::string region_name);
+    bool check_region(const std::string &region_name) const;
+
+    bool register_region(std::uint32_t region_id, const std::string &region_name);
+
+    /** Returns the cached filter decision for a region.
+     *
+     * The decision is computed once by \ref register_region. If the region was never registered
+     * decision::unknown is returned, and the caller is supposed to call \ref register_region.
+     *
+     * @param region_id Score-P region id
+     * @return cached decision for the region
+     */
+    inline decision cached_decision(std::uint32_t region_id) const noexcept
+    {
+        if (no_filtering)
+        {
+            return decision::include;
+        }
+        auto index = region_id / decision_chunk_size;
+        if (index >= max_decision_chunks)
+        {
+            return decision::unknown;
+        }
+        auto chunk = region_decisions[index].load(std::memory_order_acquire);
+        if (chunk == nullptr)
+        {
+            return decision::unknown;
+        }
+        return (*chunk)[region_id % decision_chunk_size].load(std::memory_order_relaxed);
+    }
 
 	std::string removeSpaces(std::string str);
 
@@ -34,10 +78,23 @@ private:
     /** Holds all region names, that should be excluded.
      * Empty if all regions should be excluded and only some included.
      **/
-    std::vector<std::string> excluded_regions;
+    pattern_set excluded_regions;
     /** Holds all region names, that should be included.
      * Empty if all regions should be included and only some are excluded.
      **/
-    std::vector<std::string> included_regions;
+    pattern_set included_regions;
+
+    static constexpr std::size_t decision_chunk_size = 4096;
+    static constexpr std::size_t max_decision_chunks = 1024;
+    using decision_chunk = std::array<std::atomic<decision>, decision_chunk_size>;
+
+    /** Holds the filter decision for each registered region, indexed by the Score-P region id.
+     * Score-P region ids are dense, so usually only the first chunk is allocated. Chunks are never
+     * moved once they are published, so other threads can read decisions while new regions are
+     * registered. Regions with an id beyond the last chunk are not cached.
+     **/
+    std::array<std::atomic<decision_chunk *>, max_decision_chunks> region_decisions;
+    std::vector<std::unique_ptr<decision_chunk>> decision_chunks; /**< owns the chunks */
+    std::mutex register_lock; /**< serialises \ref register_region */
 };
 }
@@ -8,6 +8,7 @@
 #ifndef INCLUDE_RRL_METRIC_MANAGER_HPP_
 #define INCLUDE_RRL_METRIC_MANAGER_HPP_
 
+#include <cmath>
 #include <map>
 #include <vector>
 
@@ -63,6 +64,23 @@ template <typename T> inline T metric_convert(std::uint64_t v) noexcept
     union_value.uint64 = v;
     return union_value.type;
 }
+
+/** converts a metric value of the given type to double, returns NaN for invalid types
+ */
+inline double metric_to_double(std::uint64_t v, SCOREP_MetricValueType type) noexcept
+{
+    switch (type)
+    {
+        case SCOREP_METRIC_VALUE_INT64:
+            return static_cast<double>(metric_convert<std::int64_t>(v));
+        case SCOREP_METRIC_VALUE_UINT64:
+            return static_cast<double>(v);
+        case SCOREP_METRIC_VALUE_DOUBLE:
+            return metric_convert<double>(v);
+        default:
+            return std::nan("");
+    }
+}
 }
 
 #endif /* INCLUDE_RRL_METRIC_MANAGER_HPP_ */
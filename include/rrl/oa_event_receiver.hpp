@@ -61,6 +61,7 @@ private:
 
     void parse_command_v0_1(const nlohmann::json &command_json);
     void parse_command_v0_2(const nlohmann::json &command_json);
+    void parse_reload_command(const nlohmann::json &command_json);
 };
 }
 
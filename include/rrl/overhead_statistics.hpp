@@ -0,0 +1,153 @@
+#ifndef INCLUDE_RRL_OVERHEAD_STATISTICS_HPP_
+#define INCLUDE_RRL_OVERHEAD_STATISTICS_HPP_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace rrl
+{
+
+/** Histogram for latencies in nanoseconds with logarithmic buckets, similar to a HDR histogram.
+ *
+ * Values below 2^sub_bucket_bits get their own bucket. Above that, every power of two is split
+ * into 2^sub_bucket_bits linear sub buckets, so the relative error of a reported value is below
+ * 2^-sub_bucket_bits (about 6%), for the whole range of std::uint64_t.
+ *
+ * Recording a value is a few integer operations and does not allocate.
+ */
+class latency_histogram
+{
+public:
+    static constexpr int sub_bucket_bits = 4;
+    static constexpr std::size_t sub_buckets = 1 << sub_bucket_bits;
+    static constexpr std::size_t bucket_count = (64 - sub_bucket_bits + 1) * sub_buckets;
+
+    latency_histogram();
+
+    /** records a single value
+     */
+    inline void record(std::uint64_t value) noexcept
+    {
+        buckets_[index_of(value)]++;
+        count_++;
+        if (value > max_)
+        {
+            max_ = value;
+        }
+    }
+
+    void merge(const latency_histogram &other) noexcept;
+
+    std::uint64_t percentile(double percent) const noexcept;
+
+    inline std::uint64_t count() const noexcept
+    {
+        return count_;
+    }
+
+    inline std::uint64_t max() const noexcept
+    {
+        return max_;
+    }
+
+    /** returns the number of values counted in the bucket with the given index
+     */
+    inline std::uint64_t bucket(std::size_t index) const noexcept
+    {
+        return buckets_[index];
+    }
+
+    /** returns the index of the bucket value belongs to
+     */
+    static inline std::size_t index_of(std::uint64_t value) noexcept
+    {
+        if (value < sub_buckets)
+        {
+            return value;
+        }
+        int shift = 63 - __builtin_clzll(value) - sub_bucket_bits;
+        return (shift + 1) * sub_buckets + ((value >> shift) & (sub_buckets - 1));
+    }
+
+    static std::uint64_t lowest_value_of(std::size_t index) noexcept;
+    static std::uint64_t highest_value_of(std::size_t index) noexcept;
+
+private:
+    std::array<std::uint64_t, bucket_count> buckets_;
+    std::uint64_t count_ = 0;
+    std::uint64_t max_ = 0;
+};
+
+/** Overhead statistics for one type of event.
+ *
+ * The trailing padding keeps the statistics of different threads on different cache lines, as
+ * they are stored in separate buffers.
+ */
+struct event_statistics
+{
+    std::uint64_t count = 0;
+    std::chrono::nanoseconds duration = std::chrono::nanoseconds(0);
+    double duration_x_2 = 0; /**< sum of the squared durations in ns*ns */
+    latency_histogram histogram;
+
+    inline void record(std::chrono::nanoseconds value) noexcept
+    {
+        count++;
+        duration += value;
+        duration_x_2 += static_cast<double>(value.count()) * value.count();
+        histogram.record(value.count() < 0 ? 0 : value.count());
+    }
+
+    void merge(const event_statistics &other) noexcept;
+
+private:
+    char padding_[64];
+};
+
+/** Collects the runtime of the RRL for different types of events.
+ *
+ * Every thread records into its own set of \ref event_statistics, which is allocated by the thread
+ * itself at its first event, so recording needs neither locks nor atomics. The per thread
+ * statistics are only merged by \ref merge(), which is supposed to be called at finalization, when
+ * no further events are recorded.
+ *
+ * The threads find their statistics by the serial number of the instance, which is never reused,
+ * so a new instance at the address of a destroyed one gets new statistics.
+ */
+class overhead_statistics
+{
+public:
+    overhead_statistics(std::vector<std::string> event_names);
+
+    /** records the duration of a single event of type event for the calling thread
+     */
+    inline void record(std::size_t event, std::chrono::nanoseconds duration)
+    {
+        local_statistics()[event].record(duration);
+    }
+
+    std::vector<event_statistics> merge() const;
+
+    void print() const;
+
+    void write_json(const std::string &file_name) const;
+
+private:
+    std::vector<event_statistics> &local_statistics();
+
+    std::vector<std::string> event_names_;
+    std::uint64_t serial_; /**< unique for every instance of the process */
+
+    /** protects threads_, only taken at the first event of a thread */
+    mutable std::mutex threads_lock_;
+    std::vector<std::unique_ptr<std::vector<event_statistics>>> threads_;
+};
+}
+
+#endif /* INCLUDE_RRL_OVERHEAD_STATISTICS_HPP_ */
@@ -8,14 +8,21 @@
 #ifndef INCLUDE_PARAMETER_CONTROLLER_HPP_
 #define INCLUDE_PARAMETER_CONTROLLER_HPP_
 
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <cstdint>
 #include <functional>
 #include <map>
 #include <memory>
 #include <mutex>
+#include <vector>
 
 #include <rrl/cm/cm_base.hpp>
+#include <rrl/cm/parameter_slots.hpp>
+#include <rrl/parameter_switcher.hpp>
 #include <rrl/pcp_handler.hpp>
+#include <rrl/switch_cost_model.hpp>
 #include <scorep/scorep.hpp>
 #include <tmm/parameter_tuple.hpp>
 
@@ -28,6 +35,21 @@ namespace rrl
  * and sets itself just the values that are given through \ref set_parameters and
  * \ref unset_parameters
  *
+ * Every parameter has a slot in \ref parameter_slots, the plugin parameters get theirs when the
+ * plugins are loaded. The settings stacks hold \ref cm::slot_setting's, so comparing the current
+ * and a new configuration does not search or allocate. The call tree nodes convert their
+ * configuration with \ref to_slots when it is assigned, so entering a region does not look up
+ * the parameters either.
+ *
+ * TPs of plugins that implement enter_region_set_configs and exit_region_set_configs are set with
+ * one call per plugin.
+ *
+ * If SCOREP_RRL_ASYNC_SWITCH is true, the changes of the process wide settings stack are applied
+ * by a \ref parameter_switcher thread, so the application does not wait for the plugins.
+ *
+ * If SCOREP_RRL_SWITCH_COST_FACTOR is set, a \ref switch_cost_model skips the configurations of
+ * regions which are too short compared to the latency of switching the parameters.
+ *
  */
 class parameter_controller
 {
@@ -38,9 +60,24 @@ public:
         return s;
     }
 
-    void set_parameters(std::vector<tmm::parameter_tuple> configs);
+    bool set_parameters(const cm::slot_setting &configs,
+        std::chrono::milliseconds duration = std::chrono::milliseconds::max());
     void unset_parameters();
 
+    bool set_parameters(const cm::slot_setting &configs,
+        cm::cm_base &stack,
+        std::chrono::milliseconds duration = std::chrono::milliseconds::max());
+    void unset_parameters(cm::cm_base &stack);
+
+    /** converts a configuration to slots, parameters without slot are added
+     */
+    inline cm::slot_setting to_slots(const std::vector<tmm::parameter_tuple> &configs)
+    {
+        return slots_.to_slots(configs);
+    }
+
+    std::unique_ptr<cm::cm_base> create_configuration_stack() const;
+
     void create_location(SCOREP_LocationType location_type, std::uint32_t location_id);
     void delete_location(SCOREP_LocationType location_type, std::uint32_t location_id);
 
@@ -54,19 +91,32 @@ public:
     std::vector<tmm::parameter_tuple> get_current_setting() const;
     const std::map<std::string, pcp_handler> &get_pcps() const;
 
+    /** returns the switcher of the process wide settings stack, nullptr if the plugins are called
+     * synchronously
+     */
+    inline const parameter_switcher *get_switcher() const noexcept
+    {
+        return switcher_.get();
+    }
+
 private:
     parameter_controller();
     ~parameter_controller();
 
-    void set_config(tmm::parameter_tuple config);
-    void unset_config(tmm::parameter_tuple config);
+    bool set_parameters(const cm::slot_setting &configs,
+        cm::cm_base &stack,
+        std::chrono::milliseconds duration,
+        parameter_switcher *switcher);
+    void unset_parameters(cm::cm_base &stack, parameter_switcher *switcher);
+
+    void set_config(std::size_t slot, int value);
+    void unset_config(std::size_t slot, int value);
+    void apply_configs(std::uint64_t changed, const cm::slot_setting &configs, bool unset);
 
     using parameter_set_function = int (*)(
         int); /**< function definition for pcp enter_region_set_config() function*/
     using parameter_unset_function = int (*)(
         int); /**< function definition for pcp exit_region_set_config() function*/
-    using parameter_get_current_config = int (*)();
-    /**< function definition for pcp current_config() function*/
     using setting = std::vector<tmm::parameter_tuple>;
     /**< type definition for settings variable*/
 
@@ -75,18 +125,36 @@ private:
         pcps; /**< holds all pcp handler objects that are holding the pcp plugins */
 
     std::hash<std::string> parameter_name_hash; /**< function to hash the names of the parameters */
-    std::map<std::size_t, parameter_set_function>
-        parameter_set_functions_; /**< holds all enterRegionFunctionPtr()*/
-    std::map<std::size_t, parameter_unset_function>
-        parameter_unset_functions_; /**< holds all exitRegionFunctionPtr()*/
-    std::map<std::size_t, parameter_get_current_config> parameter_get_current_configs_; /**< holds
-                                                                               the information for
-                                                                               parameters, if the
-                                                                               parameter shall be
-                                                                               restored or not.*/
+    cm::parameter_slots slots_; /**< slots of the TPs and ATPs */
+    std::uint64_t tp_mask_;     /**< slots of the parameters of the plugins */
+    std::array<parameter_set_function, cm::max_slots>
+        parameter_set_functions_; /**< enter_region_set_config() of the TPs by slot */
+    std::array<parameter_unset_function, cm::max_slots>
+        parameter_unset_functions_; /**< exit_region_set_config() of the TPs by slot */
+    std::array<std::uint32_t, cm::max_slots>
+        parameter_actions_; /**< index of the TPs in the tuning actions of their plugin */
+
+    /** a plugin which sets several parameters with one call */
+    struct batch_plugin
+    {
+        pcp_handler *pcp;
+        std::uint64_t mask; /**< slots of the parameters of the plugin */
+    };
+    std::vector<batch_plugin> batch_plugins_;
+
+    cm::slot_setting default_settings_; /**< values of all parameters when the plugins are loaded */
+    std::string cm_type_; /**< type of the configuration manager (CHECK_IF_RESET) */
 
     std::unique_ptr<cm::cm_base>
         cm; /**< manages settings stack with configurations consisting of parameter tuples*/
+
+    /** latencies of the parameters, nullptr if all configurations are applied */
+    std::unique_ptr<switch_cost_model> cost_model_;
+    std::atomic<std::uint64_t> skipped_configurations_; /**< configurations that did not pay off */
+
+    /** applies the changes of cm asynchronously, destroyed first to apply all pending changes
+     * before the plugins are unloaded */
+    std::unique_ptr<parameter_switcher> switcher_;
 };
 }
 
@@ -0,0 +1,128 @@
+#ifndef INCLUDE_RRL_PARAMETER_SWITCHER_HPP_
+#define INCLUDE_RRL_PARAMETER_SWITCHER_HPP_
+
+#include <rrl/overhead_statistics.hpp>
+#include <tmm/parameter_tuple.hpp>
+#include <util/spsc_queue.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace rrl
+{
+/** Statistics of the parameter switches of a \ref parameter_switcher.
+ */
+struct switch_statistics
+{
+    std::uint64_t requests = 0;  /**< parameter changes requested by the application thread */
+    std::uint64_t coalesced = 0; /**< requests that were not applied, as later requests for the
+                                    same parameter superseded them before they were applied */
+    event_statistics latency;    /**< time from the request to the applied switch */
+    event_statistics duration;   /**< time spent in the plugins, the application does not wait */
+};
+
+/** Applies the parameter changes of the application thread in a dedicated switcher thread.
+ *
+ * The application thread requests changes with \ref request and \ref submit, which only write to a
+ * lock free queue and wake the switcher thread if it sleeps. The switcher thread waits for the
+ * coalescing delay, drains the queue, and applies only the final value of every parameter. A set
+ * and an unset of a short region, which arrive within the delay, cancel each other out.
+ *
+ * There must be only one application thread requesting changes at a time.
+ */
+class parameter_switcher
+{
+public:
+    /** function that applies a single parameter, unset is true if the parameter is restored
+     */
+    using apply_function = std::function<void(tmm::parameter_tuple config, bool unset)>;
+
+    /** @param initial_settings values of the parameters before the first request
+     * @param apply called by the switcher thread for every parameter that changes
+     * @param delay time the switcher thread waits after a request to coalesce further requests
+     * @param capacity number of requests that can be pending
+     */
+    parameter_switcher(const std::vector<tmm::parameter_tuple> &initial_settings,
+        apply_function apply,
+        std::chrono::microseconds delay,
+        std::size_t capacity = 1024);
+
+    /** applies all pending requests and stops the switcher thread
+     */
+    ~parameter_switcher();
+
+    parameter_switcher(const parameter_switcher &) = delete;
+    parameter_switcher &operator=(const parameter_switcher &) = delete;
+
+    /** Adds a change to the current batch, it is only seen by the switcher thread after \ref
+     * submit.
+     */
+    void request(tmm::parameter_tuple config, bool unset);
+
+    /** passes the current batch to the switcher thread
+     */
+    void submit();
+
+    /** waits until all submitted requests are applied
+     */
+    void flush();
+
+    /** returns the statistics of all applied requests
+     */
+    switch_statistics statistics() const;
+
+private:
+    struct switch_request
+    {
+        switch_request() : config(0, 0), unset(false)
+        {
+        }
+
+        switch_request(tmm::parameter_tuple config,
+            bool unset,
+            std::chrono::high_resolution_clock::time_point requested)
+            : config(config), unset(unset), requested(requested)
+        {
+        }
+
+        tmm::parameter_tuple config;
+        bool unset;
+        std::chrono::high_resolution_clock::time_point requested;
+    };
+
+    void run();
+    void wait_for_requests();
+    void apply_pending();
+
+    apply_function apply_;
+    std::chrono::microseconds delay_;
+    spsc_queue<switch_request> queue_;
+    std::uint64_t submitted_; /**< number of submitted requests, application thread only */
+
+    /** values the plugins are set to, switcher thread only */
+    std::unordered_map<std::size_t, int> applied_;
+    /** last request of every parameter in the drained requests, switcher thread only */
+    std::unordered_map<std::size_t, switch_request> pending_;
+
+    /** number of applied or coalesced requests, written by the switcher thread */
+    std::atomic<std::uint64_t> processed_;
+    std::atomic<bool> waiting_; /**< the switcher thread sleeps, and has to be notified */
+    bool stop_;                 /**< protected by wait_lock_ */
+    std::mutex wait_lock_;
+    std::condition_variable wake_up_;
+
+    mutable std::mutex statistics_lock_;
+    switch_statistics statistics_;
+
+    std::thread thread_;
+};
+} // namespace rrl
+
+#endif /* INCLUDE_RRL_PARAMETER_SWITCHER_HPP_ */
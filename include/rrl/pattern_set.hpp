@@ -0,0 +1,81 @@
+#ifndef INCLUDE_RRL_PATTERN_SET_HPP_
+#define INCLUDE_RRL_PATTERN_SET_HPP_
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace rrl
+{
+
+/** Holds a set of shell wildcard patterns (as understood by fnmatch()) and checks names against
+ * all of them at once.
+ *
+ * Patterns are sorted into classes when they are added:
+ *  * names without any wildcard are kept in a hash set
+ *  * patterns of the form "foo*" are kept in a prefix trie
+ *  * patterns of the form "*foo" are kept in a suffix trie
+ *  * all other patterns are matched using fnmatch()
+ *
+ * Score-P filter files mainly consist of the first three classes, so matching a name costs a hash
+ * lookup and two trie walks, independent of the number of patterns.
+ */
+class pattern_set
+{
+public:
+    void add(const std::string &pattern);
+
+    bool match(const std::string &name) const;
+
+    /** returns the number of patterns added to the set
+     */
+    inline std::size_t size() const noexcept
+    {
+        return size_;
+    }
+
+    inline bool empty() const noexcept
+    {
+        return size_ == 0;
+    }
+
+private:
+    /** Trie over the characters of a pattern. Nodes are stored contiguous in a vector, node 0 is
+     * the root.
+     */
+    class trie
+    {
+    public:
+        trie();
+
+        template <typename Iterator> void insert(Iterator begin, Iterator end);
+
+        /** returns true if any inserted sequence is a prefix of [begin, end)
+         */
+        template <typename Iterator> bool match_prefix(Iterator begin, Iterator end) const;
+
+        inline bool empty() const noexcept
+        {
+            return nodes_.size() == 1 && !nodes_.front().terminal;
+        }
+
+    private:
+        struct node
+        {
+            std::unordered_map<char, std::uint32_t> children;
+            bool terminal = false; /**< a pattern ends at this node */
+        };
+        std::vector<node> nodes_;
+    };
+
+    std::unordered_set<std::string> exact_; /**< patterns without wildcards */
+    trie prefixes_;                         /**< patterns of the form "foo*", without the "*" */
+    trie suffixes_;                         /**< patterns of the form "*foo", without the "*" */
+    std::vector<std::string> globs_;        /**< all remaining patterns */
+    std::size_t size_ = 0;
+};
+}
+
+#endif /* INCLUDE_RRL_PATTERN_SET_HPP_ */
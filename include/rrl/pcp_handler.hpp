@@ -60,6 +60,16 @@ public:
     void create_location(RRL_LocationType location_type, uint32_t location_id);
     void delete_location(RRL_LocationType location_type, uint32_t location_id);
 
+    /** returns true if the plugin can set several tuning actions with one call
+     */
+    inline bool has_batched_set() const noexcept
+    {
+        return pcp_info_.plugin_version >= 1 && pcp_info_.enter_region_set_configs != nullptr &&
+               pcp_info_.exit_region_set_configs != nullptr;
+    }
+
+    int set_configs(uint32_t count, const uint32_t *actions, const int *values, bool exit);
+
     /** Disable copy constructor.
      *
      * Importand for ownership of dlfnc_handle
@@ -0,0 +1,109 @@
+#ifndef INCLUDE_RRL_PHASE_CLASSIFIER_HPP_
+#define INCLUDE_RRL_PHASE_CLASSIFIER_HPP_
+
+#include <rrl/metric_manager.hpp>
+#include <tmm/tuning_model_manager.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace rrl
+{
+/** Classifies phases into the clusters the DTA has found.
+ *
+ * A cluster has a range [start, end] for each feature it was clustered by. A phase belongs to a
+ * cluster, if each of its feature values lies in the range of the cluster. Features the cluster
+ * has no range for are ignored, but at least one measured feature has to have a range.
+ *
+ * For each feature, the ranges of all clusters are split at their bounds into elementary
+ * intervals. Each interval stores the set of clusters which contain it as bitmask. classify()
+ * finds the interval of each value with a binary search and intersects the masks, so its cost is
+ * O(features * (log(clusters) + clusters / 64)) and independent of the number of ranges that
+ * overlap.
+ */
+class phase_classifier
+{
+public:
+    /** returned by classify(), if the values are in no cluster */
+    static constexpr int no_cluster = std::numeric_limits<int>::min();
+
+    explicit phase_classifier(const std::unordered_map<int, tmm::phase_data_t> &clusters);
+
+    int classify(const std::vector<double> &values) const;
+
+    /** names of the features, the values passed to classify() are indexed like this
+     */
+    inline const std::vector<std::string> &features() const noexcept
+    {
+        return feature_names_;
+    }
+
+private:
+    using mask = std::vector<std::uint64_t>;
+
+    struct feature_index
+    {
+        /** sorted, unique bounds b_0 .. b_n-1 of the ranges of this feature */
+        std::vector<double> bounds;
+        /** clusters per interval: (-inf, b_0), [b_0], (b_0, b_1), [b_1], ..., (b_n-1, inf).
+         * Clusters without a range for the feature are in each interval.
+         */
+        std::vector<mask> intervals;
+        /** clusters with a range for the feature */
+        mask constrained;
+    };
+
+    std::size_t interval_of(const feature_index &feature, double value) const noexcept;
+
+    std::vector<int> cluster_ids_; /**< ascending, the bit of a cluster is its index here */
+    std::size_t words_ = 0;        /**< length of a mask */
+    std::vector<std::string> feature_names_;
+    std::vector<feature_index> features_;
+};
+
+/** Measures the features of the phases and classifies them with a \ref phase_classifier.
+ *
+ * The feature "duration" is the duration of the phase in seconds. Any other feature is the name of
+ * a strictly synchronous Score-P metric, see \ref metric_manager, and its value is the difference
+ * of the metric between the begin and the end of the phase. Features which are neither are not
+ * measured, and so ignored by the classification.
+ */
+class phase_monitor
+{
+public:
+    phase_monitor(const std::unordered_map<int, tmm::phase_data_t> &clusters, metric_manager &mm);
+
+    void phase_begin(const std::uint64_t *metric_values);
+    int phase_end(const std::uint64_t *metric_values);
+
+private:
+    enum class source_type
+    {
+        none,
+        duration,
+        metric
+    };
+
+    struct source
+    {
+        source_type type = source_type::none;
+        int metric_id = -1;
+        SCOREP_MetricValueType metric_type = SCOREP_INVALID_METRIC_VALUE_TYPE;
+        double begin = 0;
+    };
+
+    double metric_value(const source &s, const std::uint64_t *metric_values) const noexcept;
+
+    phase_classifier classifier_;
+    std::vector<source> sources_;  /**< indexed like the features of the classifier */
+    std::vector<double> values_;   /**< values of the last phase */
+    bool in_phase_ = false;
+    std::chrono::high_resolution_clock::time_point begin_;
+};
+} // namespace rrl
+
+#endif /* INCLUDE_RRL_PHASE_CLASSIFIER_HPP_ */
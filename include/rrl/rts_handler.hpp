@@ -4,11 +4,17 @@
 #include <cal/calibration.hpp>
 #include <tmm/tuning_model_manager.hpp>
 
+#include <rrl/metric_manager.hpp>
 #include <rrl/parameter_controller.hpp>
+#include <rrl/phase_classifier.hpp>
+#include <rrl/team_registry.hpp>
 #include <scorep/scorep.hpp>
 
+#include <atomic>
+#include <chrono>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 
 #include "call_tree/base_node.hpp"
@@ -21,18 +27,39 @@ namespace rrl
  *
  * It gets a region_id from Score-P and maintains a callpath using this
  * information.
+ *
+ * The rts_handler created by the constructor serves the master location. For per location tuning,
+ * additional handlers for worker threads are created with \ref create_worker(). A worker has its
+ * own call trees and its own settings stack, so it can be used by its thread without locking.
+ * The call trees of a worker are attached to the node of the forking location at the time of the
+ * fork of its team (see \ref fork() and \ref team_registry), so the callpaths of worker regions
+ * include the callpath of the parallel region. Workers do not calibrate, as calibration follows the master location only.
+ *
+ * With phase classification, the master location measures the features of each phase and
+ * classifies it into one of the clusters of the tuning model, see \ref phase_monitor. The cluster
+ * is passed as input identifier, so the configurations of the next phase are looked up for the
+ * scenarios of this cluster.
+ *
+ * If the tuning model manager reports a new tuning model, only the nodes whose callpath or region
+ * it affects look up their configuration again. Other changes of the tuning model generation, like
+ * a new phase cluster, reset all nodes.
  **/
 
 class rts_handler
 {
 public:
     rts_handler() = delete;
-    rts_handler(
-        std::shared_ptr<tmm::tuning_model_manager> tmm, std::shared_ptr<cal::calibration> cal);
+    rts_handler(std::shared_ptr<tmm::tuning_model_manager> tmm,
+        std::shared_ptr<cal::calibration> cal,
+        std::shared_ptr<metric_manager> mm);
     ~rts_handler();
 
-    void enter_region(uint32_t region_id, SCOREP_Location *locationData);
-    void exit_region(uint32_t region_id, SCOREP_Location *locationData);
+    void enter_region(uint32_t region_id,
+        SCOREP_Location *locationData,
+        const std::uint64_t *metric_values = nullptr);
+    void exit_region(uint32_t region_id,
+        SCOREP_Location *locationData,
+        const std::uint64_t *metric_values = nullptr);
     void create_location(SCOREP_LocationType location_type, std::uint32_t location_id);
     void delete_location(SCOREP_LocationType location_type, std::uint32_t location_id);
     void user_parameter(
@@ -42,13 +69,41 @@ public:
     void user_parameter(
         std::string user_parameter_name, std::string value, SCOREP_Location *locationData);
 
+    void register_region(const std::string &region_name,
+        std::uint32_t line_number,
+        const std::string &file_name,
+        std::uint32_t region_id);
+
+    team_registry::team new_team_member(std::uint32_t parent_location_id) const;
+    std::unique_ptr<rts_handler> create_worker(const team_registry::team &team);
+    void fork(std::uint32_t location_id);
+    void join(std::uint32_t location_id);
+
 private:
+    /** State shared between the handler of the master location and its workers.
+     */
+    struct shared_state
+    {
+        std::mutex tmm_lock; /**< serialises the access to the \ref tmm::tuning_model_manager */
+        std::atomic<std::uint64_t> tuning_model_generation; /**< counts the changes of the tm */
+        team_registry teams; /**< nodes of the thread teams that are not joined */
+        std::atomic<int> phase_cluster; /**< cluster of the last classified phase */
+        /** last change of the tuning model reported by the tmm, guarded by tmm_lock */
+        std::shared_ptr<const tmm::tuning_model_change> change;
+        std::uint64_t change_generation = 0; /**< generation of change, guarded by tmm_lock */
+    };
+
+    rts_handler(const rts_handler &master,
+        std::unique_ptr<cm::cm_base> configuration_stack,
+        const team_registry::team &team);
+
     bool is_inside_root;
     std::chrono::milliseconds significant_duration;
 
     std::shared_ptr<tmm::tuning_model_manager>
         tmm_; /**< holds a pointer to the \ref tmm::tuning_model_manager*/
     std::shared_ptr<cal::calibration> cal_; /**< holds a pointer to the \ref cal::calibrationr*/
+    std::shared_ptr<metric_manager> mm_;    /**< holds a pointer to the \ref metric_manager*/
 
     parameter_controller &pc_; /**< holds the \ref parameter_controller */
 
@@ -61,7 +116,32 @@ private:
 
     tmm::region_status region_status_;
 
+    std::shared_ptr<shared_state> shared_;
+    std::uint64_t tuning_model_generation_ = 0; /**< last generation this handler has seen */
+
+    bool worker_ = false;
+    std::unique_ptr<cm::cm_base> configuration_stack_; /**< settings stack of a worker */
+    team_registry::team team_; /**< team of a worker */
+    std::unordered_map<call_tree::base_node *, std::unique_ptr<call_tree::base_node>>
+        team_roots_; /**< call trees of a worker, one per node of the forking location */
+    int skipped_depth_ = 0; /**< regions a worker has entered outside of the root */
+
+    bool phase_classification_ = false;
+    std::string phase_cluster_identifier_; /**< input identifier the phase cluster is passed as */
+    std::unique_ptr<phase_monitor> phase_monitor_; /**< created with the first phase */
+
+    bool energy_metric_resolved_ = false;
+    int energy_metric_id_ = -1; /**< metric given by CAL_ENERGY, -1 if there is none */
+    SCOREP_MetricValueType energy_metric_type_ = SCOREP_INVALID_METRIC_VALUE_TYPE;
+
     void load_config();
+    void reset_call_trees(std::uint64_t generation);
+    void set_parameters(const cm::slot_setting &configs,
+        std::chrono::milliseconds duration = std::chrono::milliseconds::max());
+    void unset_parameters();
+    void apply_phase_cluster();
+    void classify_phase(const std::uint64_t *metric_values);
+    double energy(const std::uint64_t *metric_values);
     void parse_input_identifier_file(const std::string &input_id_file);
 };
 }
@@ -0,0 +1,60 @@
+#ifndef INCLUDE_RRL_SWITCH_COST_MODEL_HPP_
+#define INCLUDE_RRL_SWITCH_COST_MODEL_HPP_
+
+#include <rrl/cm/parameter_slots.hpp>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace rrl
+{
+/** Estimates the cost of switching tuning parameters, to skip switches that do not pay off.
+ *
+ * The switching latency of every parameter is measured when the plugins are loaded, and updated
+ * with every switch as exponentially weighted moving average. The configuration of a region only
+ * pays off if the region is at least factor times longer than setting and restoring the
+ * parameters that change.
+ *
+ * The parameters are identified by their slot of the \ref cm::parameter_slots. The model can be
+ * used by several threads at the same time.
+ */
+class switch_cost_model
+{
+public:
+    /** @param factor minimal ratio of the region duration to the switching cost
+     */
+    explicit switch_cost_model(double factor);
+
+    /** sets the initial latency of a parameter
+     */
+    void add_parameter(std::size_t slot, std::chrono::nanoseconds latency) noexcept;
+
+    /** updates the latency of a parameter with a measured switch
+     */
+    void record(std::size_t slot, std::chrono::nanoseconds latency) noexcept;
+
+    /** returns the estimated latency of a parameter, 0 for parameters without plugin like ATPs
+     */
+    inline std::chrono::nanoseconds latency(std::size_t slot) const noexcept
+    {
+        return std::chrono::nanoseconds(latencies_[slot].load(std::memory_order_relaxed));
+    }
+
+    std::chrono::nanoseconds cost(std::uint64_t changed) const noexcept;
+
+    bool pays_off(std::uint64_t changed, std::chrono::milliseconds duration) const noexcept;
+
+    inline double factor() const noexcept
+    {
+        return factor_;
+    }
+
+private:
+    double factor_;
+    std::array<std::atomic<std::int64_t>, cm::max_slots> latencies_; /**< in ns, by slot */
+};
+} // namespace rrl
+
+#endif /* INCLUDE_RRL_SWITCH_COST_MODEL_HPP_ */
@@ -0,0 +1,62 @@
+#ifndef INCLUDE_RRL_TEAM_REGISTRY_HPP_
+#define INCLUDE_RRL_TEAM_REGISTRY_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace rrl
+{
+namespace call_tree
+{
+class base_node;
+}
+
+/** Keeps the call tree node of every thread team that is forked and not joined yet.
+ *
+ * A team is identified by the location that forked it and the number of teams this location has
+ * forked and not joined at the time of the fork, so nested teams of the same location are
+ * distinguished. A worker location belongs to the team of its parent location that was active
+ * when the worker was created, see \ref new_member().
+ *
+ * All functions can be called from several threads at the same time.
+ */
+class team_registry
+{
+public:
+    /** a thread team, depth 0 means no team */
+    struct team
+    {
+        std::uint32_t location_id = 0; /**< location that forks the team */
+        std::size_t depth = 0;         /**< 1 for the outermost team of the location */
+    };
+
+    /** registers a new team forked by location_id
+     *
+     * @param node node of the forking location the call trees of the workers are attached to,
+     * nullptr if the workers are not tuned
+     */
+    void fork(std::uint32_t location_id, call_tree::base_node *node);
+
+    /** removes the innermost team forked by location_id
+     */
+    void join(std::uint32_t location_id);
+
+    /** returns the team a location belongs to, which is created by parent_location_id now
+     */
+    team new_member(std::uint32_t parent_location_id) const;
+
+    /** returns the node of a team, nullptr if the team is joined or not tuned
+     */
+    call_tree::base_node *node(const team &t) const;
+
+private:
+    mutable std::mutex lock_;
+    /** nodes of the teams of each forking location, innermost last */
+    std::unordered_map<std::uint32_t, std::vector<call_tree::base_node *>> teams_;
+};
+} // namespace rrl
+
+#endif /* INCLUDE_RRL_TEAM_REGISTRY_HPP_ */
@@ -47,12 +47,20 @@
  * @ plugin_version
  * Should be set to RRL_TUNING_PLUGIN_VERSION
  *
+ * Optional functions
+ *
+ * @ enter_region_set_configs, exit_region_set_configs
+ * Set the values of several tuning actions of the plugin with one call, e.g. to change the
+ * core and uncore frequency together. They are only used for plugins with a plugin_version of
+ * at least 1, and only if both are implemented. The functions of the tuning actions have to be
+ * implemented anyway, as they are still used to set single tuning actions.
+ *
  */
 
 #include <stdint.h>
 
 /** Current version of Score-P tuning plugin interface */
-#define RRL_TUNING_PLUGIN_VERSION 0
+#define RRL_TUNING_PLUGIN_VERSION 1
 
 #ifdef __cplusplus
 extern "C" {
@@ -127,8 +135,30 @@ typedef struct rrl_tuning_plugin_info
      */
     rrl_tuning_action_info *(*get_tuning_info)(void);
 
+    /** Optional, called at enter region events instead of enter_region_set_config of the single
+     * tuning actions, if several tuning actions of the plugin change. Available since version 1.
+     *
+     * @param count number of tuning actions to set
+     * @param actions indices of the tuning actions in the array returned by get_tuning_info
+     * @param values new values of the tuning actions
+     *
+     * @return 0 if successful, a negative error code otherwise.
+     */
+    int (*enter_region_set_configs)(uint32_t count, const uint32_t *actions, const int *values);
+
+    /** Optional, called at exit region events instead of exit_region_set_config of the single
+     * tuning actions, if several tuning actions of the plugin change. Available since version 1.
+     *
+     * @param count number of tuning actions to set
+     * @param actions indices of the tuning actions in the array returned by get_tuning_info
+     * @param values restored values of the tuning actions
+     *
+     * @return 0 if successful, a negative error code otherwise.
+     */
+    int (*exit_region_set_configs)(uint32_t count, const uint32_t *actions, const int *values);
+
     /** Some space for future stuff, should be zeroed */
-    uint64_t reserved[100];
+    uint64_t reserved[98];
 } rrl_tuning_plugin_info;
 
 /** Macro used for implementation of the 'get_info' function */
@@ -0,0 +1,267 @@
+#ifndef INCLUDE_TMM_BINARY_MODEL_HPP_
+#define INCLUDE_TMM_BINARY_MODEL_HPP_
+
+#include <tmm/callpath.hpp>
+#include <tmm/tuning_model.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace rrl
+{
+namespace tmm
+{
+/** Records of the binary tuning model format.
+ *
+ * A binary tuning model consists of a \ref header followed by sections. Each section is an array
+ * of one of the records below and starts at an offset aligned to 8 bytes. Records reference each
+ * other by their index in the section, strings are referenced by their position in the string
+ * section. Regions and callpaths are sorted by their hash, so they can be found with a binary
+ * search without decoding the file.
+ *
+ * The hashes are the std::hash values of region_id and std::vector<callpath_element>, and
+ * identifier and parameter ids are hashes of their names. The file therefore only can be read by
+ * a build with the same hash functions, which is checked with header::hash_fingerprint.
+ */
+namespace binary
+{
+constexpr char magic[8] = {'R', 'R', 'L', 'T', 'M', 'B', 'I', 'N'};
+constexpr std::uint32_t version = 1;
+constexpr std::uint32_t byte_order = 0x01020304;
+constexpr std::uint64_t no_index = ~0ull;
+
+enum section : std::uint32_t
+{
+    strings,     /**< char */
+    regions,     /**< region_record */
+    identifiers, /**< identifier_record */
+    id_sets,     /**< id_set_record */
+    elements,    /**< element_record */
+    callpaths,   /**< callpath_record */
+    scenarios,   /**< scenario_record */
+    parameters,  /**< parameter_record */
+    clusters,    /**< cluster_record */
+    phases,      /**< std::uint64_t */
+    ranges,      /**< range_record */
+    section_count
+};
+
+struct section_ref
+{
+    std::uint64_t offset; /**< offset from the begin of the file */
+    std::uint64_t count;  /**< number of records */
+};
+
+struct header
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byte_order;
+    std::uint64_t hash_fingerprint; /**< see \ref binary_model::hash_fingerprint */
+    std::uint64_t size;             /**< size of the file */
+    std::uint64_t root_element;     /**< element_record of the common root, or no_index */
+    section_ref sections[section_count];
+};
+
+struct string_ref
+{
+    std::uint32_t offset;
+    std::uint32_t length;
+};
+
+enum region_flags : std::uint32_t
+{
+    in_model = 1,        /**< region is listed in the regions of the tuning model */
+    has_nidentifiers = 2 /**< the region ends a callpath, nidentifiers is valid */
+};
+
+struct region_record
+{
+    std::uint64_t hash;
+    string_ref file;
+    string_ref name;
+    std::uint64_t line;
+    std::uint32_t flags;
+    std::uint32_t nidentifiers;
+};
+
+enum identifier_type : std::uint32_t
+{
+    uint_identifier,
+    int_identifier,
+    string_identifier
+};
+
+struct identifier_record
+{
+    std::uint32_t type;
+    std::uint32_t reserved;
+    std::uint64_t id;
+    std::uint64_t value; /**< value of uint and int identifiers */
+    string_ref string;   /**< value of string identifiers */
+};
+
+/** the identifiers of a set are stored consecutively: first the uints, then the ints, then the
+ * strings.
+ */
+struct id_set_record
+{
+    std::uint64_t first_identifier;
+    std::uint32_t nuints;
+    std::uint32_t nints;
+    std::uint32_t nstrings;
+    std::uint32_t reserved;
+};
+
+struct element_record
+{
+    std::uint64_t region;
+    std::uint64_t id_set;
+};
+
+struct callpath_record
+{
+    std::uint64_t hash;
+    std::uint64_t first_element;
+    std::uint64_t nelements;
+    std::int64_t exectime; /**< in milliseconds */
+    std::uint64_t first_scenario;
+    std::uint64_t nscenarios;
+};
+
+struct scenario_record
+{
+    std::uint64_t input_id_set;
+    std::uint64_t first_parameter;
+    std::uint64_t nparameters;
+};
+
+struct parameter_record
+{
+    std::uint64_t id;
+    std::int64_t value;
+};
+
+struct cluster_record
+{
+    std::int64_t id;
+    std::uint64_t first_phase;
+    std::uint64_t nphases;
+    std::uint64_t first_range;
+    std::uint64_t nranges;
+};
+
+struct range_record
+{
+    string_ref feature;
+    double start;
+    double end;
+};
+} // namespace binary
+
+/** Read only view of a tuning model in the binary format.
+ *
+ * The view does not decode the model. Regions and callpaths are looked up in place, and only the
+ * scenarios of a callpath are decoded when they are requested. Usually, the file is mapped to
+ * memory using \ref binary_model::map, so only the pages that are actually used are read.
+ *
+ * All queries are const and don't modify the view, so a view can be shared between threads.
+ */
+class binary_model final
+{
+public:
+    /** Creates a view of a binary tuning model in memory. data has to be aligned to 8 bytes and
+     * must stay valid as long as the view exists. All references between the records are checked.
+     *
+     * @throws std::runtime_error if data is no valid binary tuning model
+     */
+    binary_model(std::shared_ptr<const char> data, std::size_t size);
+
+    /** maps the file to memory, and creates a view of it
+     */
+    static std::shared_ptr<const binary_model> map(const std::string &file_path);
+
+    /** checks if the file starts with the magic of the binary format
+     */
+    static bool is_binary(const std::string &file_path);
+
+    /** writes tm in the binary format
+     */
+    static void write(const tuning_model &tm, std::ostream &os);
+
+    /** hash of a fixed string, to detect files written with different hash functions
+     */
+    static std::uint64_t hash_fingerprint();
+
+    /** returns the region, or nullptr if the model has no such region
+     */
+    const binary::region_record *find_region(const region_id &rid) const noexcept;
+
+    /** returns the callpath, or nullptr if the model has no such callpath
+     */
+    const binary::callpath_record *find_callpath(const std::vector<callpath_element> &cp) const
+        noexcept;
+
+    /** checks if cpe is the element all callpaths of the model start with
+     */
+    bool is_root(const callpath_element &cpe) const noexcept;
+
+    std::size_t ncallpaths() const noexcept
+    {
+        return section_size(binary::callpaths);
+    }
+
+    const binary::callpath_record &callpath_at(std::size_t index) const noexcept
+    {
+        return section<binary::callpath_record>(binary::callpaths)[index];
+    }
+
+    std::vector<callpath_element> decode_callpath(const binary::callpath_record &cp) const;
+
+    std::unordered_map<identifier_set, configuration_t> decode_scenarios(
+        const binary::callpath_record &cp) const;
+
+    std::unordered_map<int, phase_data_t> decode_clusters() const;
+
+    /** returns the size of the model in bytes
+     */
+    std::size_t size() const noexcept
+    {
+        return size_;
+    }
+
+private:
+    template <typename Record> const Record *section(binary::section s) const noexcept
+    {
+        return reinterpret_cast<const Record *>(data_.get() + header_->sections[s].offset);
+    }
+
+    std::size_t section_size(binary::section s) const noexcept
+    {
+        return header_->sections[s].count;
+    }
+
+    bool in_section(binary::section s, std::uint64_t first, std::uint64_t count) const noexcept;
+    bool valid(binary::string_ref ref) const noexcept;
+    void validate_records() const;
+
+    std::string decode_string(binary::string_ref ref) const;
+    bool equals(binary::string_ref ref, const std::string &s) const noexcept;
+    bool equals(const binary::element_record &element, const callpath_element &cpe) const noexcept;
+
+    region_id decode_region(std::uint64_t index) const;
+    identifier_set decode_id_set(std::uint64_t index) const;
+
+    std::shared_ptr<const char> data_;
+    std::size_t size_;
+    const binary::header *header_;
+};
+} // namespace tmm
+} // namespace rrl
+
+#endif /* INCLUDE_TMM_BINARY_MODEL_HPP_ */
@@ -67,7 +67,7 @@ public:
      */
     inline const std::string &file() const noexcept
     {
-        return rid_.file;
+        return rid_.file.str();
     }
 
     /** returns the name of the region
@@ -76,7 +76,7 @@ public:
      */
     inline const std::string &name() const noexcept
     {
-        return rid_.name;
+        return rid_.name.str();
     }
 
     /** returns the additional identifiers for the region
@@ -116,22 +116,22 @@ namespace std
 
 template <> struct hash<rrl::tmm::callpath_element>
 {
-    size_t inline operator()(const rrl::tmm::callpath_element &cpe) const
+    size_t inline operator()(const rrl::tmm::callpath_element &cpe) const noexcept
     {
-        std::string s;
-        strfmt(s, cpe.line(), cpe.name(), std::hash<rrl::tmm::identifier_set>{}(cpe.ids()));
-        return std::hash<std::string>{}(s);
+        auto h = rrl::hash::combine(cpe.line(), cpe.region_id().name.hash());
+        return rrl::hash::finalize(
+            rrl::hash::combine(h, std::hash<rrl::tmm::identifier_set>{}(cpe.ids())));
     }
 };
 
 template <> struct hash<std::vector<rrl::tmm::callpath_element>>
 {
-    size_t inline operator()(const std::vector<rrl::tmm::callpath_element> &cp) const
+    size_t inline operator()(const std::vector<rrl::tmm::callpath_element> &cp) const noexcept
     {
-        std::string s;
+        std::uint64_t h = cp.size();
         for (const auto &cpe : cp)
-            strfmt(s, std::hash<rrl::tmm::callpath_element>{}(cpe));
-        return std::hash<std::string>{}(s);
+            h = rrl::hash::combine(h, std::hash<rrl::tmm::callpath_element>{}(cpe));
+        return rrl::hash::finalize(h);
     }
 };
 }
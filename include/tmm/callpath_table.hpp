@@ -0,0 +1,66 @@
+#ifndef INCLUDE_TMM_CALLPATH_TABLE_HPP_
+#define INCLUDE_TMM_CALLPATH_TABLE_HPP_
+
+#include <tmm/simple_callpath.hpp>
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace rrl
+{
+namespace tmm
+{
+/** Dense id of an interned callpath, see \ref callpath_table.
+ */
+using callpath_id = std::uint32_t;
+
+/** Interns callpaths, and assigns a dense \ref callpath_id to each distinct callpath.
+ *
+ * A call tree node builds its callpath only once and keeps the id afterwards. The callpath and its
+ * 64 bit hash can be retrieved from the table using the id, without building the callpath again.
+ *
+ * The table is not thread safe.
+ */
+class callpath_table
+{
+public:
+    callpath_id intern(const std::vector<simple_callpath_element> &callpath);
+
+    /** returns the callpath with the given id
+     */
+    inline const std::vector<simple_callpath_element> &callpath(callpath_id id) const
+    {
+        return entries_.at(id).callpath;
+    }
+
+    /** returns the 64 bit hash of the callpath with the given id
+     */
+    inline std::uint64_t hash(callpath_id id) const
+    {
+        return entries_.at(id).hash;
+    }
+
+    /** returns the number of distinct callpaths in this table
+     */
+    inline std::size_t size() const noexcept
+    {
+        return entries_.size();
+    }
+
+    static std::uint64_t hash_callpath(const std::vector<simple_callpath_element> &callpath);
+
+private:
+    struct entry
+    {
+        std::vector<simple_callpath_element> callpath;
+        std::uint64_t hash;
+    };
+
+    std::vector<entry> entries_;
+    std::unordered_multimap<std::uint64_t, callpath_id> index_; /**< hash to id */
+};
+} // namespace tmm
+} // namespace rrl
+
+#endif /* INCLUDE_TMM_CALLPATH_TABLE_HPP_ */
@@ -0,0 +1,95 @@
+#ifndef INCLUDE_TMM_CALLPATH_TRIE_HPP_
+#define INCLUDE_TMM_CALLPATH_TRIE_HPP_
+
+#include <tmm/callpath.hpp>
+
+#include <cstddef>
+#include <deque>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+namespace rrl
+{
+namespace tmm
+{
+/** Stores callpaths as a prefix tree, which mirrors the call tree of the RTS.
+ *
+ * Each node represents the callpath from the root to the node, and stores the element of its
+ * level only. Looking up a callpath hashes each element once, and walking down one level, like the
+ * call tree does when a region is entered, is a single lookup. A node can hold a value, e.g. the
+ * index of the rts of its callpath.
+ *
+ * Nodes are never removed, so pointers to nodes stay valid until clear() is called or the trie is
+ * destroyed. The trie is not thread safe.
+ */
+class callpath_trie
+{
+public:
+    /** value of nodes without a value */
+    static constexpr std::size_t npos = std::numeric_limits<std::size_t>::max();
+
+    struct node
+    {
+        node(const node *parent, const callpath_element &element, std::size_t depth)
+            : parent(parent), element(element), depth(depth)
+        {
+        }
+
+        const node *parent;       /**< nullptr for the root */
+        callpath_element element; /**< last element of the callpath of this node */
+        std::size_t depth;        /**< length of the callpath, 0 for the root */
+        std::size_t value = npos;
+        std::unordered_map<callpath_element, node *> children;
+
+        inline bool has_value() const noexcept
+        {
+            return value != npos;
+        }
+    };
+
+    callpath_trie();
+
+    callpath_trie(const callpath_trie &) = delete;
+    callpath_trie &operator=(const callpath_trie &) = delete;
+
+    /** returns the root, which represents the empty callpath
+     */
+    inline const node &root() const noexcept
+    {
+        return nodes_.front();
+    }
+
+    /** returns the child of parent for element, or nullptr if there is no such child
+     */
+    inline const node *child(const node &parent, const callpath_element &element) const
+    {
+        auto it = parent.children.find(element);
+        return it != parent.children.end() ? it->second : nullptr;
+    }
+
+    node *insert(const std::vector<callpath_element> &callpath);
+
+    const node *find(const std::vector<callpath_element> &callpath) const;
+
+    const node *longest_prefix(const std::vector<callpath_element> &callpath) const;
+
+    std::vector<callpath_element> path(const node &n) const;
+
+    /** returns the number of nodes, including the root
+     */
+    inline std::size_t size() const noexcept
+    {
+        return nodes_.size();
+    }
+
+    void clear();
+
+private:
+    /** a deque keeps the addresses of the nodes stable */
+    std::deque<node> nodes_;
+};
+} // namespace tmm
+} // namespace rrl
+
+#endif /* INCLUDE_TMM_CALLPATH_TRIE_HPP_ */
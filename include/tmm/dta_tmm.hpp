@@ -1,10 +1,12 @@
 #ifndef INCLUDE_RRL_DTA_TMM_HPP_
 #define INCLUDE_RRL_DTA_TMM_HPP_
 
+#include <tmm/journal.hpp>
 #include <tmm/region.hpp>
 #include <tmm/tuning_model_manager.hpp>
 
 #include <cstdint>
+#include <memory>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -15,7 +17,7 @@ namespace tmm
 {
 using region_config = std::tuple<>;
 
-/** This Tuning model mamanger Supports 2 enviroment varaibles:
+/** This Tuning model mamanger Supports 4 enviroment varaibles:
  *
  * * CHECK_ROOT specifies if there is a check for the root region. If `false`, all regions are root
  * regions.
@@ -24,6 +26,11 @@ using region_config = std::tuple<>;
  *     * collect_fix
  *     * collect_scaling
  *     * none
+ * * TMM_JOURNAL specifies a journal, see \ref journal_writer. Stored configurations are appended to
+ * it. The configurations of an existing journal are stored again once all regions of their
+ * callpath are registered, so a calibration can be resumed. Each process uses its own journal,
+ * see \ref journal_path.
+ * * TMM_JOURNAL_SYNC specifies after how many configurations the journal is synced to the disk.
  */
 class dta_tmm final : public tuning_model_manager
 {
@@ -40,10 +47,19 @@ public:
 
     virtual size_t get_region_identifiers(std::uint32_t region_id) override;
 
+    using tuning_model_manager::get_current_rts_configuration;
+    using tuning_model_manager::get_exectime;
+    using tuning_model_manager::store_configuration;
+
     void store_configuration(const std::vector<simple_callpath_element> &callpath,
         const std::vector<parameter_tuple> &configuration,
         std::chrono::milliseconds exectime) override;
 
+    void store_configuration(callpath_id callpath,
+        const std::vector<parameter_tuple> &configuration,
+        std::chrono::milliseconds exectime,
+        double energy) override;
+
     const std::vector<parameter_tuple> get_current_rts_configuration(
         const std::vector<simple_callpath_element> &callpath,
         const std::unordered_map<std::string, std::string> &input_identifers) override;
@@ -66,6 +82,13 @@ public:
     virtual std::uint32_t get_id_from_region_name(const std::string region_name) noexcept override;
 
 private:
+    void insert_configuration(const std::vector<simple_callpath_element> &callpath,
+        const std::vector<parameter_tuple> &configuration);
+    void append_journal(const std::vector<simple_callpath_element> &callpath,
+        std::chrono::milliseconds exectime,
+        double energy);
+    void resume(const region_id &rid);
+
     std::unordered_map<std::vector<simple_callpath_element>, std::vector<parameter_tuple>>
         configurations_;
 
@@ -74,6 +97,14 @@ private:
 
     std::unordered_map<std::string, std::uint32_t> reg_name_reg_id_map;
     std::unordered_map<std::uint32_t, std::string> reg_id_reg_name_map;
+    std::unordered_map<std::uint32_t, region_id> regions_;
+    std::unordered_map<region_id, std::uint32_t> scorep_ids_;
+
+    std::unique_ptr<journal_writer> journal_;
+    /** entries of the journal of a previous run, the callpath is cleared once it is stored */
+    std::vector<journal_entry> resumed_;
+    /** indices in resumed_ of the entries which have the region in their callpath */
+    std::unordered_map<region_id, std::vector<std::size_t>> resumed_by_region_;
 
     bool check_for_root = true;
     calibration_type cal_type;
@@ -2,6 +2,7 @@
 #define INCLUDE_RRL_IDENTIFIERS_HPP_
 
 #include <util/common.hpp>
+#include <util/hash.hpp>
 
 #include <cstdint>
 #include <string>
@@ -146,24 +147,26 @@ namespace std
 {
 template <typename T> struct hash<rrl::tmm::identifier<T>>
 {
-    size_t operator()(const rrl::tmm::identifier<T> &id) const
+    size_t operator()(const rrl::tmm::identifier<T> &id) const noexcept
     {
-        return std::hash<std::string>{}(strfmt(id.id, id.value));
+        return rrl::hash::finalize(rrl::hash::combine(id.id, rrl::hash::value(id.value)));
     }
 };
 
 template <> struct hash<rrl::tmm::identifier_set>
 {
-    size_t operator()(const rrl::tmm::identifier_set ids) const
+    size_t operator()(const rrl::tmm::identifier_set &ids) const noexcept
     {
-        std::string s;
+        /* the sizes distinguish e.g. an int from an uint identifier with the same id and value */
+        std::uint64_t h =
+            rrl::hash::combine(ids.uints.size(), (ids.ints.size() << 32) ^ ids.strings.size());
         for (const auto &id : ids.uints)
-            s = strfmt(s, id.id, id.value);
+            h = rrl::hash::combine(rrl::hash::combine(h, id.id), rrl::hash::value(id.value));
         for (const auto &id : ids.ints)
-            s = strfmt(s, id.id, id.value);
+            h = rrl::hash::combine(rrl::hash::combine(h, id.id), rrl::hash::value(id.value));
         for (const auto &id : ids.strings)
-            s = strfmt(s, id.id, id.value);
-        return std::hash<std::string>{}(s);
+            h = rrl::hash::combine(rrl::hash::combine(h, id.id), rrl::hash::value(id.value));
+        return rrl::hash::finalize(h);
     }
 };
 } // namespace std
@@ -0,0 +1,122 @@
+#ifndef INCLUDE_TMM_JOURNAL_HPP_
+#define INCLUDE_TMM_JOURNAL_HPP_
+
+#include <tmm/callpath.hpp>
+#include <tmm/parameter_tuple.hpp>
+#include <tmm/tuning_model.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace rrl
+{
+namespace tmm
+{
+/** Format of the journal of stored configurations.
+ *
+ * A journal starts with a \ref header, followed by records. Each record is the size of its payload
+ * (std::uint32_t), a checksum of the payload (std::uint64_t) and the payload, which encodes one
+ * \ref journal_entry. Integers are stored in the byte order of the machine, strings as their
+ * length (std::uint32_t) followed by the characters.
+ *
+ * Records are only appended. If a process is killed while writing a record, the journal ends with
+ * an incomplete record, which is detected by its size or checksum and ignored.
+ *
+ * Identifier and parameter ids are hashes of their names, so a journal can only be read by a
+ * build with the same hash functions, like a \ref binary_model.
+ */
+namespace journal
+{
+constexpr char magic[8] = {'R', 'R', 'L', 'T', 'M', 'J', 'N', 'L'};
+constexpr std::uint32_t version = 2;
+constexpr std::uint32_t byte_order = 0x01020304;
+
+struct header
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byte_order;
+    std::uint64_t hash_fingerprint;
+};
+} // namespace journal
+
+/** a configuration stored in a journal */
+struct journal_entry
+{
+    std::vector<callpath_element> callpath;
+    std::vector<parameter_tuple> configuration;
+    std::chrono::milliseconds exectime;
+    double energy; /**< energy of the last calibrated execution, NaN if not measured */
+};
+
+/** Appends stored configurations to a journal.
+ *
+ * Each entry is written with a single write(), so it is in the page cache and survives the end of
+ * the process, even if the process is killed. To survive a crash of the node as well, the journal
+ * is synced to the disk every sync_interval entries, and when the writer is destroyed.
+ *
+ * An existing journal is continued. An incomplete record at its end is removed first.
+ */
+class journal_writer
+{
+public:
+    /**
+     * @throws std::runtime_error if the file cannot be opened, or is no compatible journal
+     */
+    journal_writer(const std::string &file_path, std::size_t sync_interval);
+    ~journal_writer();
+
+    journal_writer(const journal_writer &) = delete;
+    journal_writer &operator=(const journal_writer &) = delete;
+
+    /**
+     * @throws std::runtime_error if the entry cannot be written
+     */
+    void append(const std::vector<callpath_element> &callpath,
+        const std::vector<parameter_tuple> &configuration,
+        std::chrono::milliseconds exectime,
+        double energy);
+
+    void sync() noexcept;
+
+private:
+    int fd_;
+    std::size_t sync_interval_;
+    std::size_t unsynced_ = 0;
+    std::string buffer_; /**< reused for the records */
+};
+
+bool is_journal(const std::string &file_path);
+
+/** Returns the journal of this process for the path given in TMM_JOURNAL, so that the processes
+ * of a parallel run do not write to the same file.
+ *
+ * `%r` is replaced by the rank the MPI launcher or Slurm passes in the environment, or by the pid
+ * if there is none, `%p` by the pid and `%%` by `%`. Without placeholders, `.<rank>` is appended if
+ * the rank is known. The rank is the same in every run, so a calibration can be resumed.
+ */
+std::string journal_path(const std::string &pattern);
+
+/** Reads the entries of a journal in the order they were written, and passes each to f. An
+ * incomplete record at the end is ignored.
+ *
+ * @return number of bytes of the complete records, including the header. 0 if the file is empty.
+ * @throws std::runtime_error if the file cannot be read, or is no compatible journal
+ */
+std::uint64_t read_journal(
+    const std::string &file_path, const std::function<void(journal_entry &&)> &f);
+
+/** Stores the entries of a journal in tm, later entries of a callpath replace earlier ones.
+ *
+ * @return number of entries
+ * @throws std::runtime_error if the file cannot be read, or is no compatible journal
+ */
+std::size_t replay_journal(const std::string &file_path, tuning_model &tm);
+} // namespace tmm
+} // namespace rrl
+
+#endif /* INCLUDE_TMM_JOURNAL_HPP_ */
@@ -0,0 +1,36 @@
+#ifndef INCLUDE_TMM_MODEL_DISTRIBUTION_HPP_
+#define INCLUDE_TMM_MODEL_DISTRIBUTION_HPP_
+
+#include <tmm/binary_model.hpp>
+
+#include <memory>
+#include <string>
+
+#include <mpi.h>
+
+namespace rrl
+{
+namespace tmm
+{
+/** Reads the tuning model on rank 0 of comm, and distributes it in the binary format to all ranks
+ * of comm.
+ *
+ * Only rank 0 accesses the file. A JSON tuning model is converted to the binary format first.
+ * The model is broadcasted to one rank per node, which stores it in an MPI shared memory window.
+ * All ranks of a node use this single copy.
+ *
+ * The function is collective over comm and uses the PMPI interface, so it is not recorded by
+ * Score-P.
+ *
+ * @param file_path tuning model to read on rank 0
+ * @param comm communicator of all ranks which need the tuning model
+ * @return view of the tuning model in the shared memory window of the node
+ *
+ * @throws std::runtime_error on all ranks, if rank 0 cannot read the tuning model
+ */
+std::shared_ptr<const binary_model> distribute_tuning_model(
+    const std::string &file_path, MPI_Comm comm);
+} // namespace tmm
+} // namespace rrl
+
+#endif /* INCLUDE_TMM_MODEL_DISTRIBUTION_HPP_ */
@@ -0,0 +1,79 @@
+#ifndef INCLUDE_TMM_MODEL_MERGE_HPP_
+#define INCLUDE_TMM_MODEL_MERGE_HPP_
+
+#include <tmm/callpath.hpp>
+#include <tmm/identifiers.hpp>
+#include <tmm/tuning_model.hpp>
+#include <tmm/tuning_model_manager.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace rrl
+{
+namespace tmm
+{
+/** Merges the tuning results of several processes, like the journals of the ranks of a
+ * calibration run, into one tuning model.
+ *
+ * The inputs are tuning models in the JSON or binary format, or journals. Only one input is held
+ * in memory at a time. If several inputs have a configuration for the same scenario of an rts,
+ * the configuration with the lower energy wins. A measured energy wins over an unknown one, and
+ * without energies the lower execution time wins, then the input with the lower index. Energies
+ * are only known for journals.
+ *
+ * The result does not depend on the order the inputs are added in, so several mergers can read
+ * the inputs in parallel, and are merged afterwards.
+ */
+class model_merger
+{
+public:
+    /** Adds the rts and clusters of an input. Within a journal, the last entry of a callpath wins.
+     *
+     * @param index orders the inputs for ties, and for clusters with the same id
+     * @throws std::runtime_error if the file cannot be read
+     */
+    void add_file(const std::string &file_path, std::size_t index);
+
+    /** adds the results of a merger of other inputs
+     */
+    void merge(model_merger &&other);
+
+    /** Stores the merged scenarios and clusters in tm. The execution time of an rts is the
+     * longest execution time of its merged scenarios.
+     */
+    void store(tuning_model &tm) const;
+
+    /** returns the number of merged scenarios, for which the inputs had different configurations
+     */
+    std::size_t nconflicts() const noexcept;
+
+    std::size_t nscenarios() const noexcept;
+
+private:
+    struct candidate
+    {
+        configuration_t configuration;
+        std::chrono::milliseconds exectime;
+        double energy; /**< NaN if not measured */
+        std::size_t index;
+        bool conflicting;
+    };
+
+    static bool is_better(const candidate &a, const candidate &b) noexcept;
+
+    void add(const callpath &cp, const identifier_set &ids, candidate &&c);
+    void add_cluster(int id, const phase_data_t &cluster, std::size_t index);
+
+    std::unordered_map<callpath, std::unordered_map<identifier_set, candidate>> rtss_;
+    /** clusters with the index of their input */
+    std::map<int, std::pair<std::size_t, phase_data_t>> clusters_;
+};
+} // namespace tmm
+} // namespace rrl
+
+#endif /* INCLUDE_TMM_MODEL_MERGE_HPP_ */
@@ -2,6 +2,7 @@
 #define INCLUDE_RRL_PARAMETER_TUPLE_HPP_
 
 #include <iostream>
+#include <vector>
 
 namespace rrl
 {
@@ -1,10 +1,16 @@
 #ifndef INCLUDE_RRL_RAT_TMM_HPP_
 #define INCLUDE_RRL_RAT_TMM_HPP_
 
+#include <tmm/scenario_fallback.hpp>
 #include <tmm/tuning_model.hpp>
 #include <tmm/tuning_model_manager.hpp>
 
+#include <atomic>
+#include <condition_variable>
 #include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 
@@ -12,6 +18,14 @@ namespace rrl
 {
 namespace tmm
 {
+/** Tuning model manager of the runtime mode, which applies a tuning model.
+ *
+ * The tuning model can be replaced while the application runs, either by reload(), which is
+ * called for an OA command, or by a thread that watches the file of the tuning model. The new
+ * model is read outside of the Score-P events. It is swapped in by take_change(), which reports
+ * the interned callpaths whose rts changed, and the regions whose significance changed, so only
+ * their nodes are looked up again. A model that is broadcasted by init_mpp() cannot be replaced.
+ */
 class rat_tmm final : public tuning_model_manager
 {
 public:
@@ -28,6 +42,8 @@ public:
 
     virtual size_t get_region_identifiers(std::uint32_t region_id) override;
 
+    using tuning_model_manager::store_configuration;
+
     virtual void store_configuration(const std::vector<simple_callpath_element> &callpath,
         const std::vector<parameter_tuple> &configuration,
         std::chrono::milliseconds exectime) override;
@@ -49,13 +65,78 @@ public:
 
     virtual bool has_changed() noexcept override;
     virtual void set_changed(bool) noexcept override;
+    virtual tuning_model_change take_change() override;
+    virtual void reload(const std::string &file_path) override;
+
+    virtual void init_mpp() override;
 
     virtual std::string get_name_from_region_id(std::uint32_t region_id) noexcept override;
     virtual std::uint32_t get_id_from_region_name(std::string region_name) noexcept override;
 
+    virtual void store_configuration(callpath_id callpath,
+        const std::vector<parameter_tuple> &configuration,
+        std::chrono::milliseconds exectime) override;
+
+    virtual const std::vector<parameter_tuple> get_current_rts_configuration(callpath_id callpath,
+        const std::unordered_map<std::string, std::string> &input_identifers) override;
+
+    virtual std::chrono::milliseconds get_exectime(callpath_id callpath) noexcept override;
+
 private:
-    tuning_model tm_;
+    std::vector<callpath_element> convert(const std::vector<simple_callpath_element> &callpath);
+    const std::vector<callpath_element> &convert(callpath_id callpath);
+
+    const std::vector<parameter_tuple> get_configuration(
+        const std::unordered_map<identifier_set, configuration_t> *iptmap,
+        const std::unordered_map<std::string, std::string> &input_identifiers);
+
+    const callpath_trie::node *find_node(callpath_id callpath);
+
+    static void load(const std::string &file_path, tuning_model &tm);
+    void load(const std::string &file_path);
+    void resolve_significance();
+    tuning_model_change swap_model(std::unique_ptr<tuning_model> model);
+
+    struct file_stamp;
+    void watch(file_stamp stamp);
+
+    std::unique_ptr<tuning_model> tm_;
+    std::string file_path_;
+    /** the tuning model is read by rank 0 and broadcasted in init_mpp() */
+    bool broadcast_ = false;
+    bool changed_ = false;
+
+    /** model read by reload(), which is swapped in by take_change() */
+    std::unique_ptr<tuning_model> pending_;
+    std::mutex pending_lock_;
+    std::atomic<bool> reload_pending_;
+
+    /** thread that reloads the tuning model if its file changes */
+    std::thread watcher_;
+    std::chrono::milliseconds watch_interval_;
+    std::mutex watch_lock_;
+    std::condition_variable watch_cv_;
+    bool stop_watch_ = false;
+    /** callpaths which are not in the tuning model use the rts of their longest prefix */
+    bool prefix_fallback_ = false;
+    /** selects configurations for input identifiers without a scenario */
+    fallback_mode input_fallback_ = fallback_mode::none;
+    /** fallbacks of the rts, built at the first miss, by their scenarios */
+    std::unordered_map<const scenario_fallback::scenario_map *, std::unique_ptr<scenario_fallback>>
+        fallbacks_;
     std::unordered_map<uint32_t, region_id> registered_regions_;
+    /** significance of the registered regions, indexed by their Score-P id */
+    std::vector<region_status> significance_;
+
+    /** callpaths of \ref callpaths_, converted to callpath_element, indexed by their id */
+    std::vector<std::vector<callpath_element>> converted_callpaths_;
+    std::vector<bool> is_converted_;
+    /** trie nodes of the callpaths of \ref callpaths_, indexed by their id, nullptr if the
+     * callpath is not in the trie
+     */
+    std::vector<const callpath_trie::node *> trie_nodes_;
+    /** whether the entry of \ref trie_nodes_ is looked up */
+    std::vector<bool> is_resolved_;
 };
 } // namespace tmm
 } // namespace rrl
@@ -1,7 +1,9 @@
 #ifndef INCLUDE_RRL_REGION_HPP_
 #define INCLUDE_RRL_REGION_HPP_
 
+#include <tmm/string_pool.hpp>
 #include <util/common.hpp>
+#include <util/hash.hpp>
 
 namespace rrl
 {
@@ -14,6 +16,8 @@ namespace tmm
  * A region is identified by it's function name,
  * the file and the line number.
  *
+ * The file and the function name are interned in the \ref string_pool, so copying a region_id does
+ * not allocate, and comparing two region_id's compares integers.
  */
 struct region_id
 {
@@ -55,8 +59,8 @@ struct region_id
     }
 
     size_t line;
-    std::string file;
-    std::string name;
+    symbol file;
+    symbol name;
 };
 
 inline std::ostream &operator<<(std::ostream &s, const region_id region)
@@ -71,9 +75,9 @@ namespace std
 {
 template <> struct hash<rrl::tmm::region_id>
 {
-    size_t operator()(const rrl::tmm::region_id &rid) const
+    size_t operator()(const rrl::tmm::region_id &rid) const noexcept
     {
-        return std::hash<std::string>{}(strfmt(rid.line, rid.name));
+        return rrl::hash::finalize(rrl::hash::combine(rid.line, rid.name.hash()));
     }
 };
 }
@@ -0,0 +1,92 @@
+#ifndef INCLUDE_TMM_SCENARIO_FALLBACK_HPP_
+#define INCLUDE_TMM_SCENARIO_FALLBACK_HPP_
+
+#include <tmm/identifiers.hpp>
+#include <tmm/tuning_model.hpp>
+#include <tmm/tuning_model_manager.hpp>
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace rrl
+{
+namespace tmm
+{
+/** How a configuration is selected, if an rts has several scenarios, but none for the input
+ * identifiers of the run.
+ */
+enum class fallback_mode
+{
+    none,     /**< no configuration is selected, the region keeps the current configuration */
+    nearest,  /**< the scenario with the nearest numeric identifiers */
+    majority, /**< the configuration of most scenarios */
+    cluster   /**< a scenario whose identifiers fall into the same DTA cluster as the input */
+};
+
+/** parses "none", "nearest", "majority" or "cluster"
+ *
+ * @throws std::invalid_argument for other values
+ */
+fallback_mode parse_fallback_mode(const std::string &mode);
+
+/** Selects the configuration of an rts for input identifiers which have no scenario.
+ *
+ * Everything that does not depend on the input identifiers is computed in the constructor: the
+ * majority configuration, the numeric identifiers of each scenario normalised by their range, and
+ * the cluster of each scenario. select() compares the input identifiers against this, so its cost
+ * depends only on the number of scenarios and identifiers of the rts.
+ *
+ * The scenarios and clusters have to outlive the object.
+ */
+class scenario_fallback
+{
+public:
+    using scenario_map = std::unordered_map<identifier_set, configuration_t>;
+
+    /** returned by classify(), if the values are in no cluster */
+    static constexpr int no_cluster = std::numeric_limits<int>::min();
+
+    scenario_fallback(fallback_mode mode,
+        const scenario_map &scenarios,
+        const std::unordered_map<int, phase_data_t> &clusters);
+
+    const configuration_t *select(
+        const std::unordered_map<std::string, std::string> &input_identifiers) const;
+
+private:
+    struct scenario
+    {
+        const configuration_t *configuration;
+        /** numeric identifiers, indexed like dimensions_, NaN if the scenario does not have it */
+        std::vector<double> point;
+        /** string identifiers, which have to match the input identifiers */
+        std::vector<identifier<std::string>> strings;
+    };
+
+    const configuration_t *select_nearest(
+        const std::unordered_map<std::string, std::string> &input_identifiers) const;
+    const configuration_t *select_cluster(
+        const std::unordered_map<std::string, std::string> &input_identifiers) const;
+
+    int classify(const std::unordered_map<std::size_t, double> &values) const;
+
+    fallback_mode mode_;
+    const std::unordered_map<int, phase_data_t> &clusters_;
+
+    const configuration_t *majority_ = nullptr;
+
+    /** ids of the numeric identifiers, and the range of their values */
+    std::vector<std::size_t> dimensions_;
+    std::vector<double> ranges_;
+    std::vector<scenario> scenarios_;
+
+    /** configuration for each cluster, the majority of the scenarios in the cluster */
+    std::unordered_map<int, const configuration_t *> cluster_configurations_;
+};
+} // namespace tmm
+} // namespace rrl
+
+#endif /* INCLUDE_TMM_SCENARIO_FALLBACK_HPP_ */
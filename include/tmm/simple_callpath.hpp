@@ -81,22 +81,24 @@ namespace std
 {
 template <> struct hash<rrl::tmm::simple_callpath_element>
 {
-    size_t inline operator()(const rrl::tmm::simple_callpath_element &scpe) const
+    size_t inline operator()(const rrl::tmm::simple_callpath_element &scpe) const noexcept
     {
-        std::string s;
-        strfmt(s, scpe.region_id, std::hash<rrl::tmm::identifier_set>{}(scpe.id_set));
-        return std::hash<std::string>{}(s);
+        /* most elements have no additional identifiers */
+        std::uint64_t ids =
+            scpe.id_set.size() == 0 ? 0 : std::hash<rrl::tmm::identifier_set>{}(scpe.id_set);
+        return rrl::hash::finalize(rrl::hash::combine(scpe.region_id, ids));
     }
 };
 
 template <> struct hash<std::vector<rrl::tmm::simple_callpath_element>>
 {
     size_t inline operator()(const std::vector<rrl::tmm::simple_callpath_element> &scp) const
+        noexcept
     {
-        std::string s;
+        std::uint64_t h = scp.size();
         for (const auto &scpe : scp)
-            strfmt(s, std::hash<rrl::tmm::simple_callpath_element>{}(scpe));
-        return std::hash<std::string>{}(s);
+            h = rrl::hash::combine(h, std::hash<rrl::tmm::simple_callpath_element>{}(scpe));
+        return rrl::hash::finalize(h);
     }
 };
 } // namespace std
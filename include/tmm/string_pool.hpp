@@ -0,0 +1,148 @@
+#ifndef INCLUDE_TMM_STRING_POOL_HPP_
+#define INCLUDE_TMM_STRING_POOL_HPP_
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+
+namespace rrl
+{
+namespace tmm
+{
+/** Process wide pool of the interned file and function names of the regions.
+ *
+ * Each distinct string is stored once, and gets a dense 32 bit id. The strings are never removed,
+ * and a reference to an interned string stays valid for the lifetime of the process.
+ *
+ * Interning is thread safe. Looking up the string or the hash of an id does not lock, as the
+ * entries are stored in chunks that never move. Chunk k holds first_chunk_size << k entries.
+ */
+class string_pool
+{
+public:
+    static string_pool &instance();
+
+    /** returns the id of s, if s is not in the pool yet, it is added
+     */
+    std::uint32_t intern(const std::string &s);
+
+    /** returns the string with the given id, the id has to be returned by intern()
+     */
+    inline const std::string &str(std::uint32_t id) const noexcept
+    {
+        return at(id).str;
+    }
+
+    /** returns std::hash<std::string> of the string with the given id
+     */
+    inline std::uint64_t hash(std::uint32_t id) const noexcept
+    {
+        return at(id).hash;
+    }
+
+    /** returns the number of distinct strings in the pool
+     */
+    std::size_t size() const noexcept;
+
+    string_pool(const string_pool &) = delete;
+    string_pool &operator=(const string_pool &) = delete;
+
+private:
+    struct entry
+    {
+        std::string str;
+        std::uint64_t hash;
+    };
+
+    static constexpr unsigned first_chunk_bits = 6;
+    static constexpr std::uint64_t first_chunk_size = 1ull << first_chunk_bits;
+    /** enough chunks for all 32 bit ids */
+    static constexpr unsigned nchunks = 32 - first_chunk_bits + 1;
+
+    string_pool();
+
+    inline const entry &at(std::uint32_t id) const noexcept
+    {
+        auto n = static_cast<std::uint64_t>(id) + first_chunk_size;
+        unsigned k = 63 - __builtin_clzll(n) - first_chunk_bits;
+        const entry *chunk = chunks_[k].load(std::memory_order_acquire);
+        return chunk[n - (first_chunk_size << k)];
+    }
+
+    std::array<std::atomic<entry *>, nchunks> chunks_;
+    std::array<std::unique_ptr<entry[]>, nchunks> storage_;
+    std::uint32_t size_;
+
+    /** string to id, references the strings in the chunks */
+    std::unordered_map<std::reference_wrapper<const std::string>, std::uint32_t,
+        std::hash<std::string>, std::equal_to<std::string>>
+        ids_;
+    mutable std::mutex lock_;
+};
+
+/** An interned string of the \ref string_pool.
+ *
+ * A symbol is 32 bit in size, copying it does not allocate, and two symbols are equal if their ids
+ * are equal. A default constructed symbol is the empty string.
+ */
+class symbol
+{
+public:
+    inline symbol() noexcept : id_(0)
+    {
+    }
+
+    inline explicit symbol(const std::string &s) : id_(string_pool::instance().intern(s))
+    {
+    }
+
+    inline const std::string &str() const noexcept
+    {
+        return string_pool::instance().str(id_);
+    }
+
+    /** returns std::hash<std::string> of the string, without hashing it again
+     */
+    inline std::uint64_t hash() const noexcept
+    {
+        return string_pool::instance().hash(id_);
+    }
+
+    inline std::uint32_t id() const noexcept
+    {
+        return id_;
+    }
+
+    inline bool empty() const noexcept
+    {
+        return id_ == 0;
+    }
+
+    inline bool operator==(const symbol &other) const noexcept
+    {
+        return id_ == other.id_;
+    }
+
+    inline bool operator!=(const symbol &other) const noexcept
+    {
+        return id_ != other.id_;
+    }
+
+private:
+    std::uint32_t id_;
+};
+
+inline std::ostream &operator<<(std::ostream &s, const symbol &sym)
+{
+    return s << sym.str();
+}
+} // namespace tmm
+} // namespace rrl
+
+#endif /* INCLUDE_TMM_STRING_POOL_HPP_ */
@@ -2,12 +2,16 @@
 #define INCLUDE_RRL_TUNING_MODEL_HPP_
 
 #include <tmm/callpath.hpp>
+#include <tmm/callpath_trie.hpp>
 #include <tmm/identifiers.hpp>
 #include <tmm/region.hpp>
 #include <tmm/tuning_model_manager.hpp>
 
 #include <chrono>
+#include <cstddef>
+#include <functional>
 #include <memory>
+#include <ostream>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -17,63 +21,98 @@ namespace rrl
 namespace tmm
 {
 class parameter_tuple;
+class binary_model;
 
 typedef std::vector<callpath_element> callpath;
 typedef std::unordered_map<size_t, int> configuration_t;
 
+/** summary of a tuning model, see tuning_model::statistics()
+ */
+struct tuning_model_statistics
+{
+    std::size_t nrts = 0;
+    std::size_t nscenarios = 0;
+    std::size_t max_scenarios = 0; /**< scenarios of the rts with the most scenarios */
+    std::size_t nparameters = 0;   /**< distinct parameters of all configurations */
+    std::size_t nclusters = 0;
+    /** number of rts per callpath length, the index is the length */
+    std::vector<std::size_t> depth_histogram;
+    /** number of distinct values per identifier id, in the callpaths and in the scenarios */
+    std::unordered_map<std::size_t, std::size_t> identifier_cardinality;
+};
+
 class tuning_model final
 {
 public:
-    inline bool has_region(const region_id &rid) const noexcept
-    {
-        for (const auto &pair : regions_)
-        {
-            if (pair.second == rid)
-                return true;
-        }
+    bool has_region(const region_id &rid) const noexcept;
 
-        return false;
-    }
+    size_t nidentifiers(const region_id &rid) const;
 
-    inline size_t nidentifiers(const region_id &rid) const
-    {
-        RRL_DEBUG_ASSERT(has_region(rid));
-        return nidentifiers_.at(rid);
-    }
+    bool has_rts(const std::vector<callpath_element> &cp) const noexcept;
 
-    inline bool has_rts(const std::vector<callpath_element> &cp) const noexcept
-    {
-        return scenarios_.find(cp) != scenarios_.end();
-    }
-
-    inline std::chrono::milliseconds exectime(const std::vector<callpath_element> &cp) const
-        noexcept
-    {
-        RRL_DEBUG_ASSERT(has_rts(cp));
-        return exectimes_.at(cp);
-    }
+    std::chrono::milliseconds exectime(const std::vector<callpath_element> &cp) const noexcept;
 
     const std::unordered_map<identifier_set, configuration_t> *configurations(
         const std::vector<callpath_element> &cp) const;
 
-    inline size_t ncallpaths() const noexcept
+    /** Returns the callpaths of the JSON model and the stored configurations. The callpaths of
+     * a binary model are not part of the trie, see \ref binary_model.
+     */
+    inline const callpath_trie &trie() const noexcept
     {
-        return scenarios_.size();
+        return trie_;
     }
 
-    inline size_t ninputidsets(const std::vector<callpath_element> &cp) const noexcept
-    {
-        if (scenarios_.find(cp) != scenarios_.end())
-            return scenarios_.at(cp)->size();
-
-        return 0;
-    }
-
-    void deserialize(std::istream &is);
-
-    std::string to_dot() const;
-
-    std::string to_matrix() const;
+    /** Like configurations(cp), for the callpath of a node of trie(). Returns nullptr if the node
+     * has no rts.
+     */
+    const std::unordered_map<identifier_set, configuration_t> *configurations(
+        const callpath_trie::node &node) const;
+
+    /** Like exectime(cp), for the callpath of a node of trie() which has an rts.
+     */
+    std::chrono::milliseconds exectime(const callpath_trie::node &node) const noexcept;
+
+    size_t ncallpaths() const noexcept;
+
+    size_t ninputidsets(const std::vector<callpath_element> &cp) const noexcept;
+
+    /** Reads a tuning model in the JSON format. A previously read model is replaced.
+     *
+     * The model is validated completely. If lazy is set, only the regions and the trie of the
+     * callpaths are built. The scenarios of a callpath are decoded when they are requested by
+     * configurations(), which saves time and memory if only some rts of the model are visited.
+     *
+     * @throws std::runtime_error if the model is invalid
+     */
+    void deserialize(std::istream &is, bool lazy = false);
+
+    /** Uses a tuning model in the binary format, see \ref binary_model. The model is queried in
+     * place, only the scenarios of the requested callpaths are decoded.
+     */
+    void load_binary(std::shared_ptr<const binary_model> model);
+
+    /** removes all regions, callpaths and clusters
+     */
+    void clear();
+
+    /** Writes the callpaths as a graph in the dot format. Each rts is a box, labeled with its
+     * number of scenarios and its execution time. The graph is written rts by rts, so it is never
+     * built in memory.
+     */
+    void to_dot(std::ostream &os) const;
+
+    /** Writes one tab separated line per scenario: the callpath, the input identifiers, the
+     * execution time in ms, and the value of each parameter. The header line names the parameter
+     * columns by their ids. The parameters are collected in a first pass over the model, and the
+     * lines are written in a second pass.
+     */
+    void to_matrix(std::ostream &os) const;
+
+    /** Computes the statistics in one pass over the model. Large or deep models, and identifiers
+     * with many values, make the model slow to load and to query.
+     */
+    tuning_model_statistics statistics() const;
 
     bool is_root(const callpath_element &cpe) const noexcept;
 
@@ -82,20 +121,79 @@ public:
         return clusters_;
     }
 
+    /** Stores the configuration as the only scenario of the rts of callpath. The region of the
+     * last element becomes a region of the model, like the regions of the rts of a JSON model.
+     */
     void store_configuration(const std::vector<callpath_element> &callpath,
         const std::vector<parameter_tuple> &configuration,
         const std::chrono::milliseconds &exectime);
 
+    /** Stores the configuration of one scenario of the rts of callpath, and sets the execution
+     * time of the rts. Other scenarios of the rts are kept, unless the rts is only part of the
+     * binary model, which the stored rts replaces. The region of the last element becomes a
+     * region of the model.
+     */
+    void store_scenario(const std::vector<callpath_element> &callpath,
+        const identifier_set &ids,
+        const configuration_t &configuration,
+        std::chrono::milliseconds exectime);
+
+    /** adds a cluster, an existing cluster with the same id is replaced
+     */
+    void add_cluster(int id, const phase_data_t &cluster);
+
+    /** Calls f for each rts of the model with its callpath, scenarios and execution time,
+     * including the rts of a binary model. The order is unspecified. Scenarios which are not
+     * decoded yet are only decoded for the call of f, they are not cached.
+     */
+    void for_each_rts(const std::function<void(const std::vector<callpath_element> &,
+            const std::unordered_map<identifier_set, configuration_t> &,
+            std::chrono::milliseconds)> &f) const;
+
 private:
+    friend class binary_model;
+
+    void add_region(const callpath_element &cpe);
+
     std::unordered_map<int, phase_data_t> clusters_;
     std::unordered_map<uint64_t, identifier_set> iids_;
 
     typedef std::unordered_map<identifier_set, configuration_t> inputidmap;
 
     std::unordered_map<uint64_t, rrl::tmm::region_id> regions_;
+    std::unordered_set<rrl::tmm::region_id> region_index_; /**< all values of regions_ */
     std::unordered_map<rrl::tmm::region_id, size_t> nidentifiers_;
-    std::unordered_map<callpath, std::unique_ptr<inputidmap>> scenarios_;
-    std::unordered_map<callpath, std::chrono::milliseconds> exectimes_;
+
+    /** scenario of a lazily deserialized rts, referring to iids_ and lazy_configurations_ */
+    struct lazy_scenario
+    {
+        std::uint64_t iid;
+        std::uint64_t scenario;
+    };
+    struct rts
+    {
+        const callpath_trie::node *node;
+        /** nullptr until the lazy scenarios are decoded by configurations() */
+        mutable std::unique_ptr<inputidmap> scenarios;
+        std::vector<lazy_scenario> lazy;
+        std::chrono::milliseconds exectime;
+    };
+
+    rts &insert_rts(const std::vector<callpath_element> &cp);
+    inputidmap decode_scenarios(const rts &rts) const;
+    const rts *find_rts(const std::vector<callpath_element> &cp) const noexcept;
+
+    /** callpaths of the model, the value of a node is its index in rtss_ */
+    callpath_trie trie_;
+    std::vector<rts> rtss_;
+    std::unordered_map<uint64_t, configuration_t> lazy_configurations_;
+
+    /** Binary model the tuning model is based on. Configurations in rtss_ are stored in
+     * addition, and take precedence.
+     */
+    std::shared_ptr<const binary_model> binary_;
+    /** scenarios of the binary model, decoded on request */
+    mutable std::unordered_map<callpath, std::unique_ptr<inputidmap>> decoded_scenarios_;
 };
 }
 }
@@ -2,6 +2,7 @@
 #define INCLUDE_RRL_TUNING_MODEL_MANAGER_HPP_
 
 #include <tmm/callpath.hpp>
+#include <tmm/callpath_table.hpp>
 #include <tmm/parameter_tuple.hpp>
 #include <tmm/region.hpp>
 #include <tmm/simple_callpath.hpp>
@@ -12,6 +13,8 @@
 #include <map>
 #include <memory>
 #include <set>
+#include <stdexcept>
+#include <string>
 #include <tuple>
 #include <unordered_map>
 #include <vector>
@@ -70,6 +73,16 @@ using phase_data_t = std::pair<phases_in_cluster_t,
     phase_identifier_range_t>; /**< The TMM returns the phase_data_t inter-phase information for
                                   runtime cluster prediction */
 
+/** Describes the part of the call tree, which is affected by a change of the tuning model, see
+ * tuning_model_manager::take_change().
+ */
+struct tuning_model_change
+{
+    bool all = true; /**< all nodes are affected, callpaths and regions are not used */
+    std::vector<callpath_id> callpaths; /**< interned callpaths, whose rts changed */
+    std::vector<std::uint32_t> regions; /**< Score-P regions, whose significance changed */
+};
+
 /**The tuning_model_manager base class manages reads and writes
  * to the tuning model.
  *
@@ -80,7 +93,7 @@ public:
     /** Creates and initializes an empty tuning model manager.
      *
      **/
-    inline constexpr tuning_model_manager() noexcept
+    inline tuning_model_manager() noexcept
     {
     }
 
@@ -216,6 +229,49 @@ public:
     virtual std::chrono::milliseconds get_exectime(
         const std::vector<simple_callpath_element> &callpath) noexcept = 0;
 
+    /** Returns the table used to intern callpaths, see \ref callpath_table.
+     *
+     * The ids of this table can be passed to the overloads of \ref store_configuration,
+     * \ref get_current_rts_configuration and \ref get_exectime that take a \ref callpath_id.
+     */
+    inline callpath_table &callpaths() noexcept
+    {
+        return callpaths_;
+    }
+
+    /** Same as \ref store_configuration, but takes the id of an interned callpath.
+     *
+     * The default implementation looks up the callpath in \ref callpaths().
+     */
+    virtual void store_configuration(callpath_id callpath,
+        const std::vector<parameter_tuple> &configuration,
+        std::chrono::milliseconds exectime);
+
+    /** Same as \ref store_configuration, with the energy the rts consumed during its last
+     * calibrated execution.
+     *
+     * The default implementation ignores the energy.
+     *
+     * @param energy energy in the unit of the energy metric, NaN if it was not measured
+     */
+    virtual void store_configuration(callpath_id callpath,
+        const std::vector<parameter_tuple> &configuration,
+        std::chrono::milliseconds exectime,
+        double energy);
+
+    /** Same as \ref get_current_rts_configuration, but takes the id of an interned callpath.
+     *
+     * The default implementation looks up the callpath in \ref callpaths().
+     */
+    virtual const std::vector<parameter_tuple> get_current_rts_configuration(callpath_id callpath,
+        const std::unordered_map<std::string, std::string> &input_identifers);
+
+    /** Same as \ref get_exectime, but takes the id of an interned callpath.
+     *
+     * The default implementation looks up the callpath in \ref callpaths().
+     */
+    virtual std::chrono::milliseconds get_exectime(callpath_id callpath) noexcept;
+
     /** Retuns data for interphase identification.
      *
      * @return data saved in the TM for interphase dynmaism for each RTS described by
@@ -231,6 +287,31 @@ public:
 
     virtual void set_changed(bool) noexcept = 0;
 
+    /** Has to be called after has_changed() returned true. Completes the change, and returns the
+     * part of the call tree it affects. By default all nodes are affected.
+     */
+    virtual tuning_model_change take_change()
+    {
+        return tuning_model_change();
+    }
+
+    /** Reads a new tuning model, which replaces the current one with the next take_change(). Can
+     * be called from any thread.
+     *
+     * @throws std::runtime_error if the tuning model cannot be read, or the tuning model manager
+     *         does not support reloading
+     */
+    virtual void reload(const std::string &file_path)
+    {
+        throw std::runtime_error("The tuning model manager cannot reload a tuning model");
+    }
+
+    /** Called after MPI is initialised. Tuning model managers can use communication from here.
+     */
+    virtual void init_mpp()
+    {
+    }
+
     /**
      * Gets the region name for a region ID.
      *
@@ -245,6 +326,9 @@ public:
      * @return Region ID for the given name
      */
     virtual std::uint32_t get_id_from_region_name(const std::string region_name) noexcept = 0;
+
+protected:
+    callpath_table callpaths_; /**< interned callpaths, see \ref callpaths() */
 };
 
 /** This function returns an instance of one of the tuning_model_manager
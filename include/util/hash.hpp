@@ -0,0 +1,76 @@
+#ifndef INCLUDE_UTIL_HASH_HPP_
+#define INCLUDE_UTIL_HASH_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace rrl
+{
+/** Allocation free hash functions for the keys of the tuning model and calibration maps.
+ *
+ * Values are combined with the multiply and fold mixing of wyhash: both operands are xored with a
+ * secret, multiplied to a 128 bit product, and the upper and lower half of the product are xored.
+ */
+namespace hash
+{
+constexpr std::uint64_t secret0 = 0xa0761d6478bd642full;
+constexpr std::uint64_t secret1 = 0xe7037ed1a0b428dbull;
+constexpr std::uint64_t secret2 = 0x8ebc6af09c88c6e3ull;
+
+/** multiplies a and b to 128 bit and folds the product to 64 bit
+ */
+inline std::uint64_t mum(std::uint64_t a, std::uint64_t b) noexcept
+{
+#ifdef __SIZEOF_INT128__
+    /* __extension__ silences -pedantic, __int128 is a GCC and Clang extension */
+    __extension__ typedef unsigned __int128 uint128;
+    auto product = static_cast<uint128>(a) * b;
+    return static_cast<std::uint64_t>(product) ^ static_cast<std::uint64_t>(product >> 64);
+#else
+    std::uint64_t a_high = a >> 32, a_low = static_cast<std::uint32_t>(a);
+    std::uint64_t b_high = b >> 32, b_low = static_cast<std::uint32_t>(b);
+    std::uint64_t high_high = a_high * b_high, high_low = a_high * b_low;
+    std::uint64_t low_high = a_low * b_high, low_low = a_low * b_low;
+    std::uint64_t middle = high_low + low_high;
+    std::uint64_t low = low_low + (middle << 32);
+    std::uint64_t high = high_high + (middle >> 32) + (low < low_low) +
+                         (static_cast<std::uint64_t>(middle < high_low) << 32);
+    return low ^ high;
+#endif
+}
+
+/** combines the hash seed with an additional value
+ */
+inline std::uint64_t combine(std::uint64_t seed, std::uint64_t value) noexcept
+{
+    return mum(seed ^ secret0, value ^ secret1);
+}
+
+/** last step of a hash computation, spreads the entropy of all bits to the lower bits, which are
+ * used by std::unordered_map to choose the bucket.
+ */
+inline std::size_t finalize(std::uint64_t hash) noexcept
+{
+    return static_cast<std::size_t>(mum(hash ^ secret2, hash));
+}
+
+inline std::uint64_t value(std::uint64_t value) noexcept
+{
+    return value;
+}
+
+inline std::uint64_t value(std::int64_t value) noexcept
+{
+    return static_cast<std::uint64_t>(value);
+}
+
+inline std::uint64_t value(const std::string &value) noexcept
+{
+    return std::hash<std::string>{}(value);
+}
+} // namespace hash
+} // namespace rrl
+
+#endif /* INCLUDE_UTIL_HASH_HPP_ */
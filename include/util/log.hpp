@@ -101,6 +101,14 @@ public:
 };
 
 template <typename Record> using log_filter = nitro::log::filter::severity_filter<Record>;
+
+/** holds the severity level that was last passed to set_min_severity_level()
+ */
+inline nitro::log::severity_level &min_severity_level()
+{
+    static nitro::log::severity_level level = nitro::log::severity_level::info;
+    return level;
+}
 }
 
 typedef nitro::log::
@@ -110,6 +118,22 @@ typedef nitro::log::
 inline void set_min_severity_level(nitro::log::severity_level sev)
 {
     detail::log_filter<detail::record>::set_severity(sev);
+    detail::min_severity_level() = sev;
+}
+
+/** Returns true if trace messages are written.
+ *
+ * The arguments of logging::trace() are evaluated even if the message is filtered later on. Use
+ * RRL_TRACE() in hot code paths, which only evaluates them if this function returns true.
+ * Defining RRL_DISABLE_TRACE removes all trace messages written with RRL_TRACE() at compile time.
+ */
+inline bool trace_enabled() noexcept
+{
+#ifdef RRL_DISABLE_TRACE
+    return false;
+#else
+    return detail::min_severity_level() == nitro::log::severity_level::trace;
+#endif
 }
 
 inline void set_ipc_rank(int rank)
@@ -122,4 +146,14 @@ inline void set_ipc_rank(int rank)
 using log::logging;
 }
 
+/** Writes a trace message like logging::trace(tag), but the message and everything streamed into
+ * it is only evaluated if rrl::log::trace_enabled() is true.
+ */
+#define RRL_TRACE(tag)                                                                             \
+    if (!rrl::log::trace_enabled())                                                                \
+    {                                                                                              \
+    }                                                                                              \
+    else                                                                                           \
+        rrl::logging::trace(tag)
+
 #endif /* INCLUDE_RRL_LOG_HPP_ */
@@ -0,0 +1,106 @@
+#ifndef INCLUDE_UTIL_SPSC_QUEUE_HPP_
+#define INCLUDE_UTIL_SPSC_QUEUE_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace rrl
+{
+/** Bounded lock free queue for one producer and one consumer thread.
+ *
+ * The producer stages elements with \ref try_stage, and makes them visible to the consumer at once
+ * with \ref publish, so the consumer never sees a partially written batch. Neither side allocates
+ * after construction.
+ *
+ * The head and the tail are written by different threads, the padding keeps them on different
+ * cache lines.
+ */
+template <typename T> class spsc_queue
+{
+public:
+    /** @param capacity minimal number of elements, rounded up to a power of two
+     */
+    explicit spsc_queue(std::size_t capacity) : head_(0), tail_(0), staged_(0), cached_head_(0)
+    {
+        std::size_t size = 1;
+        while (size < capacity)
+        {
+            size <<= 1;
+        }
+        buffer_.resize(size);
+        mask_ = size - 1;
+    }
+
+    spsc_queue(const spsc_queue &) = delete;
+    spsc_queue &operator=(const spsc_queue &) = delete;
+
+    /** Writes value behind the staged elements, without making it visible to the consumer.
+     * Producer only.
+     *
+     * @return false if the queue is full
+     */
+    inline bool try_stage(const T &value) noexcept
+    {
+        if (staged_ - cached_head_ > mask_)
+        {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            if (staged_ - cached_head_ > mask_)
+            {
+                return false;
+            }
+        }
+        buffer_[staged_ & mask_] = value;
+        staged_++;
+        return true;
+    }
+
+    /** makes all staged elements visible to the consumer. Producer only.
+     */
+    inline void publish() noexcept
+    {
+        tail_.store(staged_, std::memory_order_release);
+    }
+
+    /** Removes the oldest published element. Consumer only.
+     *
+     * @return false if there is no published element
+     */
+    inline bool try_pop(T &value) noexcept
+    {
+        auto head = head_.load(std::memory_order_relaxed);
+        if (head == tail_.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+        value = buffer_[head & mask_];
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /** checks if there are published elements, which are not popped yet
+     */
+    inline bool empty() const noexcept
+    {
+        return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+    }
+
+    inline std::size_t capacity() const noexcept
+    {
+        return mask_ + 1;
+    }
+
+private:
+    std::vector<T> buffer_;
+    std::size_t mask_;
+
+    std::atomic<std::size_t> head_; /**< written by the consumer */
+    char head_padding_[64];
+    std::atomic<std::size_t> tail_; /**< written by the producer */
+    std::size_t staged_;            /**< producer only */
+    std::size_t cached_head_;       /**< producer only, avoids reading head_ for every element */
+    char tail_padding_[64];
+};
+} // namespace rrl
+
+#endif /* INCLUDE_UTIL_SPSC_QUEUE_HPP_ */
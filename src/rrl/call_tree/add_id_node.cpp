@@ -71,20 +71,16 @@ base_node* add_id_node::return_to_parent()
 }
 
 void add_id_node::reset_state()
+{
+    invalidate();
+    child_uints.for_each([](base_node* node) { node->reset_state(); });
+    child_ints.for_each([](base_node* node) { node->reset_state(); });
+    child_string.for_each([](base_node* node) { node->reset_state(); });
+}
+
+void add_id_node::invalidate()
 {
     info.state = node_state::known;
-    for (auto& elem : child_uints)
-    {
-        elem.second->reset_state();
-    }
-    for (auto& elem : child_ints)
-    {
-        elem.second->reset_state();
-    }
-    for (auto& elem : child_string)
-    {
-        elem.second->reset_state();
-    }
 }
 
 bool add_id_node::callibrate_region(std::chrono::milliseconds significant_threshold)
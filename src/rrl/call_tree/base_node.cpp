@@ -7,6 +7,16 @@ namespace call_tree
 {
 base_node::base_node(base_node* parent, node_info info) : parent_(parent), info(info)
 {
+    /* the parent of a root is part of the call tree of another location, see rts_handler */
+    if ((parent == nullptr) || (info.type == node_type::root))
+    {
+        owned_arena_ = std::make_unique<node_arena>();
+        arena_ = owned_arena_.get();
+    }
+    else
+    {
+        arena_ = &parent->arena();
+    }
     start_measurment();
 }
 base_node::~base_node()
@@ -23,6 +33,11 @@ void base_node::reset_state()
     throw not_implemented();
 }
 
+void base_node::invalidate()
+{
+    throw not_implemented();
+}
+
 base_node* base_node::enter_node(std::uint32_t region)
 {
     throw not_implemented();
@@ -38,12 +53,28 @@ std::vector<tmm::simple_callpath_element> base_node::build_callpath()
     throw not_implemented();
 }
 
+tmm::callpath_id base_node::callpath_id(tmm::callpath_table& table)
+{
+    if (!has_callpath_id_)
+    {
+        callpath_id_ = table.intern(build_callpath());
+        has_callpath_id_ = true;
+    }
+    return callpath_id_;
+}
+
+bool base_node::cached_callpath_id(tmm::callpath_id& id) const noexcept
+{
+    id = callpath_id_;
+    return has_callpath_id_;
+}
+
 bool base_node::callibrate_region(std::chrono::milliseconds significant_threshold)
 {
     throw not_implemented();
 }
 
-void base_node::set_configuration(const std::vector<tmm::parameter_tuple>& configuration)
+void base_node::set_configuration(const cm::slot_setting& configuration)
 {
     configuration_ = configuration;
     if (parent_ != nullptr)
@@ -52,7 +83,7 @@ void base_node::set_configuration(const std::vector<tmm::parameter_tuple>& confi
     }
 }
 
-const std::vector<tmm::parameter_tuple>& base_node::get_configuration()
+const cm::slot_setting& base_node::get_configuration()
 {
     return configuration_;
 }
@@ -62,7 +93,8 @@ void base_node::set_child_with_configuration()
     if (!info.child_with_configuration)
     {
         info.child_with_configuration = true;
-        if (parent_ != nullptr)
+        /* the parent of a root is part of the call tree of another location, see rts_handler */
+        if ((parent_ != nullptr) && (info.type != node_type::root))
         {
             parent_->set_child_with_configuration();
         }
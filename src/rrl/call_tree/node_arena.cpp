@@ -0,0 +1,43 @@
+#include <rrl/call_tree/base_node.hpp>
+#include <rrl/call_tree/node_arena.hpp>
+
+#include <algorithm>
+#include <cstdint>
+
+namespace rrl
+{
+namespace call_tree
+{
+constexpr std::size_t node_arena::block_size;
+
+node_arena::~node_arena()
+{
+    for (auto node = nodes_.rbegin(); node != nodes_.rend(); ++node)
+    {
+        (*node)->~base_node();
+    }
+}
+
+/** Returns size bytes of memory with the given alignment. A new block is started if the last
+ * block has not enough space left. Objects larger than a block get a block of their own.
+ */
+void *node_arena::allocate(std::size_t size, std::size_t alignment)
+{
+    auto padding = (alignment - reinterpret_cast<std::uintptr_t>(current_) % alignment) % alignment;
+    if (current_ == nullptr || padding + size > left_)
+    {
+        auto new_block_size = std::max(block_size, size + alignment);
+        blocks_.emplace_back(new char[new_block_size]);
+        current_ = blocks_.back().get();
+        left_ = new_block_size;
+        padding =
+            (alignment - reinterpret_cast<std::uintptr_t>(current_) % alignment) % alignment;
+    }
+
+    auto memory = current_ + padding;
+    current_ += padding + size;
+    left_ -= padding + size;
+    return memory;
+}
+}
+}
@@ -26,6 +26,11 @@ std::vector<tmm::simple_callpath_element> region_node::build_callpath()
 {
     if (info.type == node_type::root)
     {
+        /* the root of a worker call tree continues the callpath of the forking location */
+        if (parent_ != nullptr)
+        {
+            return parent_->build_callpath();
+        }
         return std::move(std::vector<tmm::simple_callpath_element>());
     }
     else
@@ -36,16 +41,15 @@ std::vector<tmm::simple_callpath_element> region_node::build_callpath()
     }
 }
 void region_node::reset_state()
+{
+    invalidate();
+    child_regions.for_each([](base_node* node) { node->reset_state(); });
+    child_add_ids.for_each([](base_node* node) { node->reset_state(); });
+}
+
+void region_node::invalidate()
 {
     info.state = node_state::unknown;
-    for (auto& elem : child_regions)
-    {
-        elem.second->reset_state();
-    }
-    for (auto& elem : child_add_ids)
-    {
-        elem.second->reset_state();
-    }
 }
 
 bool region_node::callibrate_region(std::chrono::milliseconds significant_threshold)
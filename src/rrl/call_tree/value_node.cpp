@@ -44,16 +44,16 @@ base_node* value_node<T>::return_to_parent()
 
 template <typename T>
 void value_node<T>::reset_state()
+{
+    invalidate();
+    child_regions.for_each([](base_node* node) { node->reset_state(); });
+    child_add_ids.for_each([](base_node* node) { node->reset_state(); });
+}
+
+template <typename T>
+void value_node<T>::invalidate()
 {
     info.state = node_state::unknown;
-    for (auto& elem : child_regions)
-    {
-        elem.second->reset_state();
-    }
-    for (auto& elem : child_add_ids)
-    {
-        elem.second->reset_state();
-    }
 }
 
 template <typename T>
@@ -10,6 +10,7 @@
 #include <vector>
 
 #include <rrl/cm/cm_base.hpp>
+#include <rrl/cm/cm_delta.hpp>
 #include <rrl/cm/cm_no_reset.hpp>
 #include <rrl/cm/cm_reset.hpp>
 
@@ -18,12 +19,17 @@ namespace rrl
 namespace cm
 {
 
-std::unique_ptr<cm_base> create_new_instance(setting config, std::string check_if_reset)
+std::unique_ptr<cm_base> create_new_instance(
+    const slot_setting &config, const std::string &check_if_reset)
 {
     if (check_if_reset == "no_reset")
     {
         return std::make_unique<cm_no_reset>(config);
     }
+    else if (check_if_reset == "delta")
+    {
+        return std::make_unique<cm_delta>(config);
+    }
     else
     {
         return std::make_unique<cm_reset>(config);
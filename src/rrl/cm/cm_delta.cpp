@@ -0,0 +1,72 @@
+#include <rrl/cm/cm_delta.hpp>
+
+namespace rrl
+{
+namespace cm
+{
+
+cm_delta::cm_delta(const slot_setting &default_configs) : current_(default_configs)
+{
+    /* the stacks only allocate for deeply nested regions */
+    levels_.reserve(32);
+    old_values_.reserve(32 * 8);
+}
+
+void cm_delta::set(const slot_setting &new_configs)
+{
+    RRL_TRACE("CM_DELTA") << "Setting the parameters with the mask " << std::hex
+                          << new_configs.mask << ", the other parameters keep the last used values";
+    auto changed = slot_setting::changes(current_, new_configs);
+    auto added = changed & ~current_.mask;
+    for_each_slot(changed & ~added, [this](std::size_t slot) {
+        old_values_.push_back(current_.values[slot]);
+    });
+    levels_.push_back({changed, added});
+    current_.merge(new_configs);
+}
+
+/** The old values of a level are stored in ascending order of their slots, at the end of
+ * old_values_.
+ */
+std::uint64_t cm_delta::unset()
+{
+    RRL_TRACE("CM_DELTA") << "reset is called, stack depth befor pop: " << levels_.size() + 1;
+    if (levels_.empty())
+    {
+        logging::warn("CM_DELTA") << "unset without set, keeping the default configuration";
+        return 0;
+    }
+    auto level = levels_.back();
+    levels_.pop_back();
+
+    auto restored = level.changed & ~level.added;
+    auto index = old_values_.size() - __builtin_popcountll(restored);
+    auto begin = index;
+    for_each_slot(restored, [this, &index](std::size_t slot) {
+        current_.values[slot] = old_values_[index++];
+    });
+    old_values_.resize(begin);
+    current_.mask &= ~level.added;
+    return restored;
+}
+
+/** An ATP which is added to a level is removed again with this level, like in \ref cm_reset.
+ */
+void cm_delta::atp_add(std::size_t slot, int value)
+{
+    if (!current_.has(slot))
+    {
+        current_.set(slot, value);
+        if (!levels_.empty())
+        {
+            levels_.back().added |= std::uint64_t(1) << slot;
+        }
+    }
+}
+
+const slot_setting &cm_delta::current() const
+{
+    return current_;
+}
+}
+}
@@ -15,8 +15,10 @@ namespace rrl
 namespace cm
 {
 
-cm_reset::cm_reset(setting default_configs)
+cm_reset::cm_reset(const slot_setting &default_configs)
 {
+    /* the stack only allocates for deeply nested regions */
+    settings.reserve(32);
     settings.push_back(default_configs);
 }
 
@@ -24,56 +26,36 @@ cm_reset::~cm_reset()
 {
 }
 
-void cm_reset::set(setting new_configs)
+void cm_reset::set(const slot_setting &new_configs)
 {
-
-    for (auto current_config : settings.back())
-    {
-        auto new_config = std::find_if(
-            new_configs.begin(), new_configs.end(), [current_config](tmm::parameter_tuple nc) {
-                return nc.parameter_id == current_config.parameter_id;
-            });
-
-        if (new_config != new_configs.end())
-        {
-            logging::trace("CM_RESET") << "Setting the value of parameter with hash ("
-                                       << new_config->parameter_id
-                                       << ") to:" << new_config->parameter_value;
-        }
-        else
-        {
-            logging::trace("CM_RESET") << "Setting the value of missing parameter with hash ("
-                                       << current_config.parameter_id
-                                       << ") to the last used:" << current_config.parameter_value;
-            new_configs.push_back(current_config);
-        }
-    }
-
-    settings.push_back(new_configs);
+    RRL_TRACE("CM_RESET") << "Setting the parameters with the mask " << std::hex << new_configs.mask
+                          << ", the other parameters keep the last used values";
+    settings.push_back(settings.back());
+    settings.back().merge(new_configs);
 }
 
-setting cm_reset::unset()
+std::uint64_t cm_reset::unset()
 {
-    logging::trace("CM_RESET") << "reset is called";
-    logging::trace("CM_RESET") << "stack befor pop\n" << settings;
+    RRL_TRACE("CM_RESET") << "reset is called, stack depth befor pop: " << settings.size();
+    if (settings.size() < 2)
+    {
+        logging::warn("CM_RESET") << "unset without set, keeping the default configuration";
+        return 0;
+    }
+    auto changed = slot_setting::changes(settings.back(), settings[settings.size() - 2]);
     settings.pop_back();
-    logging::trace("CM_RESET") << "stack after reset\n" << settings;
-    return settings.back();
+    return changed;
 }
 
-void cm_reset::atp_add(tmm::parameter_tuple atp)
+void cm_reset::atp_add(std::size_t slot, int value)
 {
-    auto function = std::find_if(settings.back().begin(),
-        settings.back().end(),
-        [atp](tmm::parameter_tuple f) { return f.parameter_id == atp.parameter_id; });
-
-    if (function == settings.back().end())
+    if (!settings.back().has(slot))
     {
-        settings.back().push_back(atp);
+        settings.back().set(slot, value);
     }
 }
 
-setting cm_reset::get_current_config()
+const slot_setting &cm_reset::current() const
 {
     return settings.back();
 }
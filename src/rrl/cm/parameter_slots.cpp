@@ -0,0 +1,74 @@
+#include <rrl/cm/parameter_slots.hpp>
+
+#include <util/log.hpp>
+
+namespace rrl
+{
+namespace cm
+{
+constexpr std::size_t parameter_slots::npos;
+
+parameter_slots::parameter_slots() noexcept : size_(0)
+{
+    for (auto &id : ids_)
+    {
+        id.store(0, std::memory_order_relaxed);
+    }
+}
+
+/** The id is written before the size is increased, so a concurrent \ref find either sees the new
+ * slot completely or not at all.
+ */
+std::size_t parameter_slots::add(std::size_t parameter_id)
+{
+    auto slot = find(parameter_id);
+    if (slot != npos)
+    {
+        return slot;
+    }
+
+    std::lock_guard<std::mutex> lock(add_lock_);
+    slot = find(parameter_id);
+    if (slot != npos)
+    {
+        return slot;
+    }
+    auto size = size_.load(std::memory_order_relaxed);
+    if (size == max_slots)
+    {
+        if (ignored_.insert(parameter_id).second)
+        {
+            logging::error("CM") << "more than " << max_slots << " parameters, ignoring parameter "
+                                 << parameter_id;
+        }
+        return npos;
+    }
+    ids_[size].store(parameter_id, std::memory_order_relaxed);
+    size_.store(size + 1, std::memory_order_release);
+    return size;
+}
+
+slot_setting parameter_slots::to_slots(const std::vector<tmm::parameter_tuple> &configs)
+{
+    slot_setting setting;
+    for (const auto &config : configs)
+    {
+        auto slot = add(config.parameter_id);
+        if (slot != npos)
+        {
+            setting.set(slot, config.parameter_value);
+        }
+    }
+    return setting;
+}
+
+std::vector<tmm::parameter_tuple> parameter_slots::to_tuples(const slot_setting &setting) const
+{
+    std::vector<tmm::parameter_tuple> configs;
+    for_each_slot(setting.mask, [this, &setting, &configs](std::size_t slot) {
+        configs.emplace_back(id(slot), setting.values[slot]);
+    });
+    return configs;
+}
+} // namespace cm
+} // namespace rrl
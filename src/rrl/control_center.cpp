@@ -1,7 +1,9 @@
+#include <algorithm>
 #include <iostream>
 #include <memory>
 
 #include <rrl/control_center.hpp>
+#include <rrl/parameter_controller.hpp>
 
 #include <util/config.hpp>
 #include <util/environment.hpp>
@@ -9,7 +11,11 @@
 
 #include <json.hpp>
 
+#include <unistd.h>
+
 #define TMM_PATH "TMM_PATH"
+#define OVERHEAD_STATISTICS_FILE "OVERHEAD_STATISTICS_FILE"
+#define PER_LOCATION_TUNING "PER_LOCATION_TUNING"
 
 #ifndef GIT_REV
 #define GIT_REV "no_rev"
@@ -36,17 +42,31 @@ control_center::control_center()
     : tmm_(tmm::get_tuning_model_manager(environment::get(TMM_PATH, ""))),
       mm_(std::make_shared<rrl::metric_manager>()),
       cal_(cal::get_calibration(mm_, tmm_->get_calibration_type())),
-      rts_(tmm_, cal_),
+      rts_(tmm_, cal_, mm_),
       oa_event_receiver_(tmm_),
-      filter_()
+      filter_(),
+      statistics_(std::vector<std::string>(region_types_string.begin(), region_types_string.end()))
 {
     logging::info("CC") << "RRL Version: " << VERSION_RRL;
     logging::info("CC") << "GIT revision: " << GIT_REV;
     logging::debug("CC") << " init rrl";
 
-    invocation_count.assign(i_max, 0);
-    invocation_variance_x_2.assign(i_max, 0);
-    invocation_duration.assign(i_max, std::chrono::nanoseconds(0));
+    auto per_location_tuning = environment::get(PER_LOCATION_TUNING, "false");
+    std::transform(per_location_tuning.begin(),
+        per_location_tuning.end(),
+        per_location_tuning.begin(),
+        ::tolower);
+    per_location_tuning_ = per_location_tuning == "true";
+    if (per_location_tuning_ && parameter_controller::instance().get_switcher() != nullptr)
+    {
+        /* workers would call the plugins behind the back of the switcher, which skips the
+         * switches to values it applied last */
+        logging::warn("CC") << "per location tuning is not supported with SCOREP_RRL_ASYNC_SWITCH, "
+                               "tuning the master thread only";
+        per_location_tuning_ = false;
+    }
+    logging::debug("CC") << "per location tuning is "
+                         << (per_location_tuning_ ? "enabled" : "disabled");
 }
 
 /**
@@ -58,37 +78,14 @@ control_center::control_center()
 
 control_center::~control_center()
 {
-    /*
-    enter_region_i,
-    exit_region_i,
-    register_region_i,
-    generic_command_i,
-    create_location_i,
-    delete_location_i,
-    user_parameter_i,
-    */
-
-    logging::debug("CC") << "Estimated Runtime of RRL for different events:";
-    for (int i = 0; i < i_max; i++)
+    statistics_.print();
+
+    auto statistics_file = environment::get(OVERHEAD_STATISTICS_FILE, "");
+    if (!statistics_file.empty())
     {
-        if (invocation_count[i] > 1)
-        {
-            double invocation_variance_x_2_s =
-                invocation_variance_x_2[i] * 1e-9;  // convert from nano (10^-9) to seconds
-            auto invocation_duration_s =
-                std::chrono::duration<double>(invocation_duration[i]).count();
-            double duration_deviation_2_s =
-                1.0 / (invocation_count[i] - 1) *
-                (invocation_variance_x_2_s -
-                    1 / invocation_count[i] * (invocation_duration_s * invocation_duration_s));
-            logging::debug("CC") << region_types_string[i] << "\n"
-                                 << "\tcount: " << invocation_count[i] << "\n"
-                                 << "\ttotal duration: " << invocation_duration_s << "s \n"
-                                 << "\taverage duration: "
-                                 << invocation_duration_s / invocation_count[i] << "s \n"
-                                 << "\t(duration deviation)^2: " << duration_deviation_2_s << "s*s";
-        }
+        statistics_.write_json(statistics_file + "." + std::to_string(getpid()) + ".json");
     }
+
     logging::debug("CC") << " fini rrl";
 }
 
@@ -99,6 +96,7 @@ control_center::~control_center()
 void control_center::init_mpp()
 {
     logging::debug("CC") << "got init_mpp";
+    tmm_->init_mpp();
     cal_->init_mpp();
 }
 
@@ -120,51 +118,38 @@ void control_center::enter_region(struct SCOREP_Location *location,
     SCOREP_RegionHandle regionHandle,
     std::uint64_t *metricValues)
 {
-    logging::trace("CC") << " Enter region: " << scorep::call::region_handle_get_name(regionHandle)
-                         << " id: " << scorep::call::region_handle_get_id(regionHandle)
-                         << " location: " << scorep::call::location_get_id(location);
+    if (log::trace_enabled())
+    {
+        trace_region_event("Enter", location, regionHandle);
+    }
 
-    switch (scorep::call::region_handle_get_type(regionHandle))
+    auto location_id = scorep::call::location_get_id(location);
+    if ((location_id != 0) && !per_location_tuning_)
     {
-        case SCOREP_REGION_USER:
-            logging::trace("CC") << " region type for id: "
-                                 << scorep::call::region_handle_get_id(regionHandle)
-                                 << ": SCOREP_REGION_USER";
-            break;
-        case SCOREP_REGION_FUNCTION:
-            logging::trace("CC") << " region type for id: "
-                                 << scorep::call::region_handle_get_id(regionHandle)
-                                 << ": SCOREP_REGION_FUNCTION";
-            break;
-        default:
-            logging::trace("CC") << " region type for id: "
-                                 << scorep::call::region_handle_get_id(regionHandle) << ": "
-                                 << scorep::call::region_handle_get_type(regionHandle);
-            break;
+        return;
+    }
+    auto &local = local_location(location_id);
+    bool master_only = (location_id == 0) && (local.fork_depth == 0);
+    if (!master_only && !per_location_tuning_)
+    {
+        return;
     }
 
-    if ((scorep::call::location_get_id(location) == 0) && (count_forks_joins == 0))
+    auto begin = std::chrono::high_resolution_clock::now();
+    /**
+     * rts might change the state of the system (depending on the output of the TMM and
+     * whatever config the cal_ requested). So first call cal_.
+     */
+    auto region_id = scorep::call::region_handle_get_id(regionHandle);
+    if (is_included(regionHandle, region_id))
     {
-        auto begin = std::chrono::high_resolution_clock::now();
-        logging::trace("CC") << "call [RTS] for id: "
-                             << scorep::call::region_handle_get_id(regionHandle);
-        /**
-         * rts might change the state of the system (depending on the output of the TMM and
-         * whatever config the cal_ requested). So first call cal_.
-         */
-        if (filter_.check_region(scorep::call::region_handle_get_name(regionHandle)))
+        if (master_only)
         {
-            logging::trace("CC") << scorep::call::region_handle_get_name(regionHandle)
-                                 << " is included";
             cal_->enter_region(regionHandle, location, metricValues);
-            rts_.enter_region(scorep::call::region_handle_get_id(regionHandle), location);
         }
-        auto end = std::chrono::high_resolution_clock::now();
-        auto duration = end - begin;
-        invocation_duration[enter_region_i] += duration;
-        invocation_count[enter_region_i]++;
-        invocation_variance_x_2[enter_region_i] += duration.count() * duration.count();
+        local.rts->enter_region(region_id, location, metricValues);
     }
+    statistics_.record(enter_region_i, std::chrono::high_resolution_clock::now() - begin);
 }
 
 /**
@@ -185,30 +170,141 @@ void control_center::exit_region(struct SCOREP_Location *location,
     SCOREP_RegionHandle regionHandle,
     std::uint64_t *metricValues)
 {
-    logging::trace("CC") << " Exit region: " << scorep::call::region_handle_get_name(regionHandle)
-                         << " id: " << scorep::call::region_handle_get_id(regionHandle)
-                         << " location: " << scorep::call::location_get_id(location);
+    if (log::trace_enabled())
+    {
+        trace_region_event("Exit", location, regionHandle);
+    }
 
-    if ((scorep::call::location_get_id(location) == 0) && (count_forks_joins == 0))
+    auto location_id = scorep::call::location_get_id(location);
+    if ((location_id != 0) && !per_location_tuning_)
     {
-        auto begin = std::chrono::high_resolution_clock::now();
-        /**
-         * rts might change the state of the system (depending on the output of the TMM and
-         * whatever config the cal_ requested). So first call cal_.
-         */
-        if (filter_.check_region(scorep::call::region_handle_get_name(regionHandle)))
+        return;
+    }
+    auto &local = local_location(location_id);
+    bool master_only = (location_id == 0) && (local.fork_depth == 0);
+    if (!master_only && !per_location_tuning_)
+    {
+        return;
+    }
+
+    auto begin = std::chrono::high_resolution_clock::now();
+    /**
+     * rts might change the state of the system (depending on the output of the TMM and
+     * whatever config the cal_ requested). So first call cal_.
+     */
+    auto region_id = scorep::call::region_handle_get_id(regionHandle);
+    if (is_included(regionHandle, region_id))
+    {
+        if (master_only)
         {
-            logging::trace("CC") << scorep::call::region_handle_get_name(regionHandle)
-                                 << " is included";
             cal_->exit_region(regionHandle, location, metricValues);
-            rts_.exit_region(scorep::call::region_handle_get_id(regionHandle), location);
         }
-        auto end = std::chrono::high_resolution_clock::now();
-        auto duration = end - begin;
-        invocation_duration[exit_region_i] += duration;
-        invocation_count[exit_region_i]++;
-        invocation_variance_x_2[exit_region_i] += duration.count() * duration.count();
+        local.rts->exit_region(region_id, location, metricValues);
+    }
+    statistics_.record(exit_region_i, std::chrono::high_resolution_clock::now() - begin);
+}
+
+/**
+ * Writes a trace message for an enter or exit event.
+ *
+ * @brief Writes a trace message for an enter or exit event. The region name is only requested
+ * from Score-P in here, so callers should check log::trace_enabled() before calling this.
+ *
+ * @param event name of the event
+ * @param location SCOREP location of the region
+ * @param regionHandle SCOREP region handle of the region
+ **/
+void control_center::trace_region_event(
+    const char *event, struct SCOREP_Location *location, SCOREP_RegionHandle regionHandle)
+{
+    auto region_id = scorep::call::region_handle_get_id(regionHandle);
+    logging::trace("CC") << " " << event
+                         << " region: " << scorep::call::region_handle_get_name(regionHandle)
+                         << " id: " << region_id
+                         << " location: " << scorep::call::location_get_id(location);
+
+    switch (scorep::call::region_handle_get_type(regionHandle))
+    {
+        case SCOREP_REGION_USER:
+            logging::trace("CC") << " region type for id: " << region_id << ": SCOREP_REGION_USER";
+            break;
+        case SCOREP_REGION_FUNCTION:
+            logging::trace("CC") << " region type for id: " << region_id
+                                 << ": SCOREP_REGION_FUNCTION";
+            break;
+        default:
+            logging::trace("CC") << " region type for id: " << region_id << ": "
+                                 << scorep::call::region_handle_get_type(regionHandle);
+            break;
+    }
+}
+
+/**
+ * Checks if a region passes the filter.
+ *
+ * @brief Checks if a region passes the filter. The decision is usually made once in
+ * register_region(). Regions that are entered without being registered before are checked
+ * here once, using their name, and cached afterwards.
+ *
+ * @param regionHandle SCOREP region handle of the region
+ * @param region_id Score-P region id of the region
+ * @return true if the region is included
+ **/
+bool control_center::is_included(SCOREP_RegionHandle regionHandle, std::uint32_t region_id)
+{
+    auto decision = filter_.cached_decision(region_id);
+    if (decision == filter::decision::unknown)
+    {
+        return filter_.register_region(
+            region_id, scorep::call::region_handle_get_name(regionHandle));
+    }
+    return decision == filter::decision::include;
+}
+
+/**
+ * Returns the data of the location of the calling thread.
+ *
+ * @brief Returns the data of the location of the calling thread. The data is created at the first
+ * call of a location. For per location tuning, worker locations get their own rts_handler, which
+ * belongs to the thread team recorded in create_location().
+ * Afterwards the data is cached per thread, so the location_loock is only taken once per thread.
+ *
+ * @param location_id Score-P location id of the calling thread
+ * @return the data of the location
+ **/
+control_center::location_data &control_center::local_location(std::uint32_t location_id)
+{
+    thread_local const control_center *owner = nullptr;
+    thread_local location_data *local = nullptr;
+    thread_local std::uint32_t local_id = 0;
+
+    if ((owner != this) || (local_id != location_id))
+    {
+        std::lock_guard<std::mutex> lock(location_loock);
+        auto &data = locations_[location_id];
+        if (!data)
+        {
+            /* not created by create_location, so the team of the master is assumed */
+            data = std::make_unique<location_data>();
+            data->team = rts_.new_team_member(0);
+        }
+        if (data->rts == nullptr)
+        {
+            if (location_id == 0)
+            {
+                data->rts = &rts_;
+            }
+            else if (per_location_tuning_)
+            {
+                data->worker_rts = rts_.create_worker(data->team);
+                data->rts = data->worker_rts.get();
+            }
+        }
+        owner = this;
+        local = data.get();
+        local_id = location_id;
     }
+    return *local;
 }
 
 /**
@@ -226,7 +322,17 @@ void control_center::thread_fork_join_fork(
 {
     if (paradigm == SCOREP_PARADIGM_OPENMP)
     {
-        count_forks_joins++;
+        auto location_id = scorep::call::location_get_id(location);
+        if ((location_id != 0) && !per_location_tuning_)
+        {
+            return;
+        }
+        auto &local = local_location(location_id);
+        local.fork_depth++;
+        if (per_location_tuning_)
+        {
+            local.rts->fork(location_id);
+        }
     }
 }
 
@@ -246,7 +352,17 @@ void control_center::thread_fork_join_join(
 {
     if (paradigm == SCOREP_PARADIGM_OPENMP)
     {
-        count_forks_joins--;
+        auto location_id = scorep::call::location_get_id(location);
+        if ((location_id != 0) && !per_location_tuning_)
+        {
+            return;
+        }
+        auto &local = local_location(location_id);
+        local.fork_depth--;
+        if (per_location_tuning_)
+        {
+            local.rts->join(location_id);
+        }
     }
 }
 
@@ -265,11 +381,7 @@ void control_center::generic_command(const char *command)
 {
     auto begin = std::chrono::high_resolution_clock::now();
     oa_event_receiver_.parse_command(std::string(command));
-    auto end = std::chrono::high_resolution_clock::now();
-    auto duration = end - begin;
-    invocation_duration[generic_command_i] += duration;
-    invocation_count[generic_command_i]++;
-    invocation_variance_x_2[generic_command_i] += duration.count() * duration.count();
+    statistics_.record(generic_command_i, std::chrono::high_resolution_clock::now() - begin);
 }
 
 /**
@@ -278,7 +390,8 @@ void control_center::generic_command(const char *command)
  * @brief This function registers a region on its first occurrence.
  * It gets the name of the function as well as the Score-P Region ID from the
  * #scorep space.
- * It calls the register_region() function of the @ref tmm::tuning_model_manager class.
+ * It calls the register_region() function of the @ref tmm::tuning_model_manager class through the
+ * @ref rts_handler, which serialises it with the lookups of the workers.
  *
  * @param handle handle to some Score-P definition
  * @param type Identifyer for the handle
@@ -296,17 +409,14 @@ void control_center::register_region(SCOREP_AnyHandle handle, SCOREP_HandleType
 
         logging::trace("CC") << " register region: " << region_name << "(id: " << region_id << ")";
 
-        tmm_->register_region(region_name, line_number, file_name, region_id);
+        rts_.register_region(region_name, line_number, file_name, region_id);
+        filter_.register_region(region_id, region_name);
     }
     if (type == SCOREP_HANDLE_TYPE_SAMPLING_SET)
     {
         mm_->new_sampling_set(handle);
     }
-    auto end = std::chrono::high_resolution_clock::now();
-    auto duration = end - begin;
-    invocation_duration[register_region_i] += duration;
-    invocation_count[register_region_i]++;
-    invocation_variance_x_2[register_region_i] += duration.count() * duration.count();
+    statistics_.record(register_region_i, std::chrono::high_resolution_clock::now() - begin);
 }
 
 /** Handles the creation of locations.
@@ -314,6 +424,9 @@ void control_center::register_region(SCOREP_AnyHandle handle, SCOREP_HandleType
  * The information is supposed to be passed to the PCP's if they need to handle different locationd
  * differently
  *
+ * For per location tuning, the thread team of a new worker location is recorded, which is the
+ * team its parent location has forked last.
+ *
  * The function ensures threadsavety.
  *
  */
@@ -324,15 +437,22 @@ void control_center::create_location(
 
     auto begin = std::chrono::high_resolution_clock::now();
     auto type = scorep::call::location_get_type(location);
+    auto location_id = scorep::call::location_get_id(location);
     if ((type == SCOREP_LOCATION_TYPE_CPU_THREAD) || (type == SCOREP_LOCATION_TYPE_GPU))
     {
-        rts_.create_location(type, scorep::call::location_get_id(location));
+        rts_.create_location(type, location_id);
+    }
+    if (per_location_tuning_ && (parentLocation != nullptr) && (location_id != 0))
+    {
+        /* the worker belongs to the team its parent has forked last */
+        auto &data = locations_[location_id];
+        if (!data)
+        {
+            data = std::make_unique<location_data>();
+            data->team = rts_.new_team_member(scorep::call::location_get_id(parentLocation));
+        }
     }
-    auto end = std::chrono::high_resolution_clock::now();
-    auto duration = end - begin;
-    invocation_duration[create_location_i] += duration;
-    invocation_count[create_location_i]++;
-    invocation_variance_x_2[create_location_i] += duration.count() * duration.count();
+    statistics_.record(create_location_i, std::chrono::high_resolution_clock::now() - begin);
 }
 
 /** Handles the deletion of locations.
@@ -353,15 +473,11 @@ void control_center::delete_location(const struct SCOREP_Location *location)
     {
         rts_.delete_location(type, scorep::call::location_get_id(location));
     }
-    auto end = std::chrono::high_resolution_clock::now();
-    auto duration = end - begin;
-    invocation_duration[delete_location_i] += duration;
-    invocation_count[delete_location_i]++;
-    invocation_variance_x_2[delete_location_i] += duration.count() * duration.count();
+    statistics_.record(delete_location_i, std::chrono::high_resolution_clock::now() - begin);
 }
 
 /** This function recives the parameter events from the Interface, and foward
- * them if the local location is 0.
+ * them if the local location is 0, or if per location tuning is enabled.
  *
  * The prameter handle is translated into a string.
  *
@@ -383,21 +499,18 @@ void control_center::user_parameter(struct SCOREP_Location *location,
                          << " location: " << scorep::call::location_get_id(location)
                          << " value: " << value;
 
-    if (scorep::call::location_get_id(location) == 0)
+    auto location_id = scorep::call::location_get_id(location);
+    if ((location_id == 0) || per_location_tuning_)
     {
         auto begin = std::chrono::high_resolution_clock::now();
-        rts_.user_parameter(
+        local_location(location_id).rts->user_parameter(
             scorep::call::parameter_handle_get_name(parameterHandle), value, location);
-        auto end = std::chrono::high_resolution_clock::now();
-        auto duration = end - begin;
-        invocation_duration[user_parameter_i] += duration;
-        invocation_count[user_parameter_i]++;
-        invocation_variance_x_2[user_parameter_i] += duration.count() * duration.count();
+        statistics_.record(user_parameter_i, std::chrono::high_resolution_clock::now() - begin);
     }
 }
 
 /** This function recives the parameter events from the Interface, and foward
- * them if the local location is 0.
+ * them if the local location is 0, or if per location tuning is enabled.
  *
  * The prameter handle is translated into a string.
  *
@@ -419,21 +532,18 @@ void control_center::user_parameter(struct SCOREP_Location *location,
                          << " location: " << scorep::call::location_get_id(location)
                          << " value: " << value;
 
-    if (scorep::call::location_get_id(location) == 0)
+    auto location_id = scorep::call::location_get_id(location);
+    if ((location_id == 0) || per_location_tuning_)
     {
         auto begin = std::chrono::high_resolution_clock::now();
-        rts_.user_parameter(
+        local_location(location_id).rts->user_parameter(
             scorep::call::parameter_handle_get_name(parameterHandle), value, location);
-        auto end = std::chrono::high_resolution_clock::now();
-        auto duration = end - begin;
-        invocation_duration[user_parameter_i] += duration;
-        invocation_count[user_parameter_i]++;
-        invocation_variance_x_2[user_parameter_i] += duration.count() * duration.count();
+        statistics_.record(user_parameter_i, std::chrono::high_resolution_clock::now() - begin);
     }
 }
 
 /** This function receives the parameter events from the Interface, and forward
- * them if the local location is 0.
+ * them if the local location is 0, or if per location tuning is enabled.
  *
  * The parameter handle is translated into a string.
  *
@@ -456,17 +566,15 @@ void control_center::user_parameter(struct SCOREP_Location *location,
                          << " location: " << scorep::call::location_get_id(location)
                          << " value: " << scorep::call::string_handle_get(string_handle);
 
-    if (scorep::call::location_get_id(location) == 0)
+    auto location_id = scorep::call::location_get_id(location);
+    if ((location_id == 0) || per_location_tuning_)
     {
         auto begin = std::chrono::high_resolution_clock::now();
-        rts_.user_parameter(scorep::call::parameter_handle_get_name(parameterHandle),
+        auto &local = local_location(location_id);
+        local.rts->user_parameter(scorep::call::parameter_handle_get_name(parameterHandle),
             scorep::call::string_handle_get(string_handle),
             location);
-        auto end = std::chrono::high_resolution_clock::now();
-        auto duration = end - begin;
-        invocation_duration[user_parameter_i] += duration;
-        invocation_count[user_parameter_i]++;
-        invocation_variance_x_2[user_parameter_i] += duration.count() * duration.count();
+        statistics_.record(user_parameter_i, std::chrono::high_resolution_clock::now() - begin);
     }
 }
 
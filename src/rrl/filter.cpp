@@ -5,7 +5,6 @@
 #include <algorithm>
 #include <cctype>
 #include <cstring>
-#include <fnmatch.h>
 #include <fstream>
 #include <iostream>
 #include <string>
@@ -23,6 +22,11 @@ namespace rrl
  **/
 filter::filter()
 {
+    for (auto &chunk : region_decisions)
+    {
+        chunk.store(nullptr, std::memory_order_relaxed);
+    }
+
     logging::debug("FILTER") << "Filter initialization";
     file_name = environment::get("FILTERING_FILE", "");
     if (file_name.empty())
@@ -143,11 +147,11 @@ void filter::parseFilterFile(std::vector<std::string> rawData)
         {
             if (excluding_names)
             {
-                excluded_regions.push_back(elem);
+                excluded_regions.add(elem);
             }
             else
             {
-                included_regions.push_back(elem);
+                included_regions.add(elem);
             }
         }
     }
@@ -169,7 +173,7 @@ void filter::parseFilterFile(std::vector<std::string> rawData)
  *
  *
  **/
-bool filter::check_region(std::string region_name)
+bool filter::check_region(const std::string &region_name) const
 {
     if (no_filtering)
 	{
@@ -177,28 +181,57 @@ bool filter::check_region(std::string region_name)
 	}
     if (include_all == true)
     {
-        for (std::string member : excluded_regions)
-        {
-            if (fnmatch(member.c_str(), region_name.c_str(), 0) == 0)
-			{
-                return false;
-			}
-        }
-        return true;
+        return !excluded_regions.match(region_name);
     }
     else
     {
-        for (std::string member : included_regions)
+        return included_regions.match(region_name);
+    }
+}
+
+/**
+ * This function decides once if a region is included or excluded and caches the result.
+ *
+ * @brief This function checks the region name against the filter and stores the result in
+ * region_decisions, so later checks can use cached_decision() instead of matching the name again.
+ * It is called when Score-P registers a region, and as fallback for regions that were not
+ * registered before they are entered. It might be called by different threads at the same time.
+ *
+ * @param region_id Score-P region id
+ * @param region_name name of the region that should be checked
+ *
+ * @return true if the region is included, false otherwise
+ *
+ **/
+bool filter::register_region(std::uint32_t region_id, const std::string &region_name)
+{
+    if (no_filtering)
+    {
+        return true;
+    }
+
+    bool included = check_region(region_name);
+
+    auto index = region_id / decision_chunk_size;
+    if (index < max_decision_chunks)
+    {
+        std::lock_guard<std::mutex> lock(register_lock);
+        auto chunk = region_decisions[index].load(std::memory_order_relaxed);
+        if (chunk == nullptr)
         {
-            if (fnmatch(member.c_str(), region_name.c_str(), 0) == 0)
-            {
-                return true;
-            }
+            decision_chunks.emplace_back(new decision_chunk());
+            chunk = decision_chunks.back().get();
+            region_decisions[index].store(chunk, std::memory_order_release);
         }
-        return false;
+        (*chunk)[region_id % decision_chunk_size].store(
+            included ? decision::include : decision::exclude, std::memory_order_relaxed);
     }
-    return false;
+
+    logging::trace("FILTER") << region_name << "(id: " << region_id << ") is "
+                             << (included ? "included" : "excluded");
+    return included;
 }
+
 /**
  * This helper function is used to remove unnecessary leading and tailing spaces 
  * of entries in the filter file.
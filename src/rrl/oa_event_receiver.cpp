@@ -56,6 +56,8 @@ oa_event_receiver::~oa_event_receiver()
  * V 0.1 calles parse_command_v0_1()
  * V 0.2 calles parse_command_v0_2()
  *
+ * Commands with the genericEventType "tuningModelReload" are passed to parse_reload_command().
+ *
  * @param command json formated oa command
  *
  */
@@ -72,6 +74,11 @@ void oa_event_receiver::parse_command(std::string command)
     {
         command_json = json::parse(command);
 
+        if (command_json["genericEventType"] == "tuningModelReload")
+        {
+            parse_reload_command(command_json);
+            return;
+        }
         if (command_json["genericEventType"] != "tuningRequest")
         {
             // Not a oa tuning command. I don't care about this one.
@@ -310,4 +317,30 @@ void oa_event_receiver::parse_command_v0_2(const json &command_json)
     logging::debug("OA") << "save new tmm";
     tmm_->store_configuration(callpath, tuning_parameters, std::chrono::milliseconds::max());
 }
+
+/** parses a command, that replaces the tuning model
+ *
+ *  The command is expected to have the form:
+ *
+ * {
+ *  "genericEventType":"tuningModelReload",
+ *  "genericEventTypeVersion":0.1,
+ *  "data":
+ *  {
+ *      "TuningModelPath":"\<path of the new tuning model\>"
+ *  }
+ * }
+ *
+ * The new tuning model is read immediately, and replaces the current one at the next enter of a
+ * region, see \ref tmm::tuning_model_manager::reload().
+ *
+ * @param command_json nlohmann::json parsed json version
+ *
+ */
+void oa_event_receiver::parse_reload_command(const json &command_json)
+{
+    auto file_path = command_json["data"]["TuningModelPath"].get<std::string>();
+    logging::debug("OA") << "reload tuning model: " << file_path;
+    tmm_->reload(file_path);
+}
 }
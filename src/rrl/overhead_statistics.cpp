@@ -0,0 +1,243 @@
+#include <rrl/overhead_statistics.hpp>
+#include <util/log.hpp>
+
+#include <json.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+
+namespace rrl
+{
+
+latency_histogram::latency_histogram()
+{
+    buckets_.fill(0);
+}
+
+/** returns the smallest value that is counted in the bucket with the given index
+ */
+std::uint64_t latency_histogram::lowest_value_of(std::size_t index) noexcept
+{
+    if (index < sub_buckets)
+    {
+        return index;
+    }
+    auto shift = index / sub_buckets - 1;
+    auto sub_bucket = index % sub_buckets;
+    return (sub_buckets + sub_bucket) << shift;
+}
+
+/** returns the largest value that is counted in the bucket with the given index
+ */
+std::uint64_t latency_histogram::highest_value_of(std::size_t index) noexcept
+{
+    if (index + 1 >= bucket_count)
+    {
+        return UINT64_MAX;
+    }
+    return lowest_value_of(index + 1) - 1;
+}
+
+/** adds all values recorded in other to this histogram
+ */
+void latency_histogram::merge(const latency_histogram &other) noexcept
+{
+    for (std::size_t i = 0; i < bucket_count; i++)
+    {
+        buckets_[i] += other.buckets_[i];
+    }
+    count_ += other.count_;
+    if (other.max_ > max_)
+    {
+        max_ = other.max_;
+    }
+}
+
+/** Returns the value below which the given percentage of the recorded values lies.
+ *
+ * The returned value is the upper bound of the bucket that holds the requested percentile, but
+ * never more than the largest recorded value.
+ *
+ * @param percent percentile in [0, 100]
+ * @return the percentile, or 0 if no values are recorded
+ */
+std::uint64_t latency_histogram::percentile(double percent) const noexcept
+{
+    if (count_ == 0)
+    {
+        return 0;
+    }
+    auto rank = static_cast<std::uint64_t>(std::ceil(percent / 100.0 * count_));
+    if (rank == 0)
+    {
+        rank = 1;
+    }
+
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < bucket_count; i++)
+    {
+        seen += buckets_[i];
+        if (seen >= rank)
+        {
+            return std::min(highest_value_of(i), max_);
+        }
+    }
+    return max_;
+}
+
+void event_statistics::merge(const event_statistics &other) noexcept
+{
+    count += other.count;
+    duration += other.duration;
+    duration_x_2 += other.duration_x_2;
+    histogram.merge(other.histogram);
+}
+
+/**
+ * @param event_names names of the different event types, used for the report. Events are recorded
+ *      by their index in this vector.
+ */
+/** serial number of the next instance, 0 is never used */
+static std::atomic<std::uint64_t> next_serial(1);
+
+overhead_statistics::overhead_statistics(std::vector<std::string> event_names)
+    : event_names_(std::move(event_names)), serial_(next_serial++)
+{
+}
+
+/** Returns the statistics of the calling thread, and creates them at the first call of a thread.
+ */
+std::vector<event_statistics> &overhead_statistics::local_statistics()
+{
+    thread_local std::uint64_t last_serial = 0;
+    thread_local std::vector<event_statistics> *last = nullptr;
+
+    if (last_serial != serial_)
+    {
+        /* threads that record for several instances keep the statistics of all of them */
+        thread_local std::unordered_map<std::uint64_t, std::vector<event_statistics> *> locals;
+        auto &local = locals[serial_];
+        if (local == nullptr)
+        {
+            std::unique_ptr<std::vector<event_statistics>> statistics(
+                new std::vector<event_statistics>(event_names_.size()));
+            local = statistics.get();
+
+            std::lock_guard<std::mutex> lock(threads_lock_);
+            threads_.push_back(std::move(statistics));
+        }
+        last_serial = serial_;
+        last = local;
+    }
+    return *last;
+}
+
+/** merges the statistics of all threads
+ */
+std::vector<event_statistics> overhead_statistics::merge() const
+{
+    std::vector<event_statistics> result(event_names_.size());
+
+    std::lock_guard<std::mutex> lock(threads_lock_);
+    for (const auto &thread : threads_)
+    {
+        for (std::size_t i = 0; i < result.size(); i++)
+        {
+            result[i].merge((*thread)[i]);
+        }
+    }
+    return result;
+}
+
+/** Prints the merged statistics for all event types that occurred, using debug log messages.
+ */
+void overhead_statistics::print() const
+{
+    auto statistics = merge();
+
+    logging::debug("CC") << "Estimated Runtime of RRL for different events:";
+    for (std::size_t i = 0; i < statistics.size(); i++)
+    {
+        const auto &event = statistics[i];
+        if (event.count == 0)
+        {
+            continue;
+        }
+
+        auto duration_s = std::chrono::duration<double>(event.duration).count();
+        double mean_ns = static_cast<double>(event.duration.count()) / event.count;
+        double variance_ns_2 = 0;
+        if (event.count > 1)
+        {
+            variance_ns_2 =
+                (event.duration_x_2 - event.count * mean_ns * mean_ns) / (event.count - 1);
+        }
+
+        logging::debug("CC") << event_names_[i] << "\n"
+                             << "\tcount: " << event.count << "\n"
+                             << "\ttotal duration: " << duration_s << "s \n"
+                             << "\taverage duration: " << mean_ns * 1e-9 << "s \n"
+                             << "\t(duration deviation)^2: " << variance_ns_2 * 1e-18 << "s*s \n"
+                             << "\tp50: " << event.histogram.percentile(50) << "ns \n"
+                             << "\tp90: " << event.histogram.percentile(90) << "ns \n"
+                             << "\tp99: " << event.histogram.percentile(99) << "ns \n"
+                             << "\tp99.9: " << event.histogram.percentile(99.9) << "ns \n"
+                             << "\tmax: " << event.histogram.max() << "ns";
+    }
+}
+
+/** Writes the merged statistics, including all non empty histogram buckets, to a JSON file.
+ *
+ * @param file_name file to write
+ */
+void overhead_statistics::write_json(const std::string &file_name) const
+{
+    auto statistics = merge();
+
+    nlohmann::json result;
+    for (std::size_t i = 0; i < statistics.size(); i++)
+    {
+        const auto &event = statistics[i];
+        if (event.count == 0)
+        {
+            continue;
+        }
+
+        nlohmann::json buckets = nlohmann::json::array();
+        for (std::size_t b = 0; b < latency_histogram::bucket_count; b++)
+        {
+            auto count = event.histogram.bucket(b);
+            if (count != 0)
+            {
+                buckets.push_back({latency_histogram::lowest_value_of(b),
+                    latency_histogram::highest_value_of(b),
+                    count});
+            }
+        }
+
+        auto &entry = result[event_names_[i]];
+        entry["count"] = event.count;
+        entry["total_duration_ns"] = event.duration.count();
+        entry["sum_of_squares_ns_2"] = event.duration_x_2;
+        entry["p50_ns"] = event.histogram.percentile(50);
+        entry["p90_ns"] = event.histogram.percentile(90);
+        entry["p99_ns"] = event.histogram.percentile(99);
+        entry["p99.9_ns"] = event.histogram.percentile(99.9);
+        entry["max_ns"] = event.histogram.max();
+        entry["buckets"] = buckets;
+    }
+
+    std::ofstream file(file_name, std::ios_base::out);
+    if (!file.is_open())
+    {
+        logging::error("CC") << "can't open overhead statistics file: " << file_name;
+        logging::error("CC") << "reason: " << strerror(errno);
+        return;
+    }
+    file << result.dump(4) << std::endl;
+}
+}
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <cstdlib>
 #include <cstring>
 #include <fstream>
@@ -17,6 +18,22 @@
 //
 namespace rrl
 {
+/** Returns the shortest of three calls of a plugin setter. The parameter is set to its current
+ * value, so the measurement does not change the configuration.
+ */
+static std::chrono::nanoseconds time_setter(int (*set)(int), int value)
+{
+    auto shortest = std::chrono::nanoseconds::max();
+    for (int n = 0; n < 3; n++)
+    {
+        auto begin = std::chrono::high_resolution_clock::now();
+        set(value);
+        shortest = std::min<std::chrono::nanoseconds>(
+            shortest, std::chrono::high_resolution_clock::now() - begin);
+    }
+    return shortest;
+}
+
 /**
  * Constructor
  *
@@ -27,8 +44,12 @@ namespace rrl
  * Saves all the application tuning parameters specified by the user.
  *
  **/
-parameter_controller::parameter_controller()
+parameter_controller::parameter_controller() : tp_mask_(0), skipped_configurations_(0)
 {
+    parameter_set_functions_.fill(nullptr);
+    parameter_unset_functions_.fill(nullptr);
+    parameter_actions_.fill(0);
+
     auto pcp_list = environment::get("PLUGINS", "", true);
     auto pcp_sep = environment::get("PLUGINS_SEP", ",", true);
 
@@ -54,8 +75,6 @@ parameter_controller::parameter_controller()
     }
     logging::info() << "amount of loaded plugins: " << pcps.size();
 
-    std::vector<tmm::parameter_tuple> default_settings;
-
     for (auto &&pcp : pcps)
     {
         logging::debug("PC") << "got pcp: " << pcp.first;
@@ -64,27 +83,71 @@ parameter_controller::parameter_controller()
          * save the set and the unset functions
          */
 
-        for (auto &parameter : pcp.second.pcp_action_info)
+        batch_plugin batch{&pcp.second, 0};
+        for (std::uint32_t action = 0; action < pcp.second.pcp_action_info.size(); action++)
         {
+            auto &parameter = pcp.second.pcp_action_info[action];
             logging::debug("PC") << "load parameter:" << parameter.name << " name hash is ("
                                  << parameter_name_hash(parameter.name) << ")";
 
-            parameter_set_functions_[parameter_name_hash(parameter.name)] =
-                parameter.enter_region_set_config;
-            parameter_unset_functions_[parameter_name_hash(parameter.name)] =
-                parameter.exit_region_set_config;
-            parameter_get_current_configs_[parameter_name_hash(parameter.name)] =
-                parameter.current_config;
+            auto slot = slots_.add(parameter_name_hash(parameter.name));
+            if (slot == cm::parameter_slots::npos)
+            {
+                continue;
+            }
+            parameter_set_functions_[slot] = parameter.enter_region_set_config;
+            parameter_unset_functions_[slot] = parameter.exit_region_set_config;
+            parameter_actions_[slot] = action;
+            tp_mask_ |= std::uint64_t(1) << slot;
+            batch.mask |= std::uint64_t(1) << slot;
 
-            tmm::parameter_tuple default_setting(
-                parameter_name_hash(parameter.name), parameter.current_config());
+            auto default_value = parameter.current_config();
             logging::debug("PC") << "default_setting of " << parameter.name << " is "
-                                 << default_setting.parameter_value;
-            default_settings.push_back(default_setting);
+                                 << default_value;
+            default_settings_.set(slot, default_value);
+        }
+        if (pcp.second.has_batched_set() && batch.mask != 0)
+        {
+            logging::debug("PC") << "pcp " << pcp.first << " sets several parameters with one call";
+            batch_plugins_.push_back(batch);
         }
     }
-    cm = cm::create_new_instance(
-        default_settings, environment::get("CHECK_IF_RESET", "reset", true));
+    cm_type_ = environment::get("CHECK_IF_RESET", "reset", true);
+    cm = cm::create_new_instance(default_settings_, cm_type_);
+
+    auto cost_factor = std::stod(environment::get("SWITCH_COST_FACTOR", "0"));
+    if (cost_factor > 0)
+    {
+        cost_model_.reset(new switch_cost_model(cost_factor));
+        cm::for_each_slot(tp_mask_, [this](std::size_t slot) {
+            auto latency =
+                time_setter(parameter_set_functions_[slot], default_settings_.values[slot]);
+            cost_model_->add_parameter(slot, latency);
+            logging::debug("PC") << "switching latency of parameter " << slots_.id(slot) << ": "
+                                 << latency.count() << "ns";
+        });
+    }
+
+    auto async_switch = environment::get("ASYNC_SWITCH", "false");
+    std::transform(async_switch.begin(), async_switch.end(), async_switch.begin(), ::tolower);
+    if (async_switch == "true")
+    {
+        auto delay =
+            std::chrono::microseconds(std::stoi(environment::get("ASYNC_SWITCH_DELAY_US", "0")));
+        switcher_.reset(new parameter_switcher(slots_.to_tuples(default_settings_),
+            [this](tmm::parameter_tuple config, bool unset) {
+                auto slot = slots_.find(config.parameter_id);
+                if (unset)
+                {
+                    unset_config(slot, config.parameter_value);
+                }
+                else
+                {
+                    set_config(slot, config.parameter_value);
+                }
+            },
+            delay));
+    }
 
     logging::debug() << "[PC] parameter_controller initalized";
 }
@@ -99,128 +162,282 @@ parameter_controller::parameter_controller()
 parameter_controller::~parameter_controller()
 {
     logging::debug("PC") << "parameter_controller finalize";
+    if (cost_model_)
+    {
+        logging::debug("PC") << "configurations skipped as the region is too short for the switch: "
+                             << skipped_configurations_.load();
+    }
+    if (switcher_)
+    {
+        switcher_->flush();
+        auto statistics = switcher_->statistics();
+        auto applied = statistics.requests - statistics.coalesced;
+        logging::debug("PC") << "asynchronous parameter switches\n"
+                             << "\trequests: " << statistics.requests << "\n"
+                             << "\tapplied: " << applied << "\n"
+                             << "\tcoalesced: " << statistics.coalesced << "\n"
+                             << "\ttime in plugins, not waited for by the application: "
+                             << std::chrono::duration<double>(statistics.duration.duration).count()
+                             << "s\n"
+                             << "\tswitch duration p50: "
+                             << statistics.duration.histogram.percentile(50) << "ns\n"
+                             << "\tswitch duration p99: "
+                             << statistics.duration.histogram.percentile(99) << "ns\n"
+                             << "\tlatency from request to switch p50: "
+                             << statistics.latency.histogram.percentile(50) << "ns\n"
+                             << "\tlatency from request to switch p99: "
+                             << statistics.latency.histogram.percentile(99) << "ns";
+        switcher_.reset();
+    }
 }
 
 /**sets TPs
  *
- * If the TP hash is not there a debug message is printed.
- * If the TP exists and it will be replaced with the new value.
- * Basically calls enter_region_set_config from the plugin.
+ * Basically calls enter_region_set_config from the plugin of the parameter in the given slot.
  *
  */
-void parameter_controller::set_config(tmm::parameter_tuple config)
+void parameter_controller::set_config(std::size_t slot, int value)
 {
-    auto function = parameter_set_functions_.find(config.parameter_id);
-    if (function != parameter_set_functions_.end())
+    auto function = parameter_set_functions_[slot];
+    auto begin = std::chrono::high_resolution_clock::now();
+    int rt;
+    rt = function(value);
+    if (cost_model_)
     {
-        int rt;
-        rt = function->second(config.parameter_value);
-        if (rt < 0)
-            {
-                logging::error("PC") << "set_parameter failed for pcp " << config.parameter_id;
-                logging::error("PC") << "error code: " << rt << std::strerror(abs(rt));
-            }
+        cost_model_->record(slot, std::chrono::high_resolution_clock::now() - begin);
     }
-    else
+    if (rt < 0)
     {
-        logging::trace("PC") << "pcp for parameter " << config.parameter_id
-                             << " not found maybe its an ATP";
+        logging::error("PC") << "set_parameter failed for pcp " << slots_.id(slot);
+        logging::error("PC") << "error code: " << rt << std::strerror(abs(rt));
     }
 }
 
 /**unsets TPs
  *
- * If the TP hash is not there a debug message is printed.
- * If the TP exists it will be replaced with the new value.
- * Basically calls exit_region_set_config from the plugin.
+ * Basically calls exit_region_set_config from the plugin of the parameter in the given slot.
  *
  */
-void parameter_controller::unset_config(tmm::parameter_tuple config)
+void parameter_controller::unset_config(std::size_t slot, int value)
 {
-    auto function = parameter_unset_functions_.find(config.parameter_id);
-    if (function != parameter_unset_functions_.end())
+    auto function = parameter_unset_functions_[slot];
+    auto begin = std::chrono::high_resolution_clock::now();
+    int rt;
+    rt = function(value);
+    if (cost_model_)
     {
-        int rt;
-        rt = function->second(config.parameter_value);
-        if (rt < 0)
-            {
-                logging::warn("PC") << "unset_parameter failed for pcp " << config.parameter_id; 
-                logging::error("PC") << "error code: " << rt << std::strerror(abs(rt));
-            }
-
+        cost_model_->record(slot, std::chrono::high_resolution_clock::now() - begin);
     }
-    else
+    if (rt < 0)
     {
-        logging::debug("PC") << "pcp for parameter " << config.parameter_id
-                             << " not found maybe its an ATP";
+        logging::warn("PC") << "unset_parameter failed for pcp " << slots_.id(slot);
+        logging::error("PC") << "error code: " << rt << std::strerror(abs(rt));
     }
 }
 
-/**sets new parameters
- *
- * new_configs delivers new TP and ATPs. ATPs will be set by calling the configuration
- * manager. New TPs will be set by calling the set_config function.
+/** Sets or unsets the TPs of the changed slots to their values in configs.
  *
- * @param new_configs vector of parameter tuples where each one consists of the parameter's id and
- * name.
+ * The TPs of plugins which implement the batched interface are set with one call per plugin, the
+ * others with \ref set_config or \ref unset_config. The latency of a batched call is shared
+ * equally by its TPs in the switch cost model.
  *
+ * @param changed slots of the TPs to set
+ * @param configs holds the new values
+ * @param unset true if the TPs are restored at the exit of a region
  */
-void parameter_controller::set_parameters(setting new_configs)
+void parameter_controller::apply_configs(
+    std::uint64_t changed, const cm::slot_setting &configs, bool unset)
 {
-    mtx.lock();
-    auto current_settings = cm->get_current_config();
-
-    for (auto new_config : new_configs)
+    for (const auto &plugin : batch_plugins_)
     {
-        // check if value is already set in current settings
-        auto old_config = std::find_if(current_settings.begin(),
-            current_settings.end(),
-            [new_config](tmm::parameter_tuple value) {
-                return value.parameter_id == new_config.parameter_id;
-            });
-        if ((old_config == current_settings.end()) ||
-            (old_config->parameter_value != new_config.parameter_value))
+        auto slots = changed & plugin.mask;
+        if (slots == 0)
+        {
+            continue;
+        }
+        changed &= ~slots;
+
+        std::array<std::uint32_t, cm::max_slots> actions;
+        std::array<int, cm::max_slots> values;
+        std::uint32_t count = 0;
+        cm::for_each_slot(slots, [this, &configs, &actions, &values, &count](std::size_t slot) {
+            actions[count] = parameter_actions_[slot];
+            values[count] = configs.values[slot];
+            count++;
+        });
+
+        auto begin = std::chrono::high_resolution_clock::now();
+        int rt = plugin.pcp->set_configs(count, actions.data(), values.data(), unset);
+        if (cost_model_)
+        {
+            auto latency = (std::chrono::high_resolution_clock::now() - begin) / count;
+            cm::for_each_slot(
+                slots, [this, latency](std::size_t slot) { cost_model_->record(slot, latency); });
+        }
+        if (rt < 0)
         {
-            set_config(new_config);
+            logging::error("PC") << "setting " << count << " parameters with one call failed";
+            logging::error("PC") << "error code: " << rt << std::strerror(abs(rt));
         }
     }
 
-    cm->set(new_configs);
-    mtx.unlock();
+    cm::for_each_slot(changed, [this, &configs, unset](std::size_t slot) {
+        if (unset)
+        {
+            unset_config(slot, configs.values[slot]);
+        }
+        else
+        {
+            set_config(slot, configs.values[slot]);
+        }
+    });
+}
+
+/**sets new parameters
+ *
+ * new_configs delivers new TP and ATPs. ATPs will be set by calling the configuration
+ * manager. New TPs will be set by calling the set_config function, or are passed to the
+ * parameter switcher, which calls set_config from its own thread.
+ *
+ * @param new_configs configuration by the slots of the parameters, see \ref to_slots
+ * @param duration expected duration of the region, the TPs are not switched if switching them
+ * does not pay off
+ * @return true if a configuration was pushed on the settings stack, which has to be unset
+ *
+ */
+bool parameter_controller::set_parameters(
+    const cm::slot_setting &new_configs, std::chrono::milliseconds duration)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    return set_parameters(new_configs, *cm, duration, switcher_.get());
 }
 
 /**unsets current parameters
  *
  * unsets current parameters and sets old parameters from settings stack.
  * This is done by calling the configuration manager.
- * For unsetting the TPs the unset_config function is called.
+ * For unsetting the TPs the unset_config function is called, by the parameter switcher if there
+ * is one.
  *
  */
 void parameter_controller::unset_parameters()
 {
-    mtx.lock();
-    auto current_settings = cm->get_current_config();
-    auto new_configs = cm->unset();
-    logging::trace("PC") << "unset_parameters\n"
-                         << "current_setting:\n"
-                         << current_settings << "new_settins:\n"
-                         << new_configs;
-
-    for (auto &new_config : new_configs)
+    std::lock_guard<std::mutex> lock(mtx);
+    unset_parameters(*cm, switcher_.get());
+}
+
+/**sets new parameters using the given settings stack instead of the process wide one.
+ *
+ * The stack is not locked, so it must not be used by different threads at the same time. The TPs
+ * are set from the calling thread, so this is not used together with the parameter switcher, see
+ * \ref control_center.
+ *
+ * @param new_configs configuration by the slots of the parameters, see \ref to_slots
+ * @param stack settings stack, see \ref create_configuration_stack
+ * @param duration expected duration of the region, the TPs are not switched if switching them
+ * does not pay off
+ * @return true if a configuration was pushed on the settings stack, which has to be unset
+ *
+ */
+bool parameter_controller::set_parameters(
+    const cm::slot_setting &new_configs, cm::cm_base &stack, std::chrono::milliseconds duration)
+{
+    return set_parameters(new_configs, stack, duration, nullptr);
+}
+
+/**unsets current parameters using the given settings stack instead of the process wide one.
+ *
+ * The stack is not locked, so it must not be used by different threads at the same time. The TPs
+ * are unset from the calling thread.
+ *
+ * @param stack settings stack, see \ref create_configuration_stack
+ *
+ */
+void parameter_controller::unset_parameters(cm::cm_base &stack)
+{
+    unset_parameters(stack, nullptr);
+}
+
+/** Sets the TPs of configs that differ from the current configuration of stack, and pushes configs
+ * on the stack. If switching the TPs does not pay off according to the switch cost model, the TPs
+ * keep their values, and only the ATPs are pushed.
+ *
+ * @param switcher applies the TPs if it is not nullptr, otherwise they are set from the calling
+ * thread
+ * @return true if a configuration was pushed on the stack
+ */
+bool parameter_controller::set_parameters(const cm::slot_setting &configs,
+    cm::cm_base &stack,
+    std::chrono::milliseconds duration,
+    parameter_switcher *switcher)
+{
+    auto changed = cm::slot_setting::changes(stack.current(), configs) & tp_mask_;
+    if (cost_model_ && !cost_model_->pays_off(changed, duration))
     {
-        // check if value is already set in current settings
-        auto old_config = std::find_if(current_settings.begin(),
-            current_settings.end(),
-            [new_config](tmm::parameter_tuple value) {
-                return value.parameter_id == new_config.parameter_id;
-            });
-        if ((old_config == current_settings.end()) ||
-            old_config->parameter_value != new_config.parameter_value)
+        skipped_configurations_++;
+        RRL_TRACE("PC") << "switching the parameters does not pay off for a region of "
+                        << duration.count() << "ms";
+        auto atps = configs;
+        atps.mask &= ~tp_mask_;
+        if (atps.mask == 0)
         {
-            unset_config(new_config);
+            return false;
         }
+        stack.set(atps);
+        return true;
+    }
+
+    if (switcher != nullptr)
+    {
+        cm::for_each_slot(changed, [this, &configs, switcher](std::size_t slot) {
+            switcher->request(tmm::parameter_tuple(slots_.id(slot), configs.values[slot]), false);
+        });
+        switcher->submit();
+    }
+    else
+    {
+        apply_configs(changed, configs, false);
     }
-    mtx.unlock();
+    stack.set(configs);
+    return true;
+}
+
+/** Removes the last configuration from stack, and restores the TPs whose value changes.
+ *
+ * @param switcher applies the TPs if it is not nullptr, otherwise they are unset from the calling
+ * thread
+ */
+void parameter_controller::unset_parameters(cm::cm_base &stack, parameter_switcher *switcher)
+{
+    auto changed = stack.unset() & tp_mask_;
+    const auto &current = stack.current();
+    RRL_TRACE("PC") << "unset_parameters\n"
+                    << "new_settings:\n"
+                    << slots_.to_tuples(current);
+
+    if (switcher != nullptr)
+    {
+        cm::for_each_slot(changed, [this, &current, switcher](std::size_t slot) {
+            switcher->request(tmm::parameter_tuple(slots_.id(slot), current.values[slot]), true);
+        });
+        switcher->submit();
+    }
+    else
+    {
+        apply_configs(changed, current, true);
+    }
+}
+
+/**Creates a new settings stack, which starts with the default values of all parameters.
+ *
+ * This is used for locations that maintain their own configurations, like OpenMP worker threads.
+ *
+ * @return a new, independent settings stack of the same type as the process wide one
+ *
+ */
+std::unique_ptr<cm::cm_base> parameter_controller::create_configuration_stack() const
+{
+    return cm::create_new_instance(default_settings_, cm_type_);
 }
 
 /** passes the information about a new location to the pcp
@@ -284,7 +501,7 @@ void parameter_controller::delete_location(
  */
 cm::setting parameter_controller::get_current_setting() const
 {
-    return cm->get_current_config();
+    return slots_.to_tuples(cm->current());
 }
 
 /**Returns a const reference to the list of PCP's
@@ -315,31 +532,21 @@ const std::map<std::string, pcp_handler> &parameter_controller::get_pcps() const
 void parameter_controller::rrl_atp_param_declare(
     const std::string &parameter_name, int32_t default_value, const std::string &domain)
 {
-    mtx.lock();
-    logging::trace("PC") << " declaring application tuning parameter " << parameter_name
-                         << " with domain name = " << domain;
-
-    auto parameter_hash = parameter_name_hash(parameter_name);
-    setting current_configs = cm->get_current_config();
-    auto current_config = std::find_if(current_configs.begin(),
-        current_configs.end(),
-        [parameter_hash](
-            tmm::parameter_tuple param) { return param.parameter_id == parameter_hash; });
-    int32_t parameter_value;
-    if (current_config != current_configs.end())
-    {
-        parameter_value = current_config->parameter_value;
-    }
-    else
+    std::lock_guard<std::mutex> lock(mtx);
+    RRL_TRACE("PC") << " declaring application tuning parameter " << parameter_name
+                    << " with domain name = " << domain;
+
+    auto slot = slots_.add(parameter_name_hash(parameter_name));
+    if (slot == cm::parameter_slots::npos)
     {
-        parameter_value = default_value;
+        return;
     }
-    tmm::parameter_tuple atp(parameter_hash, parameter_value);
-    cm->atp_add(atp);
-    logging::trace("PC") << " application tuning parameter " << parameter_name
-                         << " with domain name = " << domain << "added to configuration manager";
-
-    mtx.unlock();
+    const auto &current_configs = cm->current();
+    int32_t parameter_value =
+        current_configs.has(slot) ? current_configs.values[slot] : default_value;
+    cm->atp_add(slot, parameter_value);
+    RRL_TRACE("PC") << " application tuning parameter " << parameter_name
+                    << " with domain name = " << domain << "added to configuration manager";
 }
 
 /** Gets the application tuning parameter (ATP) value with the name
@@ -361,35 +568,26 @@ void parameter_controller::rrl_atp_param_get(
     int32_t &ret_value,
     const std::string &domain)
 {
-    mtx.lock();
-
-    logging::trace("PC") << " getting application tuning parameter " << parameter_name
-                         << " with domain name = " << domain;
+    std::lock_guard<std::mutex> lock(mtx);
 
-    auto parameter_hash = parameter_name_hash(parameter_name);
-    setting current_configs = cm->get_current_config();
+    RRL_TRACE("PC") << " getting application tuning parameter " << parameter_name
+                    << " with domain name = " << domain;
 
-    auto current_config = std::find_if(current_configs.begin(),
-        current_configs.end(),
-        [parameter_hash](
-            tmm::parameter_tuple param) { return param.parameter_id == parameter_hash; });
+    auto slot = slots_.find(parameter_name_hash(parameter_name));
+    const auto &current_configs = cm->current();
 
-    if (current_config == current_configs.end())
+    if (slot == cm::parameter_slots::npos || !current_configs.has(slot))
     {
         //        rrl_atp_param_declare(parameter_name, default_value, domain);
-        logging::trace("PC") << " No configuration found for application tuning parameter "
-                             << parameter_name;
+        RRL_TRACE("PC") << " No configuration found for application tuning parameter "
+                        << parameter_name;
         ret_value = default_value;
-        logging::trace("PC") << "Default value returned for application parameter "
-                             << parameter_name << "=" << ret_value;
+        RRL_TRACE("PC") << "Default value returned for application parameter "
+                        << parameter_name << "=" << ret_value;
         return;
     }
-    logging::trace("PC") << " got configuration for application tuning parameter " << parameter_name
-                         << " = " << current_config->parameter_value;
-    ret_value = current_config->parameter_value;
-    logging::trace("PC") << "Value returned for application parameter " << parameter_name << "="
-                         << ret_value;
-
-    mtx.unlock();
+    ret_value = current_configs.values[slot];
+    RRL_TRACE("PC") << "Value returned for application parameter " << parameter_name << "="
+                    << ret_value;
 }
 }
@@ -0,0 +1,161 @@
+#include <rrl/parameter_switcher.hpp>
+
+#include <util/log.hpp>
+
+namespace rrl
+{
+parameter_switcher::parameter_switcher(const std::vector<tmm::parameter_tuple> &initial_settings,
+    apply_function apply,
+    std::chrono::microseconds delay,
+    std::size_t capacity)
+    : apply_(std::move(apply)),
+      delay_(delay),
+      queue_(capacity),
+      submitted_(0),
+      processed_(0),
+      waiting_(false),
+      stop_(false)
+{
+    for (const auto &config : initial_settings)
+    {
+        applied_[config.parameter_id] = config.parameter_value;
+    }
+    thread_ = std::thread(&parameter_switcher::run, this);
+    logging::debug("PS") << "parameter switcher started, coalescing delay: " << delay_.count()
+                         << "us";
+}
+
+parameter_switcher::~parameter_switcher()
+{
+    submit();
+    {
+        std::lock_guard<std::mutex> lock(wait_lock_);
+        stop_ = true;
+    }
+    wake_up_.notify_one();
+    thread_.join();
+}
+
+/** Stages a request. If the queue is full, the staged requests are submitted, and the calling
+ * thread waits until the switcher thread made room.
+ *
+ * @param config parameter and its new value
+ * @param unset true if the parameter is restored at the exit of a region
+ */
+void parameter_switcher::request(tmm::parameter_tuple config, bool unset)
+{
+    switch_request r(config, unset, std::chrono::high_resolution_clock::now());
+    while (!queue_.try_stage(r))
+    {
+        submit();
+        std::this_thread::yield();
+    }
+    submitted_++;
+}
+
+/** Publishes the staged requests, and wakes the switcher thread if it sleeps.
+ *
+ * The fence pairs with the one in \ref wait_for_requests: either this thread sees that the
+ * switcher thread is waiting, or the switcher thread sees the published requests.
+ */
+void parameter_switcher::submit()
+{
+    queue_.publish();
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiting_.load(std::memory_order_relaxed))
+    {
+        std::lock_guard<std::mutex> lock(wait_lock_);
+        wake_up_.notify_one();
+    }
+}
+
+void parameter_switcher::flush()
+{
+    submit();
+    while (processed_.load(std::memory_order_acquire) != submitted_)
+    {
+        std::this_thread::yield();
+    }
+}
+
+switch_statistics parameter_switcher::statistics() const
+{
+    std::lock_guard<std::mutex> lock(statistics_lock_);
+    return statistics_;
+}
+
+/** main loop of the switcher thread, pending requests are applied before the thread stops
+ */
+void parameter_switcher::run()
+{
+    while (true)
+    {
+        wait_for_requests();
+        if (delay_.count() > 0)
+        {
+            /* further requests do not wake the thread, only the destructor does */
+            std::unique_lock<std::mutex> lock(wait_lock_);
+            wake_up_.wait_for(lock, delay_, [this]() { return stop_; });
+        }
+        apply_pending();
+
+        std::lock_guard<std::mutex> lock(wait_lock_);
+        if (stop_ && queue_.empty())
+        {
+            return;
+        }
+    }
+}
+
+void parameter_switcher::wait_for_requests()
+{
+    std::unique_lock<std::mutex> lock(wait_lock_);
+    waiting_.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    wake_up_.wait(lock, [this]() { return stop_ || !queue_.empty(); });
+    waiting_.store(false, std::memory_order_relaxed);
+}
+
+/** Drains the queue, and applies the last request of every parameter, if it changes the value of
+ * the parameter. All other drained requests are counted as coalesced.
+ */
+void parameter_switcher::apply_pending()
+{
+    std::uint64_t drained = 0;
+    switch_request r;
+    while (queue_.try_pop(r))
+    {
+        pending_[r.config.parameter_id] = r;
+        drained++;
+    }
+
+    std::uint64_t applied = 0;
+    for (const auto &pending : pending_)
+    {
+        const auto &last = pending.second;
+        auto current = applied_.find(pending.first);
+        if (current != applied_.end() && current->second == last.config.parameter_value)
+        {
+            continue;
+        }
+
+        auto begin = std::chrono::high_resolution_clock::now();
+        apply_(last.config, last.unset);
+        auto end = std::chrono::high_resolution_clock::now();
+        applied_[pending.first] = last.config.parameter_value;
+        applied++;
+
+        std::lock_guard<std::mutex> lock(statistics_lock_);
+        statistics_.latency.record(end - last.requested);
+        statistics_.duration.record(end - begin);
+    }
+    pending_.clear();
+
+    {
+        std::lock_guard<std::mutex> lock(statistics_lock_);
+        statistics_.requests += drained;
+        statistics_.coalesced += drained - applied;
+    }
+    processed_.fetch_add(drained, std::memory_order_release);
+}
+} // namespace rrl
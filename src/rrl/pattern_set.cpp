@@ -0,0 +1,129 @@
+#include <rrl/pattern_set.hpp>
+
+#include <fnmatch.h>
+
+namespace rrl
+{
+
+/** returns true if c has a special meaning in a fnmatch() pattern
+ */
+static inline bool is_special(char c)
+{
+    return c == '*' || c == '?' || c == '[' || c == '\\';
+}
+
+pattern_set::trie::trie() : nodes_(1)
+{
+}
+
+template <typename Iterator> void pattern_set::trie::insert(Iterator begin, Iterator end)
+{
+    std::uint32_t current = 0;
+    for (auto it = begin; it != end; ++it)
+    {
+        auto child = nodes_[current].children.find(*it);
+        if (child != nodes_[current].children.end())
+        {
+            current = child->second;
+        }
+        else
+        {
+            auto next = static_cast<std::uint32_t>(nodes_.size());
+            nodes_[current].children.emplace(*it, next);
+            nodes_.emplace_back();
+            current = next;
+        }
+    }
+    nodes_[current].terminal = true;
+}
+
+template <typename Iterator>
+bool pattern_set::trie::match_prefix(Iterator begin, Iterator end) const
+{
+    std::uint32_t current = 0;
+    if (nodes_[current].terminal)
+    {
+        return true;
+    }
+    for (auto it = begin; it != end; ++it)
+    {
+        auto child = nodes_[current].children.find(*it);
+        if (child == nodes_[current].children.end())
+        {
+            return false;
+        }
+        current = child->second;
+        if (nodes_[current].terminal)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/** Adds a pattern to the set.
+ *
+ * The pattern is stored in the cheapest structure that can match it, see \ref pattern_set.
+ *
+ * @param pattern shell wildcard pattern or plain region name
+ */
+void pattern_set::add(const std::string &pattern)
+{
+    size_++;
+
+    std::size_t specials = 0;
+    for (auto c : pattern)
+    {
+        if (is_special(c))
+        {
+            specials++;
+        }
+    }
+
+    if (specials == 0)
+    {
+        exact_.insert(pattern);
+    }
+    else if (specials == 1 && pattern.back() == '*')
+    {
+        prefixes_.insert(pattern.begin(), pattern.end() - 1);
+    }
+    else if (specials == 1 && pattern.front() == '*')
+    {
+        suffixes_.insert(pattern.rbegin(), pattern.rend() - 1);
+    }
+    else
+    {
+        globs_.push_back(pattern);
+    }
+}
+
+/** Checks if name matches any of the patterns in this set.
+ *
+ * @param name name to check
+ * @return true if at least one pattern matches
+ */
+bool pattern_set::match(const std::string &name) const
+{
+    if (!exact_.empty() && exact_.find(name) != exact_.end())
+    {
+        return true;
+    }
+    if (!prefixes_.empty() && prefixes_.match_prefix(name.begin(), name.end()))
+    {
+        return true;
+    }
+    if (!suffixes_.empty() && suffixes_.match_prefix(name.rbegin(), name.rend()))
+    {
+        return true;
+    }
+    for (const auto &glob : globs_)
+    {
+        if (fnmatch(glob.c_str(), name.c_str(), 0) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+}
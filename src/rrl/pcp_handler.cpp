@@ -177,6 +177,24 @@ void pcp_handler::delete_location(RRL_LocationType location_type, uint32_t locat
     this->pcp_info_.delete_location(location_type, location_id);
 }
 
+/** sets several tuning actions with one call of the plugin, see \ref has_batched_set
+ *
+ * @param count number of tuning actions
+ * @param actions indices of the tuning actions in \ref pcp_action_info
+ * @param values new values of the tuning actions
+ * @param exit true if the values are restored at an exit region event
+ *
+ * @return the return value of the plugin, negative on errors
+ */
+int pcp_handler::set_configs(uint32_t count, const uint32_t *actions, const int *values, bool exit)
+{
+    if (exit)
+    {
+        return this->pcp_info_.exit_region_set_configs(count, actions, values);
+    }
+    return this->pcp_info_.enter_region_set_configs(count, actions, values);
+}
+
 /** move constructor
  *
  *  ensures that the ownership of dlfcn_handle_ stays consistent
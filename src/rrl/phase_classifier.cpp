@@ -0,0 +1,214 @@
+#include <rrl/phase_classifier.hpp>
+#include <util/log.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <set>
+
+namespace rrl
+{
+constexpr int phase_classifier::no_cluster;
+
+phase_classifier::phase_classifier(const std::unordered_map<int, tmm::phase_data_t> &clusters)
+{
+    std::set<std::string> names;
+    for (const auto &cluster : clusters)
+    {
+        cluster_ids_.push_back(cluster.first);
+        for (const auto &range : cluster.second.second)
+            names.insert(range.first);
+    }
+    std::sort(cluster_ids_.begin(), cluster_ids_.end());
+    words_ = (cluster_ids_.size() + 63) / 64;
+    feature_names_.assign(names.begin(), names.end());
+
+    for (const auto &name : feature_names_)
+    {
+        feature_index feature;
+        feature.constrained.assign(words_, 0);
+
+        /* range of each cluster for this feature, nullptr if it has none */
+        std::vector<const std::pair<double, double> *> ranges;
+        for (std::size_t c = 0; c < cluster_ids_.size(); c++)
+        {
+            const auto &cluster_ranges = clusters.at(cluster_ids_[c]).second;
+            auto range = cluster_ranges.find(name);
+            if (range == cluster_ranges.end())
+            {
+                ranges.push_back(nullptr);
+                continue;
+            }
+            ranges.push_back(&range->second);
+            feature.constrained[c / 64] |= std::uint64_t(1) << (c % 64);
+            feature.bounds.push_back(range->second.first);
+            feature.bounds.push_back(range->second.second);
+        }
+        std::sort(feature.bounds.begin(), feature.bounds.end());
+        feature.bounds.erase(
+            std::unique(feature.bounds.begin(), feature.bounds.end()), feature.bounds.end());
+
+        auto n = feature.bounds.size();
+        feature.intervals.assign(2 * n + 1, mask(words_, 0));
+        for (std::size_t i = 0; i < feature.intervals.size(); i++)
+        {
+            /* the bounds of the ranges are bounds of the intervals, so a range contains an
+             * interval completely if it contains any value of it */
+            double value;
+            if (i % 2 == 1)
+                value = feature.bounds[i / 2];
+            else if (i == 0)
+                value = -std::numeric_limits<double>::infinity();
+            else if (i == 2 * n)
+                value = std::numeric_limits<double>::infinity();
+            else
+                value = feature.bounds[i / 2 - 1] / 2 + feature.bounds[i / 2] / 2;
+
+            for (std::size_t c = 0; c < ranges.size(); c++)
+            {
+                if (ranges[c] == nullptr ||
+                    (ranges[c]->first <= value && value <= ranges[c]->second))
+                    feature.intervals[i][c / 64] |= std::uint64_t(1) << (c % 64);
+            }
+        }
+        features_.push_back(std::move(feature));
+    }
+}
+
+/** returns the index of the interval of feature, which contains value
+ */
+std::size_t phase_classifier::interval_of(const feature_index &feature, double value) const
+    noexcept
+{
+    auto it = std::lower_bound(feature.bounds.begin(), feature.bounds.end(), value);
+    auto i = static_cast<std::size_t>(it - feature.bounds.begin());
+    if (it != feature.bounds.end() && *it == value)
+        return 2 * i + 1;
+    return 2 * i;
+}
+
+/** Returns the id of the cluster with the lowest id, whose ranges contain the values, or
+ * no_cluster if there is no such cluster.
+ *
+ * @param values values of the features, indexed like features(). NaN for values which are not
+ *        known.
+ */
+int phase_classifier::classify(const std::vector<double> &values) const
+{
+    mask result(words_, ~std::uint64_t(0));
+    mask constrained(words_, 0);
+    for (std::size_t f = 0; f < features_.size() && f < values.size(); f++)
+    {
+        if (std::isnan(values[f]))
+            continue;
+        const auto &interval = features_[f].intervals[interval_of(features_[f], values[f])];
+        for (std::size_t w = 0; w < words_; w++)
+        {
+            result[w] &= interval[w];
+            constrained[w] |= features_[f].constrained[w];
+        }
+    }
+
+    for (std::size_t w = 0; w < words_; w++)
+    {
+        auto bits = result[w] & constrained[w];
+        if (bits != 0)
+        {
+            std::size_t c = w * 64;
+            while ((bits & 1) == 0)
+            {
+                bits >>= 1;
+                c++;
+            }
+            return cluster_ids_[c];
+        }
+    }
+    return no_cluster;
+}
+
+phase_monitor::phase_monitor(
+    const std::unordered_map<int, tmm::phase_data_t> &clusters, metric_manager &mm)
+    : classifier_(clusters)
+{
+    for (const auto &name : classifier_.features())
+    {
+        source s;
+        if (name == "duration")
+        {
+            s.type = source_type::duration;
+        }
+        else
+        {
+            s.metric_id = mm.get_metric_id(name);
+            if (s.metric_id >= 0)
+            {
+                s.type = source_type::metric;
+                s.metric_type = mm.get_metric_type(name);
+            }
+            else
+            {
+                logging::warn("RTS") << "Phase feature \"" << name
+                                     << "\" is no strictly synchronous metric. It is ignored for "
+                                        "the phase classification.";
+            }
+        }
+        sources_.push_back(s);
+    }
+    values_.resize(sources_.size());
+}
+
+/** returns the value of the metric of s, or NaN if there are no metric values
+ */
+double phase_monitor::metric_value(const source &s, const std::uint64_t *metric_values) const
+    noexcept
+{
+    if (metric_values == nullptr)
+        return std::nan("");
+    return metric_to_double(metric_values[s.metric_id], s.metric_type);
+}
+
+/** Has to be called when a phase begins.
+ *
+ * @param metric_values metric values passed by Score-P with the enter of the phase region, might
+ *        be nullptr
+ */
+void phase_monitor::phase_begin(const std::uint64_t *metric_values)
+{
+    for (auto &s : sources_)
+    {
+        if (s.type == source_type::metric)
+            s.begin = metric_value(s, metric_values);
+    }
+    in_phase_ = true;
+    begin_ = std::chrono::high_resolution_clock::now();
+}
+
+/** Has to be called when a phase ends. Returns the cluster of the phase, or
+ * phase_classifier::no_cluster if it is in no cluster, or phase_begin() was not called.
+ *
+ * @param metric_values metric values passed by Score-P with the exit of the phase region, might
+ *        be nullptr
+ */
+int phase_monitor::phase_end(const std::uint64_t *metric_values)
+{
+    if (!in_phase_)
+        return phase_classifier::no_cluster;
+    in_phase_ = false;
+
+    auto end = std::chrono::high_resolution_clock::now();
+    for (std::size_t i = 0; i < sources_.size(); i++)
+    {
+        switch (sources_[i].type)
+        {
+            case source_type::duration:
+                values_[i] = std::chrono::duration<double>(end - begin_).count();
+                break;
+            case source_type::metric:
+                values_[i] = metric_value(sources_[i], metric_values) - sources_[i].begin;
+                break;
+            default:
+                values_[i] = std::nan("");
+        }
+    }
+    return classifier_.classify(values_);
+}
+} // namespace rrl
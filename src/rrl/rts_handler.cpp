@@ -3,9 +3,11 @@
 #include <util/environment.hpp>
 
 #include <algorithm>
+#include <cmath>
 #include <cstdint>
 #include <fstream>
 #include <json.hpp>
+#include <unordered_set>
 
 using json = nlohmann::json;
 
@@ -20,20 +22,27 @@ namespace rrl
  * It gets the reference to the instance of tuning model manager.
  *
  * @param tmm shared pointer to a tuning model manager instance
+ * @param cal shared pointer to a calibration instance
+ * @param mm shared pointer to the metric manager, used for the phase classification
  *
  **/
-rts_handler::rts_handler(
-    std::shared_ptr<tmm::tuning_model_manager> tmm, std::shared_ptr<cal::calibration> cal)
+rts_handler::rts_handler(std::shared_ptr<tmm::tuning_model_manager> tmm,
+    std::shared_ptr<cal::calibration> cal,
+    std::shared_ptr<metric_manager> mm)
     : is_inside_root(false),
       tmm_(tmm),
       cal_(cal),
+      mm_(mm),
       pc_(parameter_controller::instance()),
       call_tree_(std::make_unique<call_tree::region_node>(
           nullptr, call_tree::node_info(0, call_tree::node_type::root))),
       current_calltree_elem_(call_tree_.get()),
-      region_status_(tmm::insignificant)
-
+      region_status_(tmm::insignificant),
+      shared_(std::make_shared<shared_state>())
 {
+    shared_->tuning_model_generation = 0;
+    shared_->phase_cluster = phase_classifier::no_cluster;
+
     logging::debug("RTS") << " initializing";
 
     try
@@ -59,6 +68,196 @@ rts_handler::rts_handler(
     {
         parse_input_identifier_file(input_id_file);
     }
+
+    phase_classification_ = rrl::environment::get("PHASE_CLASSIFICATION", "false") == "true";
+    phase_cluster_identifier_ = rrl::environment::get("PHASE_CLUSTER_IDENTIFIER", "cluster");
+}
+
+/**
+ * Constructor for worker handlers, see \ref create_worker().
+ *
+ * @param master handler of the master location
+ * @param configuration_stack settings stack of the worker
+ * @param team thread team of the worker
+ *
+ **/
+rts_handler::rts_handler(const rts_handler &master,
+    std::unique_ptr<cm::cm_base> configuration_stack,
+    const team_registry::team &team)
+    : is_inside_root(false),
+      significant_duration(master.significant_duration),
+      tmm_(master.tmm_),
+      cal_(master.cal_),
+      mm_(master.mm_),
+      pc_(master.pc_),
+      current_calltree_elem_(nullptr),
+      input_identifiers_(master.input_identifiers_),
+      region_status_(tmm::insignificant),
+      shared_(master.shared_),
+      tuning_model_generation_(master.shared_->tuning_model_generation.load()),
+      worker_(true),
+      configuration_stack_(std::move(configuration_stack)),
+      team_(team),
+      phase_classification_(master.phase_classification_),
+      phase_cluster_identifier_(master.phase_cluster_identifier_)
+{
+}
+
+/** Registers a region at the tuning model manager.
+ *
+ * The tuning model manager is locked, as workers might look up regions at the same time.
+ *
+ **/
+void rts_handler::register_region(const std::string &region_name,
+    std::uint32_t line_number,
+    const std::string &file_name,
+    std::uint32_t region_id)
+{
+    std::lock_guard<std::mutex> lock(shared_->tmm_lock);
+    tmm_->register_region(region_name, line_number, file_name, region_id);
+}
+
+/** Returns the team of a worker location, which is created by parent_location_id now.
+ *
+ * @param parent_location_id location which creates the worker location
+ *
+ **/
+team_registry::team rts_handler::new_team_member(std::uint32_t parent_location_id) const
+{
+    return shared_->teams.new_member(parent_location_id);
+}
+
+/** Creates a handler for a worker location of this handler.
+ *
+ * The worker shares the tuning model manager and the input identifiers with this handler. It gets
+ * its own settings stack from the \ref parameter_controller. It is supposed to be used by the
+ * thread of the worker location only.
+ *
+ * @param team thread team of the worker, see \ref new_team_member()
+ * @return the new worker handler
+ *
+ **/
+std::unique_ptr<rts_handler> rts_handler::create_worker(const team_registry::team &team)
+{
+    return std::unique_ptr<rts_handler>(
+        new rts_handler(*this, pc_.create_configuration_stack(), team));
+}
+
+/** Has to be called by the location, that forks a new thread team, before the team is forked.
+ *
+ * The workers of the team attach their call trees to the current node of this handler. If this
+ * handler is not inside the root region, the workers of the team are not tuned.
+ *
+ * @param location_id location of this handler
+ *
+ **/
+void rts_handler::fork(std::uint32_t location_id)
+{
+    shared_->teams.fork(location_id, is_inside_root ? current_calltree_elem_ : nullptr);
+}
+
+/** Has to be called by the location that forked a thread team, after the team is joined.
+ *
+ * @param location_id location of this handler
+ *
+ **/
+void rts_handler::join(std::uint32_t location_id)
+{
+    shared_->teams.join(location_id);
+}
+
+/** Sets the configuration, using the settings stack of the worker if this is a worker. The
+ * configuration is only counted in configs_set of the current node if it has to be unset.
+ *
+ * @param duration expected duration of the region, see \ref switch_cost_model
+ */
+void rts_handler::set_parameters(
+    const cm::slot_setting &configs, std::chrono::milliseconds duration)
+{
+    bool pushed;
+    if (worker_)
+    {
+        pushed = pc_.set_parameters(configs, *configuration_stack_, duration);
+    }
+    else
+    {
+        pushed = pc_.set_parameters(configs, duration);
+    }
+    if (pushed)
+    {
+        current_calltree_elem_->info.configs_set++;
+    }
+}
+
+/** unsets the last configuration, using the settings stack of the worker if this is a worker
+ */
+void rts_handler::unset_parameters()
+{
+    if (worker_)
+    {
+        pc_.unset_parameters(*configuration_stack_);
+    }
+    else
+    {
+        pc_.unset_parameters();
+    }
+}
+
+/** Passes the cluster of the last classified phase as input identifier, if there is one.
+ */
+void rts_handler::apply_phase_cluster()
+{
+    auto cluster = shared_->phase_cluster.load();
+    if (cluster != phase_classifier::no_cluster)
+    {
+        input_identifiers_[phase_cluster_identifier_] = std::to_string(cluster);
+    }
+}
+
+/** Classifies the phase that just ended. If its cluster differs from the cluster of the last
+ * phase, the tuning model generation is increased, so the nodes look up their configuration again
+ * with the new cluster. Phases in no cluster keep the last cluster.
+ *
+ * @param metric_values metric values passed by Score-P with the exit of the phase region
+ */
+void rts_handler::classify_phase(const std::uint64_t *metric_values)
+{
+    if (!phase_monitor_)
+    {
+        return;
+    }
+    auto cluster = phase_monitor_->phase_end(metric_values);
+    if (cluster != phase_classifier::no_cluster && cluster != shared_->phase_cluster.load())
+    {
+        logging::debug("RTS") << "phase classified as cluster " << cluster;
+        shared_->phase_cluster = cluster;
+        shared_->tuning_model_generation++;
+    }
+}
+
+/** Returns the value of the energy metric, which is given by SCOREP_RRL_CAL_ENERGY like for the
+ * calibration modules, or NaN if there is no such metric.
+ */
+double rts_handler::energy(const std::uint64_t *metric_values)
+{
+    if (!energy_metric_resolved_)
+    {
+        energy_metric_resolved_ = true;
+        auto metric_name = rrl::environment::get("CAL_ENERGY", "");
+        if (!metric_name.empty() && mm_)
+        {
+            energy_metric_id_ = mm_->get_metric_id(metric_name);
+            if (energy_metric_id_ != -1)
+            {
+                energy_metric_type_ = mm_->get_metric_type(metric_name);
+            }
+        }
+    }
+    if (metric_values == nullptr || energy_metric_id_ == -1)
+    {
+        return std::nan("");
+    }
+    return metric_to_double(metric_values[energy_metric_id_], energy_metric_type_);
 }
 
 /**
@@ -73,6 +272,65 @@ rts_handler::~rts_handler()
     logging::debug("RTS") << " finalizing";
 }
 
+namespace
+{
+/** resets the state of the nodes of the call tree of root, which change affects
+ */
+void invalidate(call_tree::base_node &root,
+    const tmm::tuning_model_change &change,
+    const std::unordered_set<tmm::callpath_id> &callpaths,
+    const std::unordered_set<std::uint32_t> &regions)
+{
+    if (change.all)
+    {
+        root.reset_state();
+        return;
+    }
+    root.arena().for_each([&callpaths, &regions](call_tree::base_node *node) {
+        tmm::callpath_id id;
+        if ((node->cached_callpath_id(id) && callpaths.count(id) != 0) ||
+            regions.count(node->info.region_id) != 0)
+        {
+            node->invalidate();
+        }
+    });
+}
+} // namespace
+
+/** Resets the call trees of this handler for a new tuning model generation. If the only change
+ * since the last generation this handler has seen is a change reported by the tmm, only the
+ * affected nodes are reset.
+ *
+ * @param generation the new tuning model generation
+ */
+void rts_handler::reset_call_trees(std::uint64_t generation)
+{
+    std::shared_ptr<const tmm::tuning_model_change> change;
+    {
+        std::lock_guard<std::mutex> lock(shared_->tmm_lock);
+        if (shared_->change_generation == generation && generation == tuning_model_generation_ + 1)
+        {
+            change = shared_->change;
+        }
+    }
+    if (!change)
+    {
+        change = std::make_shared<const tmm::tuning_model_change>();
+    }
+
+    std::unordered_set<tmm::callpath_id> callpaths(
+        change->callpaths.begin(), change->callpaths.end());
+    std::unordered_set<std::uint32_t> regions(change->regions.begin(), change->regions.end());
+    if (call_tree_)
+    {
+        invalidate(*call_tree_, *change, callpaths, regions);
+    }
+    for (auto &team_root : team_roots_)
+    {
+        invalidate(*team_root.second, *change, callpaths, regions);
+    }
+}
+
 /** Checks if all information for loading the config are present, and loads the
  * current configuration.
  *
@@ -88,20 +346,39 @@ rts_handler::~rts_handler()
  */
 void rts_handler::load_config()
 {
-    if (tmm_->has_changed())
+    if (!worker_ && tmm_->has_changed())
+    {
+        std::lock_guard<std::mutex> lock(shared_->tmm_lock);
+        shared_->change = std::make_shared<const tmm::tuning_model_change>(tmm_->take_change());
+        shared_->change_generation = ++shared_->tuning_model_generation;
+        if (shared_->change->all)
+        {
+            /* the clusters might have changed */
+            phase_monitor_.reset();
+        }
+    }
+    auto generation = shared_->tuning_model_generation.load(std::memory_order_relaxed);
+    if (generation != tuning_model_generation_)
     {
-        call_tree_->reset_state();
+        reset_call_trees(generation);
+        tuning_model_generation_ = generation;
+        if (phase_classification_)
+        {
+            apply_phase_cluster();
+        }
     }
+
     if (current_calltree_elem_->info.state == call_tree::node_state::unknown)
     {
-        logging::trace("RTS") << "ENTER State: call_tree::node_state::unknown.";
+        RRL_TRACE("RTS") << "ENTER State: call_tree::node_state::unknown.";
 
+        std::lock_guard<std::mutex> lock(shared_->tmm_lock);
         if (tmm_->is_significant(current_calltree_elem_->info.region_id) == tmm::significant)
         {
-            auto call_path = current_calltree_elem_->build_callpath();
+            auto call_path = current_calltree_elem_->callpath_id(tmm_->callpaths());
             current_calltree_elem_->set_configuration(
-                tmm_->get_current_rts_configuration(call_path, input_identifiers_));
-            if (current_calltree_elem_->get_configuration().size() != 0)
+                pc_.to_slots(tmm_->get_current_rts_configuration(call_path, input_identifiers_)));
+            if (current_calltree_elem_->get_configuration().mask != 0)
             {
                 /** Workaround. There is an assertion that the callpath is in the TM, what is not
                  * neccessary the case. The node measurs its duration itslef.
@@ -109,12 +386,12 @@ void rts_handler::load_config()
                 current_calltree_elem_->info.duration = tmm_->get_exectime(call_path);
             }
             current_calltree_elem_->info.state = call_tree::node_state::known;
-            logging::trace("RTS") << "ENTER Change State to : call_tree::node_state::known.";
+            RRL_TRACE("RTS") << "ENTER Change State to : call_tree::node_state::known.";
         }
         else
         {
             current_calltree_elem_->info.state = call_tree::node_state::measure_duration;
-            logging::trace("RTS")
+            RRL_TRACE("RTS")
                 << "ENTER Change State to : call_tree::node_state::measure_duration.";
             current_calltree_elem_->start_measurment();
         }
@@ -122,17 +399,17 @@ void rts_handler::load_config()
 
     if (current_calltree_elem_->info.state == call_tree::node_state::known)
     {
-        logging::trace("RTS") << "ENTER State: call_tree::node_state::known.";
-        if ((current_calltree_elem_->get_configuration().size() > 0) &&
+        RRL_TRACE("RTS") << "ENTER State: call_tree::node_state::known.";
+        if ((current_calltree_elem_->get_configuration().mask != 0) &&
             (current_calltree_elem_->info.duration > significant_duration))
         {
-            pc_.set_parameters(current_calltree_elem_->get_configuration());
-            current_calltree_elem_->info.configs_set++;
+            set_parameters(current_calltree_elem_->get_configuration(),
+                current_calltree_elem_->info.duration);
         }
     }
     else if (current_calltree_elem_->info.state == call_tree::node_state::calibrate)
     {
-        logging::trace("RTS") << "ENTER State: call_tree::node_state::calibrate.";
+        RRL_TRACE("RTS") << "ENTER State: call_tree::node_state::calibrate.";
         /* If the parent node decided to calibrate, we better don't. Similar if the parente has not
          * decided yet and is still in measrument.
          *
@@ -158,9 +435,8 @@ void rts_handler::load_config()
         */
         {
             auto conf = cal_->calibrate_region(current_calltree_elem_);
-            current_calltree_elem_->set_configuration(conf);
-            pc_.set_parameters(current_calltree_elem_->get_configuration());
-            current_calltree_elem_->info.configs_set++;
+            current_calltree_elem_->set_configuration(pc_.to_slots(conf));
+            set_parameters(current_calltree_elem_->get_configuration());
         }
     }
 }
@@ -180,28 +456,68 @@ void rts_handler::load_config()
  * @param region_id Score-P region identifier
  * @param locationData can be used with scorep::location_get_id() and
  *        scorep::location_get_gloabl_id() to obtain the location of the call.
+ * @param metric_values values of the strictly synchronous metrics, used by the phase
+ *        classification. Might be nullptr.
  **/
-void rts_handler::enter_region(uint32_t region_id, SCOREP_Location *locationData)
+void rts_handler::enter_region(
+    uint32_t region_id, SCOREP_Location *locationData, const std::uint64_t *metric_values)
 {
+    if (worker_)
+    {
+        if (!is_inside_root)
+        {
+            auto team_node = skipped_depth_ == 0 ? shared_->teams.node(team_) : nullptr;
+            if (team_node == nullptr)
+            {
+                skipped_depth_++;
+                return;
+            }
+            auto &team_root = team_roots_[team_node];
+            if (!team_root)
+            {
+                team_root = std::make_unique<call_tree::region_node>(
+                    team_node, call_tree::node_info(0, call_tree::node_type::root));
+            }
+            current_calltree_elem_ = team_root.get();
+            is_inside_root = true;
+        }
+        current_calltree_elem_ = current_calltree_elem_->enter_node(region_id);
+        load_config();
+        return;
+    }
+
     auto elem = tmm::simple_callpath_element(region_id, tmm::identifier_set());
     if (!is_inside_root)
     {
         if (tmm_->is_root(elem))
         {
             is_inside_root = true;
-            logging::trace("RTS") << "tmm_->is_root(elem) = true";
+            RRL_TRACE("RTS") << "tmm_->is_root(elem) = true";
+            if (phase_classification_)
+            {
+                if (!phase_monitor_)
+                {
+                    std::lock_guard<std::mutex> lock(shared_->tmm_lock);
+                    phase_monitor_ = std::make_unique<phase_monitor>(tmm_->get_phase_data(), *mm_);
+                }
+                phase_monitor_->phase_begin(metric_values);
+            }
         }
         else
         {
-            logging::trace("RTS") << "tmm_->is_root(elem) = false";
+            RRL_TRACE("RTS") << "tmm_->is_root(elem) = false";
             return;
         }
     }
-    logging::trace("RTS") << "is_inside_root = true";
+    RRL_TRACE("RTS") << "is_inside_root = true";
 
     current_calltree_elem_ = current_calltree_elem_->enter_node(region_id);
 
     load_config();
+    if (current_calltree_elem_->info.state == call_tree::node_state::calibrate)
+    {
+        current_calltree_elem_->info.energy_begin = energy(metric_values);
+    }
 }
 
 /**This function handles the exit regions.
@@ -212,19 +528,29 @@ void rts_handler::enter_region(uint32_t region_id, SCOREP_Location *locationData
  * @param region_id Score-P region identifier
  * @param locationData can be used with scorep::location_get_id() and
  *        scorep::location_get_gloabl_id() to obtain the location of the call.
+ * @param metric_values values of the strictly synchronous metrics, used by the phase
+ *        classification. Might be nullptr.
  **/
-void rts_handler::exit_region(uint32_t region_id, SCOREP_Location *locationData)
+void rts_handler::exit_region(
+    uint32_t region_id, SCOREP_Location *locationData, const std::uint64_t *metric_values)
 {
     if (!is_inside_root)
     {
+        if (skipped_depth_ > 0)
+        {
+            skipped_depth_--;
+        }
         return;
     }
 
     auto elem = tmm::simple_callpath_element(region_id, tmm::identifier_set());
-    if ((current_calltree_elem_->parent_->info.type == call_tree::node_type::root) &&
-        (tmm_->is_root(elem) == true))
+    if (current_calltree_elem_->parent_->info.type == call_tree::node_type::root)
     {
-        is_inside_root = false;
+        /* a worker leaves the root with the first region it has entered in the team */
+        if (worker_ || tmm_->is_root(elem))
+        {
+            is_inside_root = false;
+        }
     }
 
     if (current_calltree_elem_->info.region_id != elem.region_id)
@@ -241,7 +567,7 @@ void rts_handler::exit_region(uint32_t region_id, SCOREP_Location *locationData)
 
     if (current_calltree_elem_->info.state == call_tree::node_state::calibrate)
     {
-        logging::trace("RTS") << "EXIT State: call_tree::node_state::calibrate.";
+        RRL_TRACE("RTS") << "EXIT State: call_tree::node_state::calibrate.";
         /* If the parent node decided to calibrate, we didn't. Similar if the parente has not
          * decided yet and is still in measrument.
          */
@@ -251,29 +577,31 @@ void rts_handler::exit_region(uint32_t region_id, SCOREP_Location *locationData)
         {
             if (!cal_->keep_calibrating())
             {
-                current_calltree_elem_->set_configuration(
-                    cal_->request_configuration(current_calltree_elem_));
+                auto configuration = cal_->request_configuration(current_calltree_elem_);
+                current_calltree_elem_->set_configuration(pc_.to_slots(configuration));
 
-                tmm_->store_configuration(current_calltree_elem_->build_callpath(),
-                    current_calltree_elem_->get_configuration(),
-                    current_calltree_elem_->info.duration);
+                std::lock_guard<std::mutex> lock(shared_->tmm_lock);
+                tmm_->store_configuration(current_calltree_elem_->callpath_id(tmm_->callpaths()),
+                    configuration,
+                    current_calltree_elem_->info.duration,
+                    energy(metric_values) - current_calltree_elem_->info.energy_begin);
                 current_calltree_elem_->info.state = call_tree::node_state::known;
-                logging::trace("RTS") << "EXIT Change State to : call_tree::node_state::known.";
+                RRL_TRACE("RTS") << "EXIT Change State to : call_tree::node_state::known.";
             }
         }
     }
     else if (current_calltree_elem_->info.state == call_tree::node_state::measure_duration)
     {
-        logging::trace("RTS") << "EXIT State: call_tree::node_state::measure_duration.";
+        RRL_TRACE("RTS") << "EXIT State: call_tree::node_state::measure_duration.";
         current_calltree_elem_->stop_measurment();
-        if (current_calltree_elem_->callibrate_region(significant_duration))
+        if (!worker_ && current_calltree_elem_->callibrate_region(significant_duration))
         {
-            logging::trace("RTS") << "EXIT Change State: call_tree::node_state::calibrate.";
+            RRL_TRACE("RTS") << "EXIT Change State: call_tree::node_state::calibrate.";
             current_calltree_elem_->info.state = call_tree::node_state::calibrate;
         }
         else
         {
-            logging::trace("RTS") << "EXIT Change State: call_tree::node_state::known.";
+            RRL_TRACE("RTS") << "EXIT Change State: call_tree::node_state::known.";
             current_calltree_elem_->info.state = call_tree::node_state::known;
         }
     }
@@ -290,10 +618,15 @@ void rts_handler::exit_region(uint32_t region_id, SCOREP_Location *locationData)
          * When we now call return_to_parent() we need to unset both add_id foo and add_id baz
          * But we get only on exit. So we need to collect them, and reset them at once.
          */
-        pc_.unset_parameters();
+        unset_parameters();
     }
     current_calltree_elem_->info.configs_set = 0;
     current_calltree_elem_ = current_calltree_elem_->return_to_parent();
+
+    if (!worker_ && !is_inside_root)
+    {
+        classify_phase(metric_values);
+    }
 }
 
 void rts_handler::create_location(SCOREP_LocationType location_type, std::uint32_t location_id)
@@ -324,9 +657,8 @@ void rts_handler::user_parameter(
         return;
     }
 
-    logging::trace("RTS") << " Got additional user param uint \"" << user_parameter_name
-                          << "(hash: " << user_parameter_hash_(user_parameter_name)
-                          << "\": " << value;
+    RRL_TRACE("RTS") << " Got additional user param uint \"" << user_parameter_name
+                     << "(hash: " << user_parameter_hash_(user_parameter_name) << "\": " << value;
     call_tree::add_id_node *tmp = dynamic_cast<call_tree::add_id_node *>(
         current_calltree_elem_->enter_node(user_parameter_name));
     current_calltree_elem_ = tmp->enter_node_uint(value);
@@ -350,9 +682,8 @@ void rts_handler::user_parameter(
         return;
     }
 
-    logging::trace("RTS") << " Got additional user param int \"" << user_parameter_name
-                          << "(hash: " << user_parameter_hash_(user_parameter_name)
-                          << "\": " << value;
+    RRL_TRACE("RTS") << " Got additional user param int \"" << user_parameter_name
+                     << "(hash: " << user_parameter_hash_(user_parameter_name) << "\": " << value;
     call_tree::add_id_node *tmp = dynamic_cast<call_tree::add_id_node *>(
         current_calltree_elem_->enter_node(user_parameter_name));
     current_calltree_elem_ = tmp->enter_node_int(value);
@@ -378,9 +709,8 @@ void rts_handler::user_parameter(
         return;
     }
 
-    logging::trace("RTS") << " Got additional user param string \"" << user_parameter_name
-                          << "(hash: " << user_parameter_hash_(user_parameter_name)
-                          << "\": " << value;
+    RRL_TRACE("RTS") << " Got additional user param string \"" << user_parameter_name
+                     << "(hash: " << user_parameter_hash_(user_parameter_name) << "\": " << value;
     call_tree::add_id_node *tmp = dynamic_cast<call_tree::add_id_node *>(
         current_calltree_elem_->enter_node(user_parameter_name));
     current_calltree_elem_ = tmp->enter_node_string(value);
@@ -0,0 +1,48 @@
+#include <rrl/switch_cost_model.hpp>
+
+namespace rrl
+{
+switch_cost_model::switch_cost_model(double factor) : factor_(factor)
+{
+    for (auto &latency : latencies_)
+    {
+        latency.store(0, std::memory_order_relaxed);
+    }
+}
+
+void switch_cost_model::add_parameter(std::size_t slot, std::chrono::nanoseconds latency) noexcept
+{
+    latencies_[slot].store(latency.count(), std::memory_order_relaxed);
+}
+
+/** Updates the moving average with a weight of 1/8 for the new latency. Concurrent updates of the
+ * same parameter might get lost, which only delays the adaption of the average.
+ */
+void switch_cost_model::record(std::size_t slot, std::chrono::nanoseconds latency) noexcept
+{
+    auto average = latencies_[slot].load(std::memory_order_relaxed);
+    latencies_[slot].store(average + (latency.count() - average) / 8, std::memory_order_relaxed);
+}
+
+/** Returns the time to switch the changed parameters and back, which is the sum of their
+ * latencies, counted twice.
+ *
+ * @param changed mask of the slots of the parameters that change
+ */
+std::chrono::nanoseconds switch_cost_model::cost(std::uint64_t changed) const noexcept
+{
+    std::chrono::nanoseconds cost(0);
+    cm::for_each_slot(changed, [this, &cost](std::size_t slot) { cost += 2 * latency(slot); });
+    return cost;
+}
+
+/** checks if a region of the given duration is at least factor times longer than switching the
+ * changed parameters and back
+ */
+bool switch_cost_model::pays_off(
+    std::uint64_t changed, std::chrono::milliseconds duration) const noexcept
+{
+    auto cost_ms = std::chrono::duration<double, std::milli>(cost(changed)).count();
+    return cost_ms * factor_ <= static_cast<double>(duration.count());
+}
+} // namespace rrl
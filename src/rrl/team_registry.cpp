@@ -0,0 +1,55 @@
+#include <rrl/team_registry.hpp>
+
+#include <util/log.hpp>
+
+namespace rrl
+{
+void team_registry::fork(std::uint32_t location_id, call_tree::base_node *node)
+{
+    std::lock_guard<std::mutex> lock(lock_);
+    teams_[location_id].push_back(node);
+}
+
+void team_registry::join(std::uint32_t location_id)
+{
+    std::lock_guard<std::mutex> lock(lock_);
+    auto teams = teams_.find(location_id);
+    if (teams == teams_.end() || teams->second.empty())
+    {
+        logging::warn("TEAMS") << "join without fork on location " << location_id;
+        return;
+    }
+    teams->second.pop_back();
+}
+
+team_registry::team team_registry::new_member(std::uint32_t parent_location_id) const
+{
+    std::lock_guard<std::mutex> lock(lock_);
+    team t;
+    t.location_id = parent_location_id;
+    auto teams = teams_.find(parent_location_id);
+    if (teams != teams_.end())
+    {
+        t.depth = teams->second.size();
+    }
+    return t;
+}
+
+/** A team that is joined has no node. If a later team of the same location is forked at the same
+ * depth, e.g. the next parallel region, the workers of the pool are reused for it.
+ */
+call_tree::base_node *team_registry::node(const team &t) const
+{
+    if (t.depth == 0)
+    {
+        return nullptr;
+    }
+    std::lock_guard<std::mutex> lock(lock_);
+    auto teams = teams_.find(t.location_id);
+    if (teams == teams_.end() || teams->second.size() < t.depth)
+    {
+        return nullptr;
+    }
+    return teams->second[t.depth - 1];
+}
+} // namespace rrl
@@ -0,0 +1,578 @@
+#include <tmm/binary_model.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace rrl
+{
+namespace tmm
+{
+binary_model::binary_model(std::shared_ptr<const char> data, std::size_t size)
+    : data_(std::move(data)),
+      size_(size),
+      header_(reinterpret_cast<const binary::header *>(data_.get()))
+{
+    static const std::size_t record_sizes[binary::section_count] = {sizeof(char),
+        sizeof(binary::region_record),
+        sizeof(binary::identifier_record),
+        sizeof(binary::id_set_record),
+        sizeof(binary::element_record),
+        sizeof(binary::callpath_record),
+        sizeof(binary::scenario_record),
+        sizeof(binary::parameter_record),
+        sizeof(binary::cluster_record),
+        sizeof(std::uint64_t),
+        sizeof(binary::range_record)};
+
+    if (reinterpret_cast<std::uintptr_t>(data_.get()) % 8 != 0)
+        throw std::runtime_error("Binary tuning model is not aligned.");
+    if (size_ < sizeof(binary::header) || std::memcmp(header_->magic, binary::magic, 8) != 0)
+        throw std::runtime_error("Invalid binary tuning model.");
+    if (header_->version != binary::version || header_->byte_order != binary::byte_order)
+        throw std::runtime_error("Unsupported version or byte order of the binary tuning model.");
+    if (header_->hash_fingerprint != hash_fingerprint())
+        throw std::runtime_error("The binary tuning model was written with different hash "
+                                 "functions. Please convert the JSON tuning model again.");
+    if (header_->size != size_)
+        throw std::runtime_error("Truncated binary tuning model.");
+
+    for (std::uint32_t s = 0; s < binary::section_count; s++)
+    {
+        const auto &ref = header_->sections[s];
+        if (ref.offset % 8 != 0 || ref.offset > size_ ||
+            ref.count > (size_ - ref.offset) / record_sizes[s])
+            throw std::runtime_error("Invalid binary tuning model.");
+    }
+    if (header_->root_element != binary::no_index &&
+        header_->root_element >= section_size(binary::elements))
+        throw std::runtime_error("Invalid binary tuning model.");
+
+    validate_records();
+}
+
+/** checks that count records starting at first are inside section s
+ */
+bool binary_model::in_section(
+    binary::section s, std::uint64_t first, std::uint64_t count) const noexcept
+{
+    return first <= section_size(s) && count <= section_size(s) - first;
+}
+
+bool binary_model::valid(binary::string_ref ref) const noexcept
+{
+    return in_section(binary::strings, ref.offset, ref.length);
+}
+
+/** Checks all references between the records, so the queries can access the records without
+ * checks. This reads the whole model once.
+ *
+ * @throws std::runtime_error if a reference points outside of its section
+ */
+void binary_model::validate_records() const
+{
+    auto check = [](bool ok, const char *record) {
+        if (!ok)
+            throw std::runtime_error(
+                std::string("Invalid binary tuning model: corrupt ") + record + " record.");
+    };
+
+    auto regions = section<binary::region_record>(binary::regions);
+    for (std::size_t n = 0; n < section_size(binary::regions); n++)
+        check(valid(regions[n].file) && valid(regions[n].name), "region");
+
+    auto identifiers = section<binary::identifier_record>(binary::identifiers);
+    for (std::size_t n = 0; n < section_size(binary::identifiers); n++)
+        check(identifiers[n].type <= binary::string_identifier && valid(identifiers[n].string),
+            "identifier");
+
+    auto id_sets = section<binary::id_set_record>(binary::id_sets);
+    for (std::size_t n = 0; n < section_size(binary::id_sets); n++)
+    {
+        std::uint64_t count =
+            std::uint64_t(id_sets[n].nuints) + id_sets[n].nints + id_sets[n].nstrings;
+        check(in_section(binary::identifiers, id_sets[n].first_identifier, count), "id set");
+    }
+
+    auto elements = section<binary::element_record>(binary::elements);
+    for (std::size_t n = 0; n < section_size(binary::elements); n++)
+        check(elements[n].region < section_size(binary::regions) &&
+                  elements[n].id_set < section_size(binary::id_sets),
+            "element");
+
+    auto callpaths = section<binary::callpath_record>(binary::callpaths);
+    for (std::size_t n = 0; n < section_size(binary::callpaths); n++)
+        check(in_section(binary::elements, callpaths[n].first_element, callpaths[n].nelements) &&
+                  in_section(
+                      binary::scenarios, callpaths[n].first_scenario, callpaths[n].nscenarios),
+            "callpath");
+
+    auto scenarios = section<binary::scenario_record>(binary::scenarios);
+    for (std::size_t n = 0; n < section_size(binary::scenarios); n++)
+        check(scenarios[n].input_id_set < section_size(binary::id_sets) &&
+                  in_section(binary::parameters,
+                      scenarios[n].first_parameter,
+                      scenarios[n].nparameters),
+            "scenario");
+
+    auto clusters = section<binary::cluster_record>(binary::clusters);
+    for (std::size_t n = 0; n < section_size(binary::clusters); n++)
+        check(in_section(binary::phases, clusters[n].first_phase, clusters[n].nphases) &&
+                  in_section(binary::ranges, clusters[n].first_range, clusters[n].nranges),
+            "cluster");
+
+    auto ranges = section<binary::range_record>(binary::ranges);
+    for (std::size_t n = 0; n < section_size(binary::ranges); n++)
+        check(valid(ranges[n].feature), "range");
+}
+
+std::shared_ptr<const binary_model> binary_model::map(const std::string &file_path)
+{
+    int fd = open(file_path.c_str(), O_RDONLY);
+    if (fd == -1)
+        throw std::runtime_error("Cannot open tuning model: " + file_path);
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0)
+    {
+        close(fd);
+        throw std::runtime_error("Cannot read tuning model: " + file_path);
+    }
+
+    auto size = static_cast<std::size_t>(st.st_size);
+    void *addr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED)
+        throw std::runtime_error("Cannot map tuning model: " + file_path);
+
+    std::shared_ptr<const char> data(static_cast<const char *>(addr),
+        [size](const char *p) { munmap(const_cast<char *>(p), size); });
+    return std::make_shared<const binary_model>(std::move(data), size);
+}
+
+bool binary_model::is_binary(const std::string &file_path)
+{
+    std::ifstream is(file_path, std::ios::binary);
+    char magic[sizeof(binary::magic)];
+    if (!is.read(magic, sizeof(magic)))
+        return false;
+    return std::memcmp(magic, binary::magic, sizeof(magic)) == 0;
+}
+
+std::uint64_t binary_model::hash_fingerprint()
+{
+    /* covers std::hash<std::string>, which is used for identifier and parameter ids, as well as
+     * the callpath hash of the lookup tables */
+    identifier_set ids;
+    ids.add_identifier("binary_model", std::string("fingerprint"));
+    std::vector<callpath_element> cp = {
+        callpath_element(region_id("tmm/binary_model.cpp", 42, "fingerprint"), ids)};
+    return hash::combine(std::hash<std::vector<callpath_element>>{}(cp), sizeof(std::size_t));
+}
+
+std::string binary_model::decode_string(binary::string_ref ref) const
+{
+    const char *strings = section<char>(binary::strings);
+    return std::string(strings + ref.offset, ref.length);
+}
+
+bool binary_model::equals(binary::string_ref ref, const std::string &s) const noexcept
+{
+    const char *strings = section<char>(binary::strings);
+    return ref.length == s.size() && std::memcmp(strings + ref.offset, s.data(), s.size()) == 0;
+}
+
+/** compares an element of the file with cpe, without decoding the element
+ */
+bool binary_model::equals(const binary::element_record &element, const callpath_element &cpe) const
+    noexcept
+{
+    const auto &region = section<binary::region_record>(binary::regions)[element.region];
+    if (region.line != cpe.line() || !equals(region.name, cpe.name()))
+        return false;
+
+    const auto &id_set = section<binary::id_set_record>(binary::id_sets)[element.id_set];
+    const auto &ids = cpe.ids();
+    if (id_set.nuints != ids.uints.size() || id_set.nints != ids.ints.size() ||
+        id_set.nstrings != ids.strings.size())
+        return false;
+
+    const auto *id =
+        section<binary::identifier_record>(binary::identifiers) + id_set.first_identifier;
+    for (const auto &uint_id : ids.uints)
+    {
+        if (id->id != uint_id.id || id->value != uint_id.value)
+            return false;
+        id++;
+    }
+    for (const auto &int_id : ids.ints)
+    {
+        if (id->id != int_id.id || static_cast<std::int64_t>(id->value) != int_id.value)
+            return false;
+        id++;
+    }
+    for (const auto &string_id : ids.strings)
+    {
+        if (id->id != string_id.id || !equals(id->string, string_id.value))
+            return false;
+        id++;
+    }
+    return true;
+}
+
+const binary::region_record *binary_model::find_region(const region_id &rid) const noexcept
+{
+    auto hash = std::hash<region_id>{}(rid);
+    auto begin = section<binary::region_record>(binary::regions);
+    auto end = begin + section_size(binary::regions);
+    auto it = std::lower_bound(begin, end, hash,
+        [](const binary::region_record &r, std::uint64_t h) { return r.hash < h; });
+    for (; it != end && it->hash == hash; ++it)
+    {
+        if (it->line == rid.line && equals(it->name, rid.name.str()))
+            return it;
+    }
+    return nullptr;
+}
+
+const binary::callpath_record *binary_model::find_callpath(
+    const std::vector<callpath_element> &cp) const noexcept
+{
+    auto hash = std::hash<std::vector<callpath_element>>{}(cp);
+    auto begin = section<binary::callpath_record>(binary::callpaths);
+    auto end = begin + section_size(binary::callpaths);
+    auto elements = section<binary::element_record>(binary::elements);
+    auto it = std::lower_bound(begin, end, hash,
+        [](const binary::callpath_record &c, std::uint64_t h) { return c.hash < h; });
+    for (; it != end && it->hash == hash; ++it)
+    {
+        if (it->nelements != cp.size())
+            continue;
+        bool equal = true;
+        for (std::size_t n = 0; n < cp.size() && equal; n++)
+        {
+            equal = equals(elements[it->first_element + n], cp[n]);
+        }
+        if (equal)
+            return it;
+    }
+    return nullptr;
+}
+
+bool binary_model::is_root(const callpath_element &cpe) const noexcept
+{
+    if (header_->root_element == binary::no_index)
+        return false;
+    return equals(section<binary::element_record>(binary::elements)[header_->root_element], cpe);
+}
+
+region_id binary_model::decode_region(std::uint64_t index) const
+{
+    const auto &region = section<binary::region_record>(binary::regions)[index];
+    return region_id(decode_string(region.file), region.line, decode_string(region.name));
+}
+
+identifier_set binary_model::decode_id_set(std::uint64_t index) const
+{
+    const auto &id_set = section<binary::id_set_record>(binary::id_sets)[index];
+    const auto *id =
+        section<binary::identifier_record>(binary::identifiers) + id_set.first_identifier;
+
+    identifier_set ids;
+    for (std::uint32_t n = 0; n < id_set.nuints; n++, id++)
+        ids.uints.emplace_back(identifier<std::uint64_t>(id->id, id->value));
+    for (std::uint32_t n = 0; n < id_set.nints; n++, id++)
+        ids.ints.emplace_back(
+            identifier<std::int64_t>(id->id, static_cast<std::int64_t>(id->value)));
+    for (std::uint32_t n = 0; n < id_set.nstrings; n++, id++)
+        ids.strings.emplace_back(identifier<std::string>(id->id, decode_string(id->string)));
+    return ids;
+}
+
+std::vector<callpath_element> binary_model::decode_callpath(const binary::callpath_record &cp) const
+{
+    auto elements = section<binary::element_record>(binary::elements) + cp.first_element;
+
+    std::vector<callpath_element> result;
+    result.reserve(cp.nelements);
+    for (std::uint64_t n = 0; n < cp.nelements; n++)
+    {
+        result.emplace_back(decode_region(elements[n].region), decode_id_set(elements[n].id_set));
+    }
+    return result;
+}
+
+std::unordered_map<identifier_set, configuration_t> binary_model::decode_scenarios(
+    const binary::callpath_record &cp) const
+{
+    auto scenarios = section<binary::scenario_record>(binary::scenarios) + cp.first_scenario;
+    auto parameters = section<binary::parameter_record>(binary::parameters);
+
+    std::unordered_map<identifier_set, configuration_t> result;
+    for (std::uint64_t n = 0; n < cp.nscenarios; n++)
+    {
+        configuration_t config;
+        for (std::uint64_t p = 0; p < scenarios[n].nparameters; p++)
+        {
+            const auto &parameter = parameters[scenarios[n].first_parameter + p];
+            config[parameter.id] = static_cast<int>(parameter.value);
+        }
+        result.emplace(decode_id_set(scenarios[n].input_id_set), std::move(config));
+    }
+    return result;
+}
+
+std::unordered_map<int, phase_data_t> binary_model::decode_clusters() const
+{
+    auto clusters = section<binary::cluster_record>(binary::clusters);
+    auto phases = section<std::uint64_t>(binary::phases);
+    auto ranges = section<binary::range_record>(binary::ranges);
+
+    std::unordered_map<int, phase_data_t> result;
+    for (std::size_t n = 0; n < section_size(binary::clusters); n++)
+    {
+        phase_data_t pd;
+        for (std::uint64_t p = 0; p < clusters[n].nphases; p++)
+            pd.first.insert(static_cast<unsigned int>(phases[clusters[n].first_phase + p]));
+        for (std::uint64_t r = 0; r < clusters[n].nranges; r++)
+        {
+            const auto &range = ranges[clusters[n].first_range + r];
+            pd.second.emplace(decode_string(range.feature), std::make_pair(range.start, range.end));
+        }
+        result.emplace(static_cast<int>(clusters[n].id), std::move(pd));
+    }
+    return result;
+}
+
+namespace
+{
+/** collects the records of a binary tuning model, before they are written */
+class binary_writer
+{
+public:
+    binary::string_ref add_string(const std::string &s)
+    {
+        auto it = string_refs_.find(s);
+        if (it != string_refs_.end())
+            return it->second;
+
+        binary::string_ref ref{static_cast<std::uint32_t>(strings_.size()),
+            static_cast<std::uint32_t>(s.size())};
+        strings_.append(s);
+        string_refs_.emplace(s, ref);
+        return ref;
+    }
+
+    std::uint64_t add_id_set(const identifier_set &ids)
+    {
+        auto it = id_set_index_.find(ids);
+        if (it != id_set_index_.end())
+            return it->second;
+
+        binary::id_set_record record{identifiers_.size(),
+            static_cast<std::uint32_t>(ids.uints.size()),
+            static_cast<std::uint32_t>(ids.ints.size()),
+            static_cast<std::uint32_t>(ids.strings.size()),
+            0};
+        for (const auto &id : ids.uints)
+            identifiers_.push_back({binary::uint_identifier, 0, id.id, id.value, {0, 0}});
+        for (const auto &id : ids.ints)
+            identifiers_.push_back(
+                {binary::int_identifier, 0, id.id, static_cast<std::uint64_t>(id.value), {0, 0}});
+        for (const auto &id : ids.strings)
+            identifiers_.push_back(
+                {binary::string_identifier, 0, id.id, 0, add_string(id.value)});
+
+        std::uint64_t index = id_sets_.size();
+        id_sets_.push_back(record);
+        id_set_index_.emplace(ids, index);
+        return index;
+    }
+
+    void write(std::ostream &os, std::uint64_t root_element) const
+    {
+        std::string buffer(sizeof(binary::header), '\0');
+        binary::header header;
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, binary::magic, sizeof(header.magic));
+        header.version = binary::version;
+        header.byte_order = binary::byte_order;
+        header.hash_fingerprint = binary_model::hash_fingerprint();
+        header.root_element = root_element;
+
+        append(buffer, header.sections[binary::strings], strings_.data(), strings_.size(), 1);
+        append(buffer, header.sections[binary::regions], regions);
+        append(buffer, header.sections[binary::identifiers], identifiers_);
+        append(buffer, header.sections[binary::id_sets], id_sets_);
+        append(buffer, header.sections[binary::elements], elements);
+        append(buffer, header.sections[binary::callpaths], callpaths);
+        append(buffer, header.sections[binary::scenarios], scenarios);
+        append(buffer, header.sections[binary::parameters], parameters);
+        append(buffer, header.sections[binary::clusters], clusters);
+        append(buffer, header.sections[binary::phases], phases);
+        append(buffer, header.sections[binary::ranges], ranges);
+
+        header.size = buffer.size();
+        std::memcpy(&buffer[0], &header, sizeof(header));
+        os.write(buffer.data(), buffer.size());
+    }
+
+    std::vector<binary::region_record> regions;
+    std::vector<binary::element_record> elements;
+    std::vector<binary::callpath_record> callpaths;
+    std::vector<binary::scenario_record> scenarios;
+    std::vector<binary::parameter_record> parameters;
+    std::vector<binary::cluster_record> clusters;
+    std::vector<std::uint64_t> phases;
+    std::vector<binary::range_record> ranges;
+
+private:
+    template <typename Record>
+    static void append(std::string &buffer, binary::section_ref &ref, const std::vector<Record> &v)
+    {
+        append(buffer, ref, v.data(), v.size(), sizeof(Record));
+    }
+
+    static void append(std::string &buffer,
+        binary::section_ref &ref,
+        const void *data,
+        std::size_t count,
+        std::size_t record_size)
+    {
+        buffer.resize((buffer.size() + 7) / 8 * 8, '\0');
+        ref.offset = buffer.size();
+        ref.count = count;
+        buffer.append(static_cast<const char *>(data), count * record_size);
+    }
+
+    std::string strings_;
+    std::unordered_map<std::string, binary::string_ref> string_refs_;
+    std::vector<binary::identifier_record> identifiers_;
+    std::vector<binary::id_set_record> id_sets_;
+    std::unordered_map<identifier_set, std::uint64_t> id_set_index_;
+};
+
+struct region_info
+{
+    std::uint32_t flags = 0;
+    std::uint32_t nidentifiers = 0;
+};
+
+struct rts_entry
+{
+    std::vector<callpath_element> cp;
+    std::uint64_t hash;
+    std::unordered_map<identifier_set, configuration_t> scenarios;
+    std::chrono::milliseconds exectime;
+};
+} // namespace
+
+void binary_model::write(const tuning_model &tm, std::ostream &os)
+{
+    /* all rts of the model, including the ones of a binary model tm is based on */
+    std::vector<rts_entry> rtss;
+    tm.for_each_rts([&rtss](const std::vector<callpath_element> &cp,
+                        const std::unordered_map<identifier_set, configuration_t> &scenarios,
+                        std::chrono::milliseconds exectime) {
+        rtss.push_back({cp, std::hash<std::vector<callpath_element>>{}(cp), scenarios, exectime});
+    });
+    std::sort(rtss.begin(), rtss.end(), [](const rts_entry &a, const rts_entry &b) {
+        return a.hash < b.hash;
+    });
+
+    /* regions, sorted by their hash */
+    std::unordered_map<region_id, region_info> region_infos;
+    for (const auto &region : tm.regions_)
+        region_infos[region.second].flags |= binary::in_model;
+    for (const auto &nid : tm.nidentifiers_)
+    {
+        region_infos[nid.first].flags |= binary::has_nidentifiers;
+        region_infos[nid.first].nidentifiers = static_cast<std::uint32_t>(nid.second);
+    }
+    if (tm.binary_)
+    {
+        auto regions = tm.binary_->section<binary::region_record>(binary::regions);
+        for (std::size_t n = 0; n < tm.binary_->section_size(binary::regions); n++)
+        {
+            auto &info = region_infos[tm.binary_->decode_region(n)];
+            info.flags |= regions[n].flags;
+            if (regions[n].flags & binary::has_nidentifiers)
+                info.nidentifiers = regions[n].nidentifiers;
+        }
+    }
+    for (const auto &rts : rtss)
+        for (const auto &cpe : rts.cp)
+            region_infos[cpe.region_id()];
+
+    std::vector<std::pair<std::uint64_t, const region_id *>> sorted_regions;
+    for (const auto &info : region_infos)
+        sorted_regions.emplace_back(std::hash<region_id>{}(info.first), &info.first);
+    std::sort(sorted_regions.begin(), sorted_regions.end(),
+        [](const std::pair<std::uint64_t, const region_id *> &a,
+            const std::pair<std::uint64_t, const region_id *> &b) { return a.first < b.first; });
+
+    binary_writer writer;
+    std::unordered_map<region_id, std::uint64_t> region_index;
+    for (const auto &region : sorted_regions)
+    {
+        const auto &info = region_infos[*region.second];
+        region_index.emplace(*region.second, writer.regions.size());
+        writer.regions.push_back({region.first,
+            writer.add_string(region.second->file.str()),
+            writer.add_string(region.second->name.str()),
+            region.second->line,
+            info.flags,
+            info.nidentifiers});
+    }
+
+    /* callpaths with their scenarios */
+    for (const auto &rts : rtss)
+    {
+        binary::callpath_record record{rts.hash,
+            writer.elements.size(),
+            rts.cp.size(),
+            rts.exectime.count(),
+            writer.scenarios.size(),
+            rts.scenarios.size()};
+        for (const auto &cpe : rts.cp)
+            writer.elements.push_back(
+                {region_index.at(cpe.region_id()), writer.add_id_set(cpe.ids())});
+        for (const auto &scenario : rts.scenarios)
+        {
+            writer.scenarios.push_back({writer.add_id_set(scenario.first),
+                writer.parameters.size(),
+                scenario.second.size()});
+            for (const auto &parameter : scenario.second)
+                writer.parameters.push_back({parameter.first, parameter.second});
+        }
+        writer.callpaths.push_back(record);
+    }
+
+    for (const auto &cluster : tm.clusters_)
+    {
+        writer.clusters.push_back({cluster.first,
+            writer.phases.size(),
+            cluster.second.first.size(),
+            writer.ranges.size(),
+            cluster.second.second.size()});
+        for (auto phase : cluster.second.first)
+            writer.phases.push_back(phase);
+        for (const auto &range : cluster.second.second)
+            writer.ranges.push_back(
+                {writer.add_string(range.first), range.second.first, range.second.second});
+    }
+
+    /* all callpaths start with the same root, see tuning_model::deserialize */
+    auto root = writer.callpaths.empty() || writer.callpaths.front().nelements == 0 ?
+                    binary::no_index :
+                    writer.callpaths.front().first_element;
+    writer.write(os, root);
+}
+} // namespace tmm
+} // namespace rrl
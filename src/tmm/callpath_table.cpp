@@ -0,0 +1,40 @@
+#include <tmm/callpath_table.hpp>
+
+namespace rrl
+{
+namespace tmm
+{
+/** Computes the 64 bit hash of a callpath, see std::hash<std::vector<simple_callpath_element>>.
+ *
+ * @param callpath callpath to hash
+ * @return hash of the callpath
+ */
+std::uint64_t callpath_table::hash_callpath(const std::vector<simple_callpath_element> &callpath)
+{
+    return std::hash<std::vector<simple_callpath_element>>{}(callpath);
+}
+
+/** Returns the id of callpath. If the callpath is not in the table yet, it is added.
+ *
+ * @param callpath callpath to intern
+ * @return id of the callpath
+ */
+callpath_id callpath_table::intern(const std::vector<simple_callpath_element> &callpath)
+{
+    auto hash = hash_callpath(callpath);
+    auto range = index_.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it)
+    {
+        if (entries_[it->second].callpath == callpath)
+        {
+            return it->second;
+        }
+    }
+
+    auto id = static_cast<callpath_id>(entries_.size());
+    entries_.push_back({callpath, hash});
+    index_.emplace(hash, id);
+    return id;
+}
+} // namespace tmm
+} // namespace rrl
@@ -0,0 +1,92 @@
+#include <tmm/callpath_trie.hpp>
+
+#include <algorithm>
+
+namespace rrl
+{
+namespace tmm
+{
+constexpr std::size_t callpath_trie::npos;
+
+callpath_trie::callpath_trie()
+{
+    clear();
+}
+
+/** Returns the node of callpath. Missing nodes on the way are created without a value.
+ *
+ * @param callpath callpath to insert
+ * @return node of the callpath
+ */
+callpath_trie::node *callpath_trie::insert(const std::vector<callpath_element> &callpath)
+{
+    auto current = &nodes_.front();
+    for (const auto &element : callpath)
+    {
+        auto it = current->children.find(element);
+        if (it == current->children.end())
+        {
+            nodes_.emplace_back(current, element, current->depth + 1);
+            it = current->children.emplace(element, &nodes_.back()).first;
+        }
+        current = it->second;
+    }
+    return current;
+}
+
+/** Returns the node of callpath, or nullptr if the trie has no such node.
+ *
+ * The node might exist as prefix of a longer callpath only, so check has_value() as well.
+ */
+const callpath_trie::node *callpath_trie::find(const std::vector<callpath_element> &callpath) const
+{
+    auto current = &root();
+    for (const auto &element : callpath)
+    {
+        current = child(*current, element);
+        if (current == nullptr)
+            return nullptr;
+    }
+    return current;
+}
+
+/** Returns the deepest node with a value on the way to callpath, i.e. the longest prefix of
+ * callpath which has a value, including callpath itself. Returns nullptr if no prefix has a value.
+ */
+const callpath_trie::node *callpath_trie::longest_prefix(
+    const std::vector<callpath_element> &callpath) const
+{
+    const node *result = nullptr;
+    auto current = &root();
+    for (const auto &element : callpath)
+    {
+        current = child(*current, element);
+        if (current == nullptr)
+            break;
+        if (current->has_value())
+            result = current;
+    }
+    return result;
+}
+
+/** rebuilds the callpath of n
+ */
+std::vector<callpath_element> callpath_trie::path(const node &n) const
+{
+    std::vector<callpath_element> callpath;
+    callpath.reserve(n.depth);
+    for (auto current = &n; current->parent != nullptr; current = current->parent)
+        callpath.push_back(current->element);
+    std::reverse(callpath.begin(), callpath.end());
+    return callpath;
+}
+
+/** removes all nodes except a new root
+ */
+void callpath_trie::clear()
+{
+    nodes_.clear();
+    nodes_.emplace_back(nullptr, callpath_element(region_id(), identifier_set()), 0);
+}
+} // namespace tmm
+} // namespace rrl
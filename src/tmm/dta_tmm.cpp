@@ -14,6 +14,7 @@
 #include <util/log.hpp>
 
 #include <algorithm>
+#include <cmath>
 #include <fstream>
 #include <string>
 
@@ -63,6 +64,47 @@ dta_tmm::dta_tmm() : tuning_model_manager()
     {
         cal_type = none;
     }
+
+    auto journal_pattern = environment::get("TMM_JOURNAL", "");
+    if (!journal_pattern.empty())
+    {
+        auto journal_path = tmm::journal_path(journal_pattern);
+        try
+        {
+            /* later entries of a callpath replace earlier ones */
+            std::unordered_map<std::vector<callpath_element>, std::size_t> latest;
+            read_journal(journal_path, [this, &latest](journal_entry &&entry) {
+                if (entry.callpath.empty())
+                    return;
+                auto it = latest.find(entry.callpath);
+                if (it != latest.end())
+                {
+                    resumed_[it->second] = std::move(entry);
+                    return;
+                }
+                latest.emplace(entry.callpath, resumed_.size());
+                resumed_.push_back(std::move(entry));
+            });
+            for (std::size_t index = 0; index < resumed_.size(); index++)
+            {
+                for (const auto &cpe : resumed_[index].callpath)
+                {
+                    auto &indices = resumed_by_region_[cpe.region_id()];
+                    if (indices.empty() || indices.back() != index)
+                        indices.push_back(index);
+                }
+            }
+            logging::info("DTA_TMM") << "resuming " << resumed_.size()
+                                     << " configurations of journal: " << journal_path;
+
+            journal_ = std::make_unique<journal_writer>(journal_path,
+                std::stoul(environment::get("TMM_JOURNAL_SYNC", "32")));
+        }
+        catch (std::exception &e)
+        {
+            logging::error("DTA_TMM") << "cannot use journal: " << e.what();
+        }
+    }
 }
 
 dta_tmm::~dta_tmm()
@@ -75,6 +117,54 @@ void dta_tmm::register_region(const std::string &region_name,
 {
     reg_name_reg_id_map.emplace(region_name, scorep_id);
     reg_id_reg_name_map.emplace(scorep_id, region_name);
+
+    auto rid = region_id(file_name, line_number, region_name);
+    regions_.emplace(scorep_id, rid);
+    scorep_ids_.emplace(rid, scorep_id);
+    resume(rid);
+}
+
+/** stores the configurations of the journal of a previous run, whose regions are all registered
+ * after rid is registered
+ */
+void dta_tmm::resume(const region_id &rid)
+{
+    auto it = resumed_by_region_.find(rid);
+    if (it == resumed_by_region_.end())
+    {
+        return;
+    }
+
+    for (auto index : it->second)
+    {
+        auto &entry = resumed_[index];
+        if (entry.callpath.empty())
+        {
+            continue;
+        }
+
+        std::vector<simple_callpath_element> callpath;
+        for (const auto &cpe : entry.callpath)
+        {
+            auto id = scorep_ids_.find(cpe.region_id());
+            if (id == scorep_ids_.end())
+            {
+                break;
+            }
+            callpath.emplace_back(id->second, cpe.ids());
+        }
+        /* the entry is visited again when its missing region is registered */
+        if (callpath.size() != entry.callpath.size())
+        {
+            continue;
+        }
+
+        logging::trace("DTA_TMM") << "--- resumed config for: \n" << callpath << "---";
+        insert_configuration(callpath, entry.configuration);
+        entry.callpath.clear();
+        entry.configuration.clear();
+    }
+    resumed_by_region_.erase(it);
 }
 
 region_status dta_tmm::is_significant(std::uint32_t region_id)
@@ -100,13 +190,68 @@ size_t dta_tmm::get_region_identifiers(std::uint32_t region_id)
         return it->second;
     }
 }
-/** small basic implementation
+/** small basic implementation, the configuration is appended to the journal as well
  */
 void dta_tmm::store_configuration(const std::vector<simple_callpath_element> &callpath,
     const std::vector<parameter_tuple> &configuration,
     std::chrono::milliseconds exectime)
 {
     logging::trace("DTA_TMM") << "--- got store config for: \n" << callpath << "---";
+    insert_configuration(callpath, configuration);
+    append_journal(callpath, exectime, std::nan(""));
+}
+
+void dta_tmm::store_configuration(callpath_id callpath,
+    const std::vector<parameter_tuple> &configuration,
+    std::chrono::milliseconds exectime,
+    double energy)
+{
+    const auto &cp = callpaths_.callpath(callpath);
+    logging::trace("DTA_TMM") << "--- got store config for: \n" << cp << "---";
+    insert_configuration(cp, configuration);
+    append_journal(cp, exectime, energy);
+}
+
+/** appends the configuration of callpath to the journal, if there is one
+ */
+void dta_tmm::append_journal(const std::vector<simple_callpath_element> &callpath,
+    std::chrono::milliseconds exectime,
+    double energy)
+{
+    if (!journal_)
+    {
+        return;
+    }
+    std::vector<callpath_element> cp;
+    cp.reserve(callpath.size());
+    for (const auto &cpe : callpath)
+    {
+        auto rid = regions_.find(cpe.region_id);
+        if (rid == regions_.end())
+        {
+            logging::warn("DTA_TMM") << "cannot journal callpath with unknown region \""
+                                     << cpe.region_id << "\"";
+            return;
+        }
+        cp.emplace_back(rid->second, cpe.id_set);
+    }
+    try
+    {
+        /* the merged configuration, so a replay does not need to merge */
+        journal_->append(cp, configurations_[callpath], exectime, energy);
+    }
+    catch (std::runtime_error &e)
+    {
+        logging::error("DTA_TMM") << e.what() << ". Journaling is stopped.";
+        journal_.reset();
+    }
+}
+
+/** merges the configuration into the configuration of callpath
+ */
+void dta_tmm::insert_configuration(const std::vector<simple_callpath_element> &callpath,
+    const std::vector<parameter_tuple> &configuration)
+{
     /* ok, lets look if we already have this callpath somewhere.
      * If yes, we just need to overwrite the config for this entry,
      * */
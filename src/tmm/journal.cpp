@@ -0,0 +1,383 @@
+#include <tmm/binary_model.hpp>
+#include <tmm/journal.hpp>
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace rrl
+{
+namespace tmm
+{
+namespace
+{
+/** FNV-1a, detects records that were not written completely */
+std::uint64_t checksum(const char *data, std::size_t size) noexcept
+{
+    std::uint64_t hash = 0xcbf29ce484222325ull;
+    for (std::size_t i = 0; i < size; i++)
+    {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+template <typename T> void put(std::string &buffer, T value)
+{
+    buffer.append(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+void put(std::string &buffer, const std::string &value)
+{
+    put(buffer, static_cast<std::uint32_t>(value.size()));
+    buffer.append(value);
+}
+
+/** decodes a payload, every get() fails once the end of the payload is reached */
+class decoder
+{
+public:
+    decoder(const char *data, std::size_t size) : current_(data), end_(data + size)
+    {
+    }
+
+    template <typename T> bool get(T &value) noexcept
+    {
+        if (static_cast<std::size_t>(end_ - current_) < sizeof(T))
+            return false;
+        std::memcpy(&value, current_, sizeof(T));
+        current_ += sizeof(T);
+        return true;
+    }
+
+    bool get(std::string &value)
+    {
+        std::uint32_t size;
+        if (!get(size) || static_cast<std::size_t>(end_ - current_) < size)
+            return false;
+        value.assign(current_, size);
+        current_ += size;
+        return true;
+    }
+
+    bool at_end() const noexcept
+    {
+        return current_ == end_;
+    }
+
+private:
+    const char *current_;
+    const char *end_;
+};
+
+void encode(std::string &buffer,
+    const std::vector<callpath_element> &callpath,
+    const std::vector<parameter_tuple> &configuration,
+    std::chrono::milliseconds exectime,
+    double energy)
+{
+    put(buffer, static_cast<std::int64_t>(exectime.count()));
+    put(buffer, energy);
+    put(buffer, static_cast<std::uint32_t>(callpath.size()));
+    for (const auto &cpe : callpath)
+    {
+        const auto &rid = cpe.region_id();
+        const auto &ids = cpe.ids();
+        put(buffer, rid.file.str());
+        put(buffer, static_cast<std::uint64_t>(rid.line));
+        put(buffer, rid.name.str());
+        put(buffer, static_cast<std::uint32_t>(ids.uints.size()));
+        for (const auto &id : ids.uints)
+        {
+            put(buffer, static_cast<std::uint64_t>(id.id));
+            put(buffer, id.value);
+        }
+        put(buffer, static_cast<std::uint32_t>(ids.ints.size()));
+        for (const auto &id : ids.ints)
+        {
+            put(buffer, static_cast<std::uint64_t>(id.id));
+            put(buffer, id.value);
+        }
+        put(buffer, static_cast<std::uint32_t>(ids.strings.size()));
+        for (const auto &id : ids.strings)
+        {
+            put(buffer, static_cast<std::uint64_t>(id.id));
+            put(buffer, id.value);
+        }
+    }
+    put(buffer, static_cast<std::uint32_t>(configuration.size()));
+    for (const auto &pt : configuration)
+    {
+        put(buffer, static_cast<std::uint64_t>(pt.parameter_id));
+        put(buffer, static_cast<std::int32_t>(pt.parameter_value));
+    }
+}
+
+template <typename T> bool decode(decoder &d, std::vector<identifier<T>> &ids)
+{
+    std::uint32_t count;
+    if (!d.get(count))
+        return false;
+    for (std::uint32_t n = 0; n < count; n++)
+    {
+        std::uint64_t id;
+        T value;
+        if (!d.get(id) || !d.get(value))
+            return false;
+        ids.emplace_back(static_cast<std::size_t>(id), value);
+    }
+    return true;
+}
+
+bool decode(decoder &d, journal_entry &entry)
+{
+    std::int64_t exectime;
+    std::uint32_t count;
+    if (!d.get(exectime) || !d.get(entry.energy) || !d.get(count))
+        return false;
+    entry.exectime = std::chrono::milliseconds(exectime);
+    for (std::uint32_t n = 0; n < count; n++)
+    {
+        std::string file;
+        std::uint64_t line;
+        std::string name;
+        identifier_set ids;
+        if (!d.get(file) || !d.get(line) || !d.get(name) || !decode(d, ids.uints) ||
+            !decode(d, ids.ints) || !decode(d, ids.strings))
+            return false;
+        entry.callpath.emplace_back(region_id(file, static_cast<std::size_t>(line), name), ids);
+    }
+    if (!d.get(count))
+        return false;
+    for (std::uint32_t n = 0; n < count; n++)
+    {
+        std::uint64_t id;
+        std::int32_t value;
+        if (!d.get(id) || !d.get(value))
+            return false;
+        entry.configuration.emplace_back(static_cast<std::size_t>(id), value);
+    }
+    return d.at_end();
+}
+
+void check_header(const journal::header &header, const std::string &file_path)
+{
+    if (std::memcmp(header.magic, journal::magic, sizeof(journal::magic)) != 0)
+        throw std::runtime_error("Not a tuning model journal: " + file_path);
+    if (header.version != journal::version || header.byte_order != journal::byte_order)
+        throw std::runtime_error("Unsupported version or byte order of the journal: " + file_path);
+    if (header.hash_fingerprint != binary_model::hash_fingerprint())
+        throw std::runtime_error(
+            "The journal was written with different hash functions: " + file_path);
+}
+
+/** rank of the process, as set by the common MPI launchers and Slurm, empty if unknown */
+std::string launcher_rank()
+{
+    for (auto name : {"OMPI_COMM_WORLD_RANK", "PMI_RANK", "PMIX_RANK", "SLURM_PROCID"})
+    {
+        auto value = std::getenv(name);
+        if (value != nullptr && *value != '\0')
+            return value;
+    }
+    return "";
+}
+} // namespace
+
+std::string journal_path(const std::string &pattern)
+{
+    auto rank = launcher_rank();
+    auto pid = std::to_string(getpid());
+
+    std::string path;
+    bool expanded = false;
+    for (std::size_t i = 0; i < pattern.size(); i++)
+    {
+        if (pattern[i] != '%' || i + 1 == pattern.size())
+        {
+            path += pattern[i];
+            continue;
+        }
+        switch (pattern[++i])
+        {
+        case 'r':
+            path += rank.empty() ? pid : rank;
+            expanded = true;
+            break;
+        case 'p':
+            path += pid;
+            expanded = true;
+            break;
+        case '%':
+            path += '%';
+            break;
+        default:
+            path += '%';
+            path += pattern[i];
+        }
+    }
+    if (!expanded && !rank.empty())
+        path += "." + rank;
+    return path;
+}
+
+journal_writer::journal_writer(const std::string &file_path, std::size_t sync_interval)
+    : sync_interval_(sync_interval)
+{
+    auto valid = read_journal(file_path, [](journal_entry &&) {});
+
+    fd_ = open(file_path.c_str(), O_WRONLY | O_CREAT, 0644);
+    if (fd_ < 0)
+        throw std::runtime_error(
+            "Cannot open journal: " + file_path + ": " + std::strerror(errno));
+
+    /* drop an incomplete record, so the new records can be read */
+    if (ftruncate(fd_, static_cast<off_t>(valid)) != 0 ||
+        lseek(fd_, static_cast<off_t>(valid), SEEK_SET) < 0)
+    {
+        close(fd_);
+        throw std::runtime_error(
+            "Cannot truncate journal: " + file_path + ": " + std::strerror(errno));
+    }
+
+    if (valid == 0)
+    {
+        journal::header header;
+        std::memcpy(header.magic, journal::magic, sizeof(journal::magic));
+        header.version = journal::version;
+        header.byte_order = journal::byte_order;
+        header.hash_fingerprint = binary_model::hash_fingerprint();
+        if (write(fd_, &header, sizeof(header)) != sizeof(header))
+        {
+            close(fd_);
+            throw std::runtime_error("Cannot write journal: " + file_path);
+        }
+    }
+}
+
+journal_writer::~journal_writer()
+{
+    sync();
+    close(fd_);
+}
+
+void journal_writer::append(const std::vector<callpath_element> &callpath,
+    const std::vector<parameter_tuple> &configuration,
+    std::chrono::milliseconds exectime,
+    double energy)
+{
+    /* size and checksum are filled in once the payload is encoded */
+    constexpr std::size_t prefix = sizeof(std::uint32_t) + sizeof(std::uint64_t);
+    buffer_.assign(prefix, '\0');
+    encode(buffer_, callpath, configuration, exectime, energy);
+
+    auto size = static_cast<std::uint32_t>(buffer_.size() - prefix);
+    auto sum = checksum(buffer_.data() + prefix, size);
+    std::memcpy(&buffer_[0], &size, sizeof(size));
+    std::memcpy(&buffer_[sizeof(size)], &sum, sizeof(sum));
+
+    const char *data = buffer_.data();
+    auto remaining = buffer_.size();
+    while (remaining > 0)
+    {
+        auto written = write(fd_, data, remaining);
+        if (written < 0 && errno == EINTR)
+            continue;
+        if (written <= 0)
+            throw std::runtime_error(std::string("Cannot write journal: ") + std::strerror(errno));
+        data += written;
+        remaining -= static_cast<std::size_t>(written);
+    }
+
+    if (++unsynced_ >= sync_interval_)
+        sync();
+}
+
+/** writes the journal to the disk */
+void journal_writer::sync() noexcept
+{
+    if (unsynced_ > 0)
+    {
+        fdatasync(fd_);
+        unsynced_ = 0;
+    }
+}
+
+bool is_journal(const std::string &file_path)
+{
+    std::ifstream is(file_path, std::ios::binary);
+    char magic[sizeof(journal::magic)];
+    if (!is.read(magic, sizeof(magic)))
+        return false;
+    return std::memcmp(magic, journal::magic, sizeof(magic)) == 0;
+}
+
+std::uint64_t read_journal(
+    const std::string &file_path, const std::function<void(journal_entry &&)> &f)
+{
+    std::ifstream is(file_path, std::ios::binary);
+    if (!is.is_open())
+    {
+        struct stat st;
+        if (stat(file_path.c_str(), &st) != 0 && errno == ENOENT)
+            return 0;
+        throw std::runtime_error("Cannot open journal: " + file_path);
+    }
+
+    journal::header header;
+    if (!is.read(reinterpret_cast<char *>(&header), sizeof(header)))
+    {
+        if (is.gcount() == 0)
+            return 0;
+        throw std::runtime_error("Not a tuning model journal: " + file_path);
+    }
+    check_header(header, file_path);
+
+    is.seekg(0, std::ios::end);
+    std::uint64_t file_size = is.tellg();
+    is.seekg(sizeof(header));
+
+    std::uint64_t valid = sizeof(header);
+    std::vector<char> payload;
+    while (true)
+    {
+        std::uint32_t size;
+        std::uint64_t sum;
+        if (!is.read(reinterpret_cast<char *>(&size), sizeof(size)) ||
+            !is.read(reinterpret_cast<char *>(&sum), sizeof(sum)))
+            break;
+        /* the size of an incomplete record might be garbage */
+        if (size > file_size - valid - sizeof(size) - sizeof(sum))
+            break;
+        payload.resize(size);
+        if (!is.read(payload.data(), size) || checksum(payload.data(), size) != sum)
+            break;
+
+        journal_entry entry;
+        decoder d(payload.data(), size);
+        if (!decode(d, entry))
+            break;
+        f(std::move(entry));
+        valid += sizeof(size) + sizeof(sum) + size;
+    }
+    return valid;
+}
+
+std::size_t replay_journal(const std::string &file_path, tuning_model &tm)
+{
+    std::size_t count = 0;
+    read_journal(file_path, [&tm, &count](journal_entry &&entry) {
+        tm.store_configuration(entry.callpath, entry.configuration, entry.exectime);
+        count++;
+    });
+    return count;
+}
+} // namespace tmm
+} // namespace rrl
@@ -0,0 +1,131 @@
+#include <tmm/journal.hpp>
+#include <tmm/model_distribution.hpp>
+
+#include <util/log.hpp>
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace rrl
+{
+namespace tmm
+{
+/** reads the tuning model, and returns it in the binary format
+ */
+static std::string read_binary_model(const std::string &file_path)
+{
+    if (binary_model::is_binary(file_path))
+    {
+        std::ifstream is(file_path, std::ios::binary);
+        std::ostringstream os;
+        os << is.rdbuf();
+        if (!is.good() && !is.eof())
+            throw std::runtime_error("Cannot read tuning model: " + file_path);
+        return os.str();
+    }
+
+    tuning_model tm;
+    if (is_journal(file_path))
+    {
+        replay_journal(file_path, tm);
+    }
+    else
+    {
+        std::ifstream is(file_path);
+        if (is.fail())
+            throw std::runtime_error("Cannot open tuning model: " + file_path);
+        tm.deserialize(is);
+    }
+
+    std::ostringstream os;
+    binary_model::write(tm, os);
+    return os.str();
+}
+
+std::shared_ptr<const binary_model> distribute_tuning_model(
+    const std::string &file_path, MPI_Comm comm)
+{
+    int rank;
+    PMPI_Comm_rank(comm, &rank);
+
+    /* rank 0 reads the model, the other ranks just learn its size */
+    std::string model;
+    std::string error;
+    std::uint64_t size = 0;
+    if (rank == 0)
+    {
+        try
+        {
+            model = read_binary_model(file_path);
+            size = model.size();
+        }
+        catch (std::exception &e)
+        {
+            error = e.what();
+        }
+    }
+    PMPI_Bcast(&size, 1, MPI_UINT64_T, 0, comm);
+    if (size == 0)
+    {
+        throw std::runtime_error(
+            rank == 0 ? error : "Rank 0 cannot read the tuning model: " + file_path);
+    }
+
+    /* the ranks of a node share one copy, the node leaders receive it */
+    MPI_Comm node_comm;
+    PMPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL, &node_comm);
+    int node_rank;
+    PMPI_Comm_rank(node_comm, &node_rank);
+
+    MPI_Comm leader_comm;
+    PMPI_Comm_split(comm, node_rank == 0 ? 0 : MPI_UNDEFINED, rank, &leader_comm);
+
+    char *base = nullptr;
+    MPI_Win win;
+    auto local_size = static_cast<MPI_Aint>(node_rank == 0 ? size : 0);
+    PMPI_Win_allocate_shared(local_size, 1, MPI_INFO_NULL, node_comm, &base, &win);
+    if (node_rank != 0)
+    {
+        MPI_Aint leader_size;
+        int disp_unit;
+        PMPI_Win_shared_query(win, 0, &leader_size, &disp_unit, &base);
+    }
+
+    if (leader_comm != MPI_COMM_NULL)
+    {
+        if (rank == 0)
+        {
+            std::memcpy(base, model.data(), size);
+            std::string().swap(model);
+        }
+        /* the count of MPI_Bcast is an int */
+        for (std::uint64_t offset = 0; offset < size; offset += INT_MAX)
+        {
+            auto count = static_cast<int>(std::min<std::uint64_t>(size - offset, INT_MAX));
+            PMPI_Bcast(base + offset, count, MPI_CHAR, 0, leader_comm);
+        }
+        PMPI_Comm_free(&leader_comm);
+    }
+    /* makes the data of the node leader visible to the other ranks of the node */
+    PMPI_Win_fence(0, win);
+    PMPI_Comm_free(&node_comm);
+
+    logging::debug("TMM") << "received tuning model with " << size << " bytes";
+
+    /* MPI_Win_free is collective and not allowed after MPI_Finalize. The RRL is finalised after
+     * MPI, in this case the window is released with the process. */
+    std::shared_ptr<const char> data(base, [win](const char *) mutable {
+        int finalized = 0;
+        PMPI_Finalized(&finalized);
+        if (!finalized)
+            PMPI_Win_free(&win);
+    });
+    return std::make_shared<const binary_model>(std::move(data), size);
+}
+} // namespace tmm
+} // namespace rrl
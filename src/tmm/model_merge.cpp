@@ -0,0 +1,140 @@
+#include <tmm/binary_model.hpp>
+#include <tmm/journal.hpp>
+#include <tmm/model_merge.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <stdexcept>
+
+namespace rrl
+{
+namespace tmm
+{
+void model_merger::add_file(const std::string &file_path, std::size_t index)
+{
+    if (is_journal(file_path))
+    {
+        std::unordered_map<callpath, journal_entry> last;
+        read_journal(file_path, [&last](journal_entry &&entry) {
+            auto cp = entry.callpath;
+            last[std::move(cp)] = std::move(entry);
+        });
+        for (auto &entry : last)
+        {
+            configuration_t config;
+            for (const auto &pt : entry.second.configuration)
+                config[pt.parameter_id] = pt.parameter_value;
+            add(entry.first,
+                identifier_set(),
+                {std::move(config), entry.second.exectime, entry.second.energy, index, false});
+        }
+        return;
+    }
+
+    tuning_model tm;
+    if (binary_model::is_binary(file_path))
+    {
+        tm.load_binary(binary_model::map(file_path));
+    }
+    else
+    {
+        std::ifstream is(file_path);
+        if (!is.is_open())
+            throw std::runtime_error("Cannot open tuning model: " + file_path);
+        tm.deserialize(is, true);
+    }
+
+    tm.for_each_rts([this, index](const callpath &cp,
+                        const std::unordered_map<identifier_set, configuration_t> &scenarios,
+                        std::chrono::milliseconds exectime) {
+        for (const auto &scenario : scenarios)
+            add(cp, scenario.first, {scenario.second, exectime, std::nan(""), index, false});
+    });
+    for (const auto &cluster : tm.clusters())
+        add_cluster(cluster.first, cluster.second, index);
+}
+
+void model_merger::merge(model_merger &&other)
+{
+    for (auto &rts : other.rtss_)
+        for (auto &scenario : rts.second)
+            add(rts.first, scenario.first, std::move(scenario.second));
+    for (auto &cluster : other.clusters_)
+        add_cluster(cluster.first, cluster.second.second, cluster.second.first);
+    other.rtss_.clear();
+    other.clusters_.clear();
+}
+
+void model_merger::store(tuning_model &tm) const
+{
+    for (const auto &rts : rtss_)
+    {
+        auto exectime = std::chrono::milliseconds(0);
+        for (const auto &scenario : rts.second)
+            exectime = std::max(exectime, scenario.second.exectime);
+        for (const auto &scenario : rts.second)
+            tm.store_scenario(rts.first, scenario.first, scenario.second.configuration, exectime);
+    }
+    for (const auto &cluster : clusters_)
+        tm.add_cluster(cluster.first, cluster.second.second);
+}
+
+std::size_t model_merger::nconflicts() const noexcept
+{
+    std::size_t n = 0;
+    for (const auto &rts : rtss_)
+        for (const auto &scenario : rts.second)
+            if (scenario.second.conflicting)
+                n++;
+    return n;
+}
+
+std::size_t model_merger::nscenarios() const noexcept
+{
+    std::size_t n = 0;
+    for (const auto &rts : rtss_)
+        n += rts.second.size();
+    return n;
+}
+
+/** checks if a wins over b, this is a strict total order for candidates of different inputs
+ */
+bool model_merger::is_better(const candidate &a, const candidate &b) noexcept
+{
+    bool a_measured = !std::isnan(a.energy);
+    bool b_measured = !std::isnan(b.energy);
+    if (a_measured != b_measured)
+        return a_measured;
+    if (a_measured && a.energy != b.energy)
+        return a.energy < b.energy;
+    if (a.exectime != b.exectime)
+        return a.exectime < b.exectime;
+    return a.index < b.index;
+}
+
+void model_merger::add(const callpath &cp, const identifier_set &ids, candidate &&c)
+{
+    auto &scenarios = rtss_[cp];
+    auto existing = scenarios.find(ids);
+    if (existing == scenarios.end())
+    {
+        scenarios.emplace(ids, std::move(c));
+        return;
+    }
+
+    bool conflicting = existing->second.conflicting || c.conflicting ||
+                       existing->second.configuration != c.configuration;
+    if (is_better(c, existing->second))
+        existing->second = std::move(c);
+    existing->second.conflicting = conflicting;
+}
+
+void model_merger::add_cluster(int id, const phase_data_t &cluster, std::size_t index)
+{
+    auto existing = clusters_.find(id);
+    if (existing == clusters_.end() || index < existing->second.first)
+        clusters_[id] = std::make_pair(index, cluster);
+}
+} // namespace tmm
+} // namespace rrl
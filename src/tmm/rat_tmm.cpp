@@ -7,28 +7,143 @@
  *      Author: andreas
  */
 
+#include <tmm/binary_model.hpp>
+#include <tmm/journal.hpp>
+#include <tmm/model_distribution.hpp>
 #include <tmm/rat_tmm.hpp>
 
 #include <util/common.hpp>
+#include <util/environment.hpp>
 #include <util/log.hpp>
 
 #include <fstream>
+#include <stdexcept>
+
+#include <sys/stat.h>
 
 namespace rrl
 {
 namespace tmm
 {
+/** identifies a version of a file, a file that is replaced by rename() gets a new inode */
+struct rat_tmm::file_stamp
+{
+    file_stamp(const std::string &file_path)
+    {
+        struct stat st;
+        if (stat(file_path.c_str(), &st) == 0)
+        {
+            inode = st.st_ino;
+            size = st.st_size;
+            mtime_sec = st.st_mtim.tv_sec;
+            mtime_nsec = st.st_mtim.tv_nsec;
+        }
+    }
+
+    bool operator==(const file_stamp &other) const noexcept
+    {
+        return inode == other.inode && size == other.size && mtime_sec == other.mtime_sec &&
+               mtime_nsec == other.mtime_nsec;
+    }
+
+    ino_t inode = 0;
+    off_t size = 0;
+    time_t mtime_sec = 0;
+    long mtime_nsec = 0;
+};
+
 rat_tmm::~rat_tmm()
 {
+    if (watcher_.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(watch_lock_);
+            stop_watch_ = true;
+        }
+        watch_cv_.notify_all();
+        watcher_.join();
+    }
 }
 
-rat_tmm::rat_tmm(const std::string &file_path) : tuning_model_manager()
+rat_tmm::rat_tmm(const std::string &file_path)
+    : tuning_model_manager(),
+      tm_(std::make_unique<tuning_model>()),
+      file_path_(file_path),
+      reload_pending_(false)
 {
     RRL_DEBUG_ASSERT(!file_path.empty());
+    broadcast_ = environment::get("TMM_DISTRIBUTION", "file") == "broadcast";
+    prefix_fallback_ = environment::get("TMM_PREFIX_FALLBACK", "false") == "true";
+    try
+    {
+        input_fallback_ = parse_fallback_mode(environment::get("TMM_INPUT_FALLBACK", "none"));
+    }
+    catch (std::invalid_argument &e)
+    {
+        logging::warn("RAT_TMM") << e.what() << ", using none";
+    }
+    if (broadcast_)
+    {
+        logging::debug("RAT_TMM") << "tuning model is received in init_mpp: " << file_path;
+    }
+    else
+    {
+        load(file_path);
+    }
+
+    auto reload_mode = environment::get("TMM_RELOAD", "none");
+    if (reload_mode != "none" && broadcast_)
+    {
+        /* the ranks of a node share the broadcasted model, see reload() */
+        logging::warn("RAT_TMM") << "SCOREP_RRL_TMM_RELOAD is not supported with "
+                                    "SCOREP_RRL_TMM_DISTRIBUTION=broadcast, using none";
+    }
+    else if (reload_mode == "watch")
+    {
+        watch_interval_ =
+            std::chrono::milliseconds(std::stoi(environment::get("TMM_RELOAD_INTERVAL_MS", "1000")));
+        /* the file is compared to the version that is loaded now */
+        watcher_ = std::thread(&rat_tmm::watch, this, file_stamp(file_path));
+    }
+    else if (reload_mode != "none")
+    {
+        logging::warn("RAT_TMM") << "unknown SCOREP_RRL_TMM_RELOAD \"" << reload_mode
+                                 << "\", using none";
+    }
+}
+
+/** reads the tuning model from the file into tm, binary models are mapped to memory, JSON models
+ * are deserialized lazily, journals of a calibration run are replayed
+ */
+void rat_tmm::load(const std::string &file_path, tuning_model &tm)
+{
+    if (binary_model::is_binary(file_path))
+    {
+        logging::debug("RAT_TMM") << "mapping binary tuning model: " << file_path;
+        tm.load_binary(binary_model::map(file_path));
+        return;
+    }
+    if (is_journal(file_path))
+    {
+        tm.clear();
+        auto entries = replay_journal(file_path, tm);
+        logging::debug("RAT_TMM") << "replayed " << entries << " entries of journal: " << file_path;
+        return;
+    }
+
     std::ifstream is(file_path);
     if (is.fail())
         throw std::runtime_error("Cannot open tuning model: " + file_path);
-    tm_.deserialize(is);
+    /* most processes visit only a part of the model, so scenarios are decoded on request */
+    tm.deserialize(is, true);
+}
+
+void rat_tmm::load(const std::string &file_path)
+{
+    trie_nodes_.clear();
+    is_resolved_.clear();
+    fallbacks_.clear();
+    load(file_path, *tm_);
 }
 
 void rat_tmm::register_region(const std::string &region_name,
@@ -37,36 +152,119 @@ void rat_tmm::register_region(const std::string &region_name,
     std::uint32_t scorep_id)
 {
     RRL_DEBUG_ASSERT(registered_regions_.find(scorep_id) == registered_regions_.end());
-    registered_regions_[scorep_id] = region_id(file_name, line_number, region_name);
+    auto rid = region_id(file_name, line_number, region_name);
+
+    /* significance doesn't change, so it is resolved once instead of for each unknown node */
+    if (scorep_id >= significance_.size())
+    {
+        significance_.resize(scorep_id + 1, insignificant);
+    }
+    significance_[scorep_id] = tm_->has_region(rid) ? significant : insignificant;
+
+    registered_regions_[scorep_id] = rid;
 }
 
 region_status rat_tmm::is_significant(std::uint32_t scorep_id)
 {
     RRL_DEBUG_ASSERT(registered_regions_.find(scorep_id) != registered_regions_.end());
 
-    if (tm_.has_region(registered_regions_[scorep_id]))
-        return significant;
+    if (scorep_id < significance_.size())
+        return significance_[scorep_id];
 
     return insignificant;
 }
 
 size_t rat_tmm::get_region_identifiers(std::uint32_t scorep_id)
 {
-    return tm_.nidentifiers(registered_regions_[scorep_id]);
+    return tm_->nidentifiers(registered_regions_[scorep_id]);
 }
 
-void rat_tmm::store_configuration(const std::vector<simple_callpath_element> &callpath,
-    const std::vector<parameter_tuple> &configuration,
-    std::chrono::milliseconds exectime)
+/** translates the Score-P region ids of a callpath to the region_id's of the tuning model
+ */
+std::vector<callpath_element> rat_tmm::convert(const std::vector<simple_callpath_element> &callpath)
 {
     std::vector<callpath_element> cp;
+    cp.reserve(callpath.size());
     for (const auto &cpe : callpath)
     {
         const auto &rid = registered_regions_[cpe.region_id];
         cp.push_back(callpath_element(rid, cpe.id_set));
     }
+    return cp;
+}
 
-    tm_.store_configuration(cp, configuration, exectime);
+/** translates an interned callpath, the result is cached for later calls
+ */
+const std::vector<callpath_element> &rat_tmm::convert(callpath_id callpath)
+{
+    if (callpath >= is_converted_.size())
+    {
+        converted_callpaths_.resize(callpath + 1);
+        is_converted_.resize(callpath + 1, false);
+    }
+    if (!is_converted_[callpath])
+    {
+        converted_callpaths_[callpath] = convert(callpaths_.callpath(callpath));
+        is_converted_[callpath] = true;
+    }
+    return converted_callpaths_[callpath];
+}
+
+/** Returns the node of the tuning model trie for an interned callpath, or its longest prefix with
+ * an rts if prefix_fallback_ is set. The node is cached, so the callpath is looked up only once,
+ * even if it is not in the trie.
+ *
+ * Returns nullptr if the callpath is not in the trie. This is always the case for binary models.
+ */
+const callpath_trie::node *rat_tmm::find_node(callpath_id callpath)
+{
+    if (callpath >= trie_nodes_.size())
+    {
+        trie_nodes_.resize(callpath + 1, nullptr);
+        is_resolved_.resize(callpath + 1, false);
+    }
+    if (!is_resolved_[callpath])
+    {
+        const auto &cp = convert(callpath);
+        auto node = tm_->trie().find(cp);
+        if (prefix_fallback_ && (node == nullptr || !node->has_value()))
+        {
+            node = tm_->trie().longest_prefix(cp);
+            if (node != nullptr)
+                logging::debug("RAT_TMM") << "using rts of prefix with " << node->depth
+                                          << " of " << cp.size() << " elements";
+        }
+        trie_nodes_[callpath] = node;
+        is_resolved_[callpath] = true;
+    }
+    return trie_nodes_[callpath];
+}
+
+void rat_tmm::store_configuration(const std::vector<simple_callpath_element> &callpath,
+    const std::vector<parameter_tuple> &configuration,
+    std::chrono::milliseconds exectime)
+{
+    tm_->store_configuration(convert(callpath), configuration, exectime);
+    /* a prefix might be cached for the callpath, and the scenarios are replaced */
+    trie_nodes_.clear();
+    is_resolved_.clear();
+    fallbacks_.clear();
+}
+
+void rat_tmm::store_configuration(callpath_id callpath,
+    const std::vector<parameter_tuple> &configuration,
+    std::chrono::milliseconds exectime)
+{
+    tm_->store_configuration(convert(callpath), configuration, exectime);
+    if (prefix_fallback_)
+    {
+        /* descendants of the callpath might have cached a shorter prefix */
+        trie_nodes_.clear();
+        is_resolved_.clear();
+    }
+    else if (callpath < trie_nodes_.size())
+        is_resolved_[callpath] = false;
+    fallbacks_.clear();
 }
 
 const std::vector<parameter_tuple> rat_tmm::get_current_rts_configuration(
@@ -95,15 +293,27 @@ const std::vector<parameter_tuple> rat_tmm::get_current_rts_configuration(
             logging::trace("RAT_TMM") << "key:" << elem.first << " value: " << elem.second;
     }
 
-    std::vector<callpath_element> cp;
-    for (const auto &cpe : callpath)
-    {
-        const auto &rid = registered_regions_[cpe.region_id];
-        cp.push_back(callpath_element(rid, cpe.id_set));
-    }
+    return get_configuration(tm_->configurations(convert(callpath)), input_identifiers);
+}
+
+const std::vector<parameter_tuple> rat_tmm::get_current_rts_configuration(
+    callpath_id callpath, const std::unordered_map<std::string, std::string> &input_identifiers)
+{
+    auto node = find_node(callpath);
+    if (node != nullptr)
+        return get_configuration(tm_->configurations(*node), input_identifiers);
+    return get_configuration(tm_->configurations(convert(callpath)), input_identifiers);
+}
 
+/** Selects the configuration for the input identifiers from the scenarios of an rts. If there is
+ * no scenario for the input identifiers, input_fallback_ selects one. The scenario_fallback of an
+ * rts is built at its first miss.
+ */
+const std::vector<parameter_tuple> rat_tmm::get_configuration(
+    const std::unordered_map<identifier_set, configuration_t> *iptmap,
+    const std::unordered_map<std::string, std::string> &input_identifiers)
+{
     /* we don't have this callpath, nothing can be done */
-    auto iptmap = tm_.configurations(cp);
     if (!iptmap)
         return {};
 
@@ -135,7 +345,21 @@ const std::vector<parameter_tuple> rat_tmm::get_current_rts_configuration(
         return ptpl;
     }
 
-    return {};
+    if (input_fallback_ == fallback_mode::none)
+        return {};
+
+    auto &fallback = fallbacks_[iptmap];
+    if (!fallback)
+        fallback.reset(new scenario_fallback(input_fallback_, *iptmap, tm_->clusters()));
+
+    auto config = fallback->select(input_identifiers);
+    if (config == nullptr)
+        return {};
+
+    std::vector<parameter_tuple> ptpl;
+    for (const auto &tp : *config)
+        ptpl.push_back(parameter_tuple(tp.first, tp.second));
+    return ptpl;
 }
 
 void rat_tmm::clear_configurations() noexcept
@@ -149,7 +373,7 @@ bool rat_tmm::is_root(const simple_callpath_element &cpe) const noexcept
     if (it == registered_regions_.end())
         return false;
 
-    return tm_.is_root(callpath_element(it->second, cpe.id_set));
+    return tm_->is_root(callpath_element(it->second, cpe.id_set));
 }
 calibration_type rat_tmm::get_calibration_type() noexcept
 {
@@ -159,28 +383,193 @@ calibration_type rat_tmm::get_calibration_type() noexcept
 std::chrono::milliseconds rat_tmm::get_exectime(
     const std::vector<simple_callpath_element> &callpath) noexcept
 {
-    std::vector<callpath_element> cp;
-    for (const auto &cpe : callpath)
-    {
-        const auto &rid = registered_regions_[cpe.region_id];
-        cp.push_back(callpath_element(rid, cpe.id_set));
-    }
+    return tm_->exectime(convert(callpath));
+}
 
-    return tm_.exectime(cp);
+std::chrono::milliseconds rat_tmm::get_exectime(callpath_id callpath) noexcept
+{
+    auto node = find_node(callpath);
+    if (node != nullptr && node->has_value())
+        return tm_->exectime(*node);
+    return tm_->exectime(convert(callpath));
 }
 
 std::unordered_map<int, phase_data_t> rat_tmm::get_phase_data() noexcept
 {
-    return tm_.clusters();
+    return tm_->clusters();
 }
 
+/** Reports the tuning model received in init_mpp(), and a model read by reload(). This is called
+ * for each enter, so a reloaded model is only indicated by an atomic flag.
+ */
 bool rat_tmm::has_changed() noexcept
 {
-    return false;
+    return changed_ || reload_pending_.load(std::memory_order_relaxed);
+}
+
+void rat_tmm::set_changed(bool val) noexcept
+{
+    changed_ = val;
+}
+
+/** Swaps in the model read by reload(), if there is one. The model received by init_mpp()
+ * affects all nodes.
+ */
+tuning_model_change rat_tmm::take_change()
+{
+    std::unique_ptr<tuning_model> model;
+    {
+        std::lock_guard<std::mutex> lock(pending_lock_);
+        model = std::move(pending_);
+        reload_pending_ = false;
+    }
+
+    tuning_model_change change;
+    if (model)
+    {
+        change = swap_model(std::move(model));
+    }
+    if (changed_)
+    {
+        change = tuning_model_change();
+        changed_ = false;
+    }
+    return change;
+}
+
+/** Reads a new tuning model. This is refused for a broadcasted model: it is shared by the ranks of
+ * a node, and releasing it is collective, which would block the rank that swaps in a new model
+ * until all ranks of its node did so.
+ */
+void rat_tmm::reload(const std::string &file_path)
+{
+    if (broadcast_)
+    {
+        throw std::runtime_error(
+            "A tuning model cannot be reloaded with SCOREP_RRL_TMM_DISTRIBUTION=broadcast");
+    }
+    auto model = std::make_unique<tuning_model>();
+    load(file_path, *model);
+
+    std::lock_guard<std::mutex> lock(pending_lock_);
+    pending_ = std::move(model);
+    reload_pending_ = true;
+    logging::debug("RAT_TMM") << "read new tuning model: " << file_path;
 }
 
-void rat_tmm::set_changed(bool) noexcept
+/** Replaces the tuning model. The rts of all interned callpaths are looked up in both models,
+ * including the prefix fallback, and the callpaths whose scenarios or execution time differ are
+ * reported. If the clusters differ, all nodes are affected, as the phases are classified again.
+ */
+tuning_model_change rat_tmm::swap_model(std::unique_ptr<tuning_model> model)
 {
+    tuning_model_change change;
+    change.all = model->clusters() != tm_->clusters();
+
+    std::vector<const scenario_fallback::scenario_map *> scenarios;
+    std::vector<std::chrono::milliseconds> exectimes;
+    if (!change.all)
+    {
+        for (callpath_id id = 0; id < callpaths_.size(); id++)
+        {
+            auto node = find_node(id);
+            scenarios.push_back(
+                node != nullptr ? tm_->configurations(*node) : tm_->configurations(convert(id)));
+            exectimes.push_back(get_exectime(id));
+        }
+    }
+
+    /* the old model is kept until the comparison is done, scenarios points into it */
+    auto old = std::move(tm_);
+    tm_ = std::move(model);
+    trie_nodes_.clear();
+    is_resolved_.clear();
+    fallbacks_.clear();
+
+    for (callpath_id id = 0; id < scenarios.size(); id++)
+    {
+        auto node = find_node(id);
+        auto current =
+            node != nullptr ? tm_->configurations(*node) : tm_->configurations(convert(id));
+        bool same = current == nullptr ? scenarios[id] == nullptr
+                                       : scenarios[id] != nullptr && *current == *scenarios[id];
+        if (!same || get_exectime(id) != exectimes[id])
+            change.callpaths.push_back(id);
+    }
+
+    for (const auto &region : registered_regions_)
+    {
+        auto status = tm_->has_region(region.second) ? significant : insignificant;
+        if (status != significance_[region.first])
+        {
+            significance_[region.first] = status;
+            change.regions.push_back(region.first);
+        }
+    }
+
+    logging::debug("RAT_TMM") << "swapped tuning model, " << change.callpaths.size()
+                              << " callpaths and " << change.regions.size()
+                              << " regions changed" << (change.all ? ", clusters changed" : "");
+    return change;
+}
+
+/** Reloads the tuning model when its file changes. To avoid reading a partially written file,
+ * the new file has to be written next to the old one, and renamed to its path.
+ */
+void rat_tmm::watch(file_stamp stamp)
+{
+    std::unique_lock<std::mutex> lock(watch_lock_);
+    while (!watch_cv_.wait_for(lock, watch_interval_, [this]() { return stop_watch_; }))
+    {
+        file_stamp current(file_path_);
+        if (current == stamp)
+            continue;
+        stamp = current;
+        try
+        {
+            reload(file_path_);
+        }
+        catch (std::exception &e)
+        {
+            logging::error("RAT_TMM") << "cannot reload tuning model: " << e.what();
+        }
+    }
+}
+
+/** Receives the tuning model, if it is broadcasted. Regions that are registered until now are
+ * insignificant, so their significance is resolved again. has_changed() reports the new model,
+ * so the call tree nodes are looked up again.
+ */
+void rat_tmm::init_mpp()
+{
+    if (!broadcast_)
+        return;
+
+    int initialized = 0;
+    PMPI_Initialized(&initialized);
+    if (initialized)
+    {
+        tm_->load_binary(distribute_tuning_model(file_path_, MPI_COMM_WORLD));
+        trie_nodes_.clear();
+        is_resolved_.clear();
+        fallbacks_.clear();
+    }
+    else
+    {
+        logging::warn("RAT_TMM") << "MPI is not initialised, reading tuning model on each process";
+        load(file_path_);
+    }
+
+    resolve_significance();
+    changed_ = true;
+}
+
+void rat_tmm::resolve_significance()
+{
+    for (const auto &region : registered_regions_)
+    {
+        significance_[region.first] = tm_->has_region(region.second) ? significant : insignificant;
+    }
 }
 
 std::string rat_tmm::get_name_from_region_id(const std::uint32_t region_id) noexcept
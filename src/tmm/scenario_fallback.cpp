@@ -0,0 +1,270 @@
+#include <tmm/scenario_fallback.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <map>
+#include <stdexcept>
+
+namespace rrl
+{
+namespace tmm
+{
+constexpr int scenario_fallback::no_cluster;
+
+fallback_mode parse_fallback_mode(const std::string &mode)
+{
+    if (mode == "none")
+        return fallback_mode::none;
+    if (mode == "nearest")
+        return fallback_mode::nearest;
+    if (mode == "majority")
+        return fallback_mode::majority;
+    if (mode == "cluster")
+        return fallback_mode::cluster;
+    throw std::invalid_argument("Unknown fallback mode: " + mode);
+}
+
+/** parses value completely as number, input identifiers are passed as strings
+ */
+static bool to_number(const std::string &value, double &number)
+{
+    if (value.empty())
+        return false;
+    char *end = nullptr;
+    number = std::strtod(value.c_str(), &end);
+    return *end == '\0';
+}
+
+/** returns the configuration most of the given configurations are equal to, the first one on a tie
+ */
+static const configuration_t *majority(const std::vector<const configuration_t *> &configurations)
+{
+    std::vector<std::pair<const configuration_t *, std::size_t>> counts;
+    for (auto configuration : configurations)
+    {
+        auto it = std::find_if(counts.begin(), counts.end(), [configuration](const auto &count) {
+            return *count.first == *configuration;
+        });
+        if (it == counts.end())
+            counts.emplace_back(configuration, 1);
+        else
+            it->second++;
+    }
+
+    const configuration_t *result = nullptr;
+    std::size_t max = 0;
+    for (const auto &count : counts)
+    {
+        if (count.second > max)
+        {
+            result = count.first;
+            max = count.second;
+        }
+    }
+    return result;
+}
+
+/** numeric identifiers of an identifier set by their id */
+static std::unordered_map<std::size_t, double> numeric_values(const identifier_set &ids)
+{
+    std::unordered_map<std::size_t, double> values;
+    for (const auto &id : ids.ints)
+        values[id.id] = static_cast<double>(id.value);
+    for (const auto &id : ids.uints)
+        values[id.id] = static_cast<double>(id.value);
+    return values;
+}
+
+/** numeric input identifiers by the id of their name */
+static std::unordered_map<std::size_t, double> numeric_values(
+    const std::unordered_map<std::string, std::string> &input_identifiers)
+{
+    std::unordered_map<std::size_t, double> values;
+    double number;
+    for (const auto &input : input_identifiers)
+    {
+        if (to_number(input.second, number))
+            values[std::hash<std::string>{}(input.first)] = number;
+    }
+    return values;
+}
+
+scenario_fallback::scenario_fallback(fallback_mode mode,
+    const scenario_map &scenarios,
+    const std::unordered_map<int, phase_data_t> &clusters)
+    : mode_(mode), clusters_(clusters)
+{
+    std::vector<const configuration_t *> configurations;
+    for (const auto &scenario : scenarios)
+        configurations.push_back(&scenario.second);
+    majority_ = majority(configurations);
+
+    if (mode_ == fallback_mode::nearest)
+    {
+        for (const auto &scenario : scenarios)
+        {
+            for (const auto &value : numeric_values(scenario.first))
+            {
+                if (std::find(dimensions_.begin(), dimensions_.end(), value.first) ==
+                    dimensions_.end())
+                    dimensions_.push_back(value.first);
+            }
+        }
+
+        std::vector<double> min(dimensions_.size(), std::numeric_limits<double>::max());
+        std::vector<double> max(dimensions_.size(), std::numeric_limits<double>::lowest());
+        for (const auto &scenario : scenarios)
+        {
+            auto values = numeric_values(scenario.first);
+            std::vector<double> point(dimensions_.size(), std::nan(""));
+            for (std::size_t d = 0; d < dimensions_.size(); d++)
+            {
+                auto value = values.find(dimensions_[d]);
+                if (value == values.end())
+                    continue;
+                point[d] = value->second;
+                min[d] = std::min(min[d], value->second);
+                max[d] = std::max(max[d], value->second);
+            }
+            scenarios_.push_back({&scenario.second, std::move(point), scenario.first.strings});
+        }
+
+        for (std::size_t d = 0; d < dimensions_.size(); d++)
+            ranges_.push_back(max[d] > min[d] ? max[d] - min[d] : 1.0);
+    }
+
+    if (mode_ == fallback_mode::cluster)
+    {
+        std::map<int, std::vector<const configuration_t *>> by_cluster;
+        for (const auto &scenario : scenarios)
+        {
+            auto cluster = classify(numeric_values(scenario.first));
+            if (cluster != no_cluster)
+                by_cluster[cluster].push_back(&scenario.second);
+        }
+        for (const auto &cluster : by_cluster)
+            cluster_configurations_[cluster.first] = majority(cluster.second);
+    }
+}
+
+/** Returns the configuration for input identifiers which have no scenario in the rts, or nullptr
+ * if the mode is none, or no scenario matches.
+ */
+const configuration_t *scenario_fallback::select(
+    const std::unordered_map<std::string, std::string> &input_identifiers) const
+{
+    switch (mode_)
+    {
+        case fallback_mode::nearest:
+            return select_nearest(input_identifiers);
+        case fallback_mode::majority:
+            return majority_;
+        case fallback_mode::cluster:
+            return select_cluster(input_identifiers);
+        default:
+            return nullptr;
+    }
+}
+
+/** Returns the configuration of the scenario with the smallest distance to the input identifiers.
+ *
+ * The distance is the euclidean distance of the numeric identifiers, normalised by the range of
+ * each identifier in the rts. An identifier that only the input or only the scenario has adds the
+ * whole range. Scenarios with a string identifier which differs from the input are skipped.
+ */
+const configuration_t *scenario_fallback::select_nearest(
+    const std::unordered_map<std::string, std::string> &input_identifiers) const
+{
+    std::vector<double> point(dimensions_.size(), std::nan(""));
+    std::unordered_map<std::size_t, const std::string *> strings;
+    double number;
+    for (const auto &input : input_identifiers)
+    {
+        auto id = std::hash<std::string>{}(input.first);
+        strings[id] = &input.second;
+        auto d = std::find(dimensions_.begin(), dimensions_.end(), id) - dimensions_.begin();
+        if (static_cast<std::size_t>(d) < dimensions_.size() && to_number(input.second, number))
+            point[d] = number;
+    }
+
+    const configuration_t *result = nullptr;
+    double min_distance = std::numeric_limits<double>::max();
+    for (const auto &scenario : scenarios_)
+    {
+        auto matches = std::all_of(
+            scenario.strings.begin(), scenario.strings.end(), [&strings](const auto &id) {
+                auto input = strings.find(id.id);
+                return input == strings.end() || *input->second == id.value;
+            });
+        if (!matches)
+            continue;
+
+        double distance = 0;
+        for (std::size_t d = 0; d < dimensions_.size(); d++)
+        {
+            if (std::isnan(point[d]) && std::isnan(scenario.point[d]))
+                continue;
+            if (std::isnan(point[d]) || std::isnan(scenario.point[d]))
+            {
+                distance += 1.0;
+                continue;
+            }
+            auto delta = (point[d] - scenario.point[d]) / ranges_[d];
+            distance += delta * delta;
+        }
+        if (distance < min_distance)
+        {
+            min_distance = distance;
+            result = scenario.configuration;
+        }
+    }
+    return result;
+}
+
+/** Returns the configuration of the scenarios in the cluster of the input identifiers.
+ */
+const configuration_t *scenario_fallback::select_cluster(
+    const std::unordered_map<std::string, std::string> &input_identifiers) const
+{
+    auto cluster = classify(numeric_values(input_identifiers));
+    auto it = cluster_configurations_.find(cluster);
+    return it != cluster_configurations_.end() ? it->second : nullptr;
+}
+
+/** Returns the id of the cluster with the lowest id, whose feature ranges contain the values.
+ * Features without a value are ignored, but at least one feature has to have a value. Returns
+ * no_cluster if there is no such cluster.
+ *
+ * @param values numeric values by the id of the name of the feature
+ */
+int scenario_fallback::classify(const std::unordered_map<std::size_t, double> &values) const
+{
+    int result = no_cluster;
+    for (const auto &cluster : clusters_)
+    {
+        if (result != no_cluster && cluster.first > result)
+            continue;
+
+        std::size_t matched = 0;
+        bool contained = true;
+        for (const auto &range : cluster.second.second)
+        {
+            auto value = values.find(std::hash<std::string>{}(range.first));
+            if (value == values.end())
+                continue;
+            matched++;
+            if (value->second < range.second.first || value->second > range.second.second)
+            {
+                contained = false;
+                break;
+            }
+        }
+        if (matched > 0 && contained)
+            result = cluster.first;
+    }
+    return result;
+}
+} // namespace tmm
+} // namespace rrl
@@ -0,0 +1,72 @@
+#include <tmm/string_pool.hpp>
+
+#include <util/hash.hpp>
+
+#include <stdexcept>
+
+namespace rrl
+{
+namespace tmm
+{
+constexpr unsigned string_pool::first_chunk_bits;
+constexpr std::uint64_t string_pool::first_chunk_size;
+constexpr unsigned string_pool::nchunks;
+
+/** The empty string is interned first, so it has the id of a default constructed symbol.
+ */
+string_pool::string_pool() : size_(0)
+{
+    for (auto &chunk : chunks_)
+        chunk.store(nullptr, std::memory_order_relaxed);
+    intern(std::string());
+}
+
+/** Returns the pool of the process. It is constructed at its first use, so symbols can be
+ * constructed during static initialisation.
+ */
+string_pool &string_pool::instance()
+{
+    static string_pool pool;
+    return pool;
+}
+
+/** Returns the id of s. If s is not in the pool yet, it is added.
+ *
+ * @param s string to intern
+ * @return id of the string
+ * @throws std::length_error if the pool has no more ids
+ */
+std::uint32_t string_pool::intern(const std::string &s)
+{
+    std::lock_guard<std::mutex> guard(lock_);
+    auto it = ids_.find(std::cref(s));
+    if (it != ids_.end())
+        return it->second;
+
+    if (size_ == UINT32_MAX)
+        throw std::length_error("string pool is full");
+    auto id = size_;
+    auto n = static_cast<std::uint64_t>(id) + first_chunk_size;
+    unsigned k = 63 - __builtin_clzll(n) - first_chunk_bits;
+    if (!storage_[k])
+    {
+        storage_[k].reset(new entry[first_chunk_size << k]);
+        chunks_[k].store(storage_[k].get(), std::memory_order_release);
+    }
+
+    /* the entry is written before the id is published by the unlock */
+    entry &e = storage_[k][n - (first_chunk_size << k)];
+    e.str = s;
+    e.hash = hash::value(s);
+    ids_.emplace(std::cref(e.str), id);
+    size_++;
+    return id;
+}
+
+std::size_t string_pool::size() const noexcept
+{
+    std::lock_guard<std::mutex> guard(lock_);
+    return size_;
+}
+} // namespace tmm
+} // namespace rrl
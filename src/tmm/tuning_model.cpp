@@ -1,3 +1,4 @@
+#include <tmm/binary_model.hpp>
 #include <tmm/callpath.hpp>
 #include <tmm/tuning_model.hpp>
 #include <tmm/tuning_model_manager.hpp>
@@ -9,6 +10,10 @@
 #include <cereal/archives/json.hpp>
 #include <cereal/types/string.hpp>
 
+#include <algorithm>
+#include <set>
+#include <sstream>
+
 template <typename T>
 static inline T convert(const std::string &s)
 {
@@ -153,18 +158,20 @@ void load(Archive &archive, std::unordered_map<uint64_t, rrl::tmm::identifier_se
 template <class Archive>
 void load(Archive &archive, rrl::tmm::region_id &rid)
 {
-    archive(make_nvp("file", rid.file));
+    std::string file;
+    std::string name;
+    archive(make_nvp("file", file));
     archive(make_nvp("line", rid.line));
-    archive(make_nvp("name", rid.name));
+    archive(make_nvp("name", name));
+    rid.file = rrl::tmm::symbol(file);
+    rid.name = rrl::tmm::symbol(name);
 }
 
 template <class Archive>
 void load(Archive &archive, std::pair<uint64_t, rrl::tmm::region_id> &pair)
 {
     archive(make_nvp("id", pair.first));
-    archive(make_nvp("file", pair.second.file));
-    archive(make_nvp("line", pair.second.line));
-    archive(make_nvp("name", pair.second.name));
+    load(archive, pair.second);
 }
 
 template <class Archive>
@@ -297,6 +304,30 @@ namespace rrl
 {
 namespace tmm
 {
+/** returns the rts of cp, it is created if the model has no rts for cp yet
+ */
+tuning_model::rts &tuning_model::insert_rts(const std::vector<callpath_element> &cp)
+{
+    auto node = trie_.insert(cp);
+    if (!node->has_value())
+    {
+        node->value = rtss_.size();
+        rtss_.push_back({node, nullptr, {}, std::chrono::milliseconds(0)});
+    }
+    return rtss_[node->value];
+}
+
+/** returns the rts of cp, or nullptr if the trie has no rts for cp
+ */
+const tuning_model::rts *tuning_model::find_rts(const std::vector<callpath_element> &cp) const
+    noexcept
+{
+    auto node = trie_.find(cp);
+    if (node == nullptr || !node->has_value())
+        return nullptr;
+    return &rtss_[node->value];
+}
+
 void tuning_model::store_configuration(const std::vector<callpath_element> &callpath,
     const std::vector<parameter_tuple> &configuration,
     const std::chrono::milliseconds &exectime)
@@ -306,19 +337,224 @@ void tuning_model::store_configuration(const std::vector<callpath_element> &call
         config[pt.parameter_id] = pt.parameter_value;
 
     identifier_set iset;
-    std::unique_ptr<inputidmap> map(new inputidmap({{iset, config}}));
-    scenarios_[callpath] = std::move(map);
-    exectimes_[callpath] = exectime;
+    auto &rts = insert_rts(callpath);
+    rts.scenarios.reset(new inputidmap({{iset, config}}));
+    rts.lazy.clear();
+    rts.exectime = exectime;
+
+    if (!callpath.empty())
+        add_region(callpath.back());
 }
 
+void tuning_model::store_scenario(const std::vector<callpath_element> &callpath,
+    const identifier_set &ids,
+    const configuration_t &configuration,
+    std::chrono::milliseconds exectime)
+{
+    auto &rts = insert_rts(callpath);
+    /* decodes lazily deserialized scenarios */
+    configurations(*rts.node);
+    (*rts.scenarios)[ids] = configuration;
+    rts.lazy.clear();
+    rts.exectime = exectime;
+
+    if (!callpath.empty())
+        add_region(callpath.back());
+}
+
+/** makes the region of cpe a region of the model, like the regions of the rts of a JSON model
+ */
+void tuning_model::add_region(const callpath_element &cpe)
+{
+    if (region_index_.insert(cpe.region_id()).second)
+        regions_.emplace(std::hash<region_id>{}(cpe.region_id()), cpe.region_id());
+    nidentifiers_.emplace(cpe.region_id(), cpe.ids().size());
+}
+
+void tuning_model::add_cluster(int id, const phase_data_t &cluster)
+{
+    clusters_[id] = cluster;
+}
+
+void tuning_model::for_each_rts(const std::function<void(const std::vector<callpath_element> &,
+        const std::unordered_map<identifier_set, configuration_t> &,
+        std::chrono::milliseconds)> &f) const
+{
+    /* the scenarios of a lazy model are decoded for f only, so visiting all rts does not keep the
+     * whole model decoded */
+    for (const auto &rts : rtss_)
+    {
+        if (rts.scenarios)
+            f(trie_.path(*rts.node), *rts.scenarios, rts.exectime);
+        else
+            f(trie_.path(*rts.node), decode_scenarios(rts), rts.exectime);
+    }
+
+    if (binary_)
+    {
+        for (std::size_t n = 0; n < binary_->ncallpaths(); n++)
+        {
+            const auto &record = binary_->callpath_at(n);
+            auto cp = binary_->decode_callpath(record);
+            if (find_rts(cp) == nullptr)
+                f(cp,
+                    binary_->decode_scenarios(record),
+                    std::chrono::milliseconds(record.exectime));
+        }
+    }
+}
+
+bool tuning_model::has_region(const region_id &rid) const noexcept
+{
+    if (binary_)
+    {
+        auto region = binary_->find_region(rid);
+        return region != nullptr && (region->flags & binary::in_model);
+    }
+    return region_index_.find(rid) != region_index_.end();
+}
+
+size_t tuning_model::nidentifiers(const region_id &rid) const
+{
+    RRL_DEBUG_ASSERT(has_region(rid));
+    if (binary_)
+    {
+        auto region = binary_->find_region(rid);
+        if (region == nullptr || !(region->flags & binary::has_nidentifiers))
+            throw std::out_of_range("Region not in tuning model: " + rid.debug_string());
+        return region->nidentifiers;
+    }
+    return nidentifiers_.at(rid);
+}
+
+bool tuning_model::has_rts(const std::vector<callpath_element> &cp) const noexcept
+{
+    return find_rts(cp) != nullptr || (binary_ && binary_->find_callpath(cp) != nullptr);
+}
+
+std::chrono::milliseconds tuning_model::exectime(const std::vector<callpath_element> &cp) const
+    noexcept
+{
+    RRL_DEBUG_ASSERT(has_rts(cp));
+    auto rts = find_rts(cp);
+    if (rts != nullptr)
+        return rts->exectime;
+
+    if (binary_)
+    {
+        auto record = binary_->find_callpath(cp);
+        if (record != nullptr)
+            return std::chrono::milliseconds(record->exectime);
+    }
+    return std::chrono::milliseconds(0);
+}
+
+std::chrono::milliseconds tuning_model::exectime(const callpath_trie::node &node) const noexcept
+{
+    RRL_DEBUG_ASSERT(node.has_value());
+    return rtss_[node.value].exectime;
+}
+
+/** Returns the scenarios of cp, or nullptr if the tuning model has no such callpath.
+ *
+ * The scenarios of a binary or lazily deserialized model are decoded at the first request. This
+ * is not thread safe.
+ */
 const std::unordered_map<identifier_set, configuration_t> *tuning_model::configurations(
     const std::vector<callpath_element> &cp) const
 {
-    const auto &it = scenarios_.find(cp);
-    return it != scenarios_.end() ? it->second.get() : nullptr;
+    auto node = trie_.find(cp);
+    if (node != nullptr && node->has_value())
+        return configurations(*node);
+    if (!binary_)
+        return nullptr;
+
+    const auto &decoded = decoded_scenarios_.find(cp);
+    if (decoded != decoded_scenarios_.end())
+        return decoded->second.get();
+
+    auto record = binary_->find_callpath(cp);
+    if (record == nullptr)
+        return nullptr;
+
+    std::unique_ptr<inputidmap> map(new inputidmap(binary_->decode_scenarios(*record)));
+    auto result = map.get();
+    decoded_scenarios_.emplace(cp, std::move(map));
+    return result;
+}
+
+const std::unordered_map<identifier_set, configuration_t> *tuning_model::configurations(
+    const callpath_trie::node &node) const
+{
+    if (!node.has_value())
+        return nullptr;
+
+    const auto &rts = rtss_[node.value];
+    if (!rts.scenarios)
+        rts.scenarios.reset(new inputidmap(decode_scenarios(rts)));
+    return rts.scenarios.get();
+}
+
+/** decodes the lazy scenarios of an rts, without caching them in the rts */
+tuning_model::inputidmap tuning_model::decode_scenarios(const rts &rts) const
+{
+    inputidmap scenarios;
+    for (const auto &scenario : rts.lazy)
+        scenarios[iids_.at(scenario.iid)] = lazy_configurations_.at(scenario.scenario);
+    return scenarios;
+}
+
+size_t tuning_model::ncallpaths() const noexcept
+{
+    if (!binary_)
+        return rtss_.size();
+
+    size_t n = binary_->ncallpaths();
+    for (const auto &rts : rtss_)
+    {
+        if (binary_->find_callpath(trie_.path(*rts.node)) == nullptr)
+            n++;
+    }
+    return n;
+}
+
+size_t tuning_model::ninputidsets(const std::vector<callpath_element> &cp) const noexcept
+{
+    auto rts = find_rts(cp);
+    if (rts != nullptr)
+        return rts->scenarios ? rts->scenarios->size() : rts->lazy.size();
+
+    if (binary_)
+    {
+        auto record = binary_->find_callpath(cp);
+        if (record != nullptr)
+            return record->nscenarios;
+    }
+    return 0;
+}
+
+void tuning_model::load_binary(std::shared_ptr<const binary_model> model)
+{
+    clear();
+    clusters_ = model->decode_clusters();
+    binary_ = std::move(model);
+}
+
+void tuning_model::clear()
+{
+    clusters_.clear();
+    iids_.clear();
+    regions_.clear();
+    region_index_.clear();
+    nidentifiers_.clear();
+    trie_.clear();
+    rtss_.clear();
+    lazy_configurations_.clear();
+    decoded_scenarios_.clear();
+    binary_.reset();
 }
 
-void tuning_model::deserialize(std::istream &is)
+void tuning_model::deserialize(std::istream &is, bool lazy)
 {
     std::unordered_map<uint64_t, rrl::tmm::region_id> regions;
     std::unordered_map<uint64_t, rrl::tmm::identifier_set> iids;
@@ -359,6 +595,23 @@ void tuning_model::deserialize(std::istream &is)
     }
 
     /* update class attributes */
+    trie_.clear();
+    rtss_.clear();
+    lazy_configurations_.clear();
+    decoded_scenarios_.clear();
+    binary_.reset();
+
+    if (lazy)
+    {
+        /* only the trie is built, configurations() decodes the scenarios */
+        for (const auto &scnr : scenarios)
+        {
+            auto &config = lazy_configurations_[scnr.first];
+            for (const auto &pt : scnr.second)
+                config[std::hash<std::string>{}(pt.first)] = pt.second;
+        }
+    }
+
     std::unordered_map<rrl::tmm::region_id, size_t> nidentifiers;
     for (const auto &tpl : rtss)
     {
@@ -368,6 +621,25 @@ void tuning_model::deserialize(std::istream &is)
         auto iid = std::get<3>(tpl);
         auto exectime = std::get<4>(tpl);
 
+        RRL_DEBUG_ASSERT(regions.find(rid) != regions.end());
+        if (nidentifiers.find(regions[rid]) == nidentifiers.end())
+            nidentifiers[regions[rid]] = cp[cp.size() - 1].ids().size();
+        else
+            RRL_DEBUG_ASSERT(nidentifiers[regions[rid]] == cp[cp.size() - 1].ids().size());
+
+        auto &rts = insert_rts(cp);
+
+        /* set execution time */
+        auto exec_seconds = std::chrono::duration<double>(exectime);
+        rts.exectime = std::chrono::duration_cast<std::chrono::milliseconds>(exec_seconds);
+
+        /* set scenarios */
+        if (lazy)
+        {
+            rts.lazy.push_back({iid, scnrid});
+            continue;
+        }
+
         RRL_DEBUG_ASSERT(iids.find(iid) != iids.end());
         auto &iidset = iids[iid];
 
@@ -379,49 +651,203 @@ void tuning_model::deserialize(std::istream &is)
             config[pid] = pt.second;
         }
 
-        RRL_DEBUG_ASSERT(regions.find(rid) != regions.end());
-        if (nidentifiers.find(regions[rid]) == nidentifiers.end())
-            nidentifiers[regions[rid]] = cp[cp.size() - 1].ids().size();
-        else
-            RRL_DEBUG_ASSERT(nidentifiers[regions[rid]] == cp[cp.size() - 1].ids().size());
-
-        /* set scenarios */
-        if (scenarios_.find(cp) == scenarios_.end())
+        if (!rts.scenarios)
         {
-            std::unique_ptr<inputidmap> map(new inputidmap({{iidset, config}}));
-            scenarios_[cp] = std::move(map);
+            rts.scenarios.reset(new inputidmap({{iidset, config}}));
         }
         else
         {
-            RRL_DEBUG_ASSERT(scenarios_[cp]->find(iidset) == scenarios_[cp]->end());
-            (*scenarios_[cp])[iidset] = config;
+            RRL_DEBUG_ASSERT(rts.scenarios->find(iidset) == rts.scenarios->end());
+            (*rts.scenarios)[iidset] = config;
         }
-
-        /* set execution time */
-        auto exec_seconds = std::chrono::duration<double>(exectime);
-        exectimes_[cp] = std::chrono::duration_cast<std::chrono::milliseconds>(exec_seconds);
     }
+    iids_ = std::move(iids);
     regions_ = regions;
     nidentifiers_ = nidentifiers;
+
+    region_index_.clear();
+    for (const auto &region : regions_)
+    {
+        region_index_.insert(region.second);
+    }
+}
+
+namespace
+{
+/** writes the identifiers as {id=value,...}, nothing if there are none */
+void write_ids(std::ostream &os, const identifier_set &ids)
+{
+    if (ids.size() == 0)
+        return;
+    const char *separator = "{";
+    for (const auto &id : ids.uints)
+    {
+        os << separator << id.id << "=" << id.value;
+        separator = ",";
+    }
+    for (const auto &id : ids.ints)
+    {
+        os << separator << id.id << "=" << id.value;
+        separator = ",";
+    }
+    for (const auto &id : ids.strings)
+    {
+        os << separator << id.id << "=" << id.value;
+        separator = ",";
+    }
+    os << "}";
+}
+
+void write_callpath_element(std::ostream &os, const callpath_element &cpe)
+{
+    os << cpe.region_id();
+    write_ids(os, cpe.ids());
+}
+
+/** writes s as quoted dot string */
+void write_dot_string(std::ostream &os, const std::string &s)
+{
+    os << '"';
+    for (auto c : s)
+    {
+        if (c == '"' || c == '\\')
+            os << '\\';
+        os << c;
+    }
+    os << '"';
+}
+
+/** adds the hashes of the values of ids to the values per identifier id */
+template <typename T>
+void add_values(std::unordered_map<std::size_t, std::unordered_set<std::uint64_t>> &values,
+    const std::vector<identifier<T>> &ids)
+{
+    for (const auto &id : ids)
+        values[id.id].insert(hash::value(id.value));
+}
+
+void add_values(std::unordered_map<std::size_t, std::unordered_set<std::uint64_t>> &values,
+    const identifier_set &ids)
+{
+    add_values(values, ids.uints);
+    add_values(values, ids.ints);
+    add_values(values, ids.strings);
 }
+} // namespace
 
-std::string tuning_model::to_dot() const
+void tuning_model::to_dot(std::ostream &os) const
 {
-    return "";
+    os << "strict digraph tuning_model {\n";
+    os << "node [shape=ellipse];\n";
+    std::ostringstream label;
+    for_each_rts([&os, &label](const std::vector<callpath_element> &cp,
+                     const std::unordered_map<identifier_set, configuration_t> &scenarios,
+                     std::chrono::milliseconds exectime) {
+        /* the nodes are identified by the hash of their callpath, so the rts with the same
+         * prefix share its nodes */
+        std::uint64_t parent = 0;
+        std::uint64_t node = 0;
+        for (std::size_t n = 0; n < cp.size(); n++)
+        {
+            node = hash::combine(node, std::hash<callpath_element>{}(cp[n]));
+            label.str("");
+            write_callpath_element(label, cp[n]);
+            os << "n" << node << " [label=";
+            write_dot_string(os, label.str());
+            if (n + 1 == cp.size())
+                os << ", shape=box, xlabel=\"" << scenarios.size() << " scenarios, "
+                   << exectime.count() << " ms\"";
+            os << "];\n";
+            if (n > 0)
+                os << "n" << parent << " -> n" << node << ";\n";
+            parent = node;
+        }
+    });
+    os << "}\n";
 }
 
-std::string tuning_model::to_matrix() const
+void tuning_model::to_matrix(std::ostream &os) const
 {
-    return "";
+    std::set<std::size_t> parameter_set;
+    for_each_rts([&parameter_set](const std::vector<callpath_element> &,
+                     const std::unordered_map<identifier_set, configuration_t> &scenarios,
+                     std::chrono::milliseconds) {
+        for (const auto &scenario : scenarios)
+            for (const auto &parameter : scenario.second)
+                parameter_set.insert(parameter.first);
+    });
+    std::vector<std::size_t> parameters(parameter_set.begin(), parameter_set.end());
+
+    os << "callpath\tidentifiers\texectime_ms";
+    for (auto parameter : parameters)
+        os << "\t" << parameter;
+    os << "\n";
+
+    for_each_rts([&os, &parameters](const std::vector<callpath_element> &cp,
+                     const std::unordered_map<identifier_set, configuration_t> &scenarios,
+                     std::chrono::milliseconds exectime) {
+        for (const auto &scenario : scenarios)
+        {
+            for (std::size_t n = 0; n < cp.size(); n++)
+            {
+                if (n > 0)
+                    os << " > ";
+                write_callpath_element(os, cp[n]);
+            }
+            os << "\t";
+            write_ids(os, scenario.first);
+            os << "\t" << exectime.count();
+            for (auto parameter : parameters)
+            {
+                os << "\t";
+                auto value = scenario.second.find(parameter);
+                if (value != scenario.second.end())
+                    os << value->second;
+            }
+            os << "\n";
+        }
+    });
+}
+
+tuning_model_statistics tuning_model::statistics() const
+{
+    tuning_model_statistics stats;
+    std::unordered_set<std::size_t> parameters;
+    std::unordered_map<std::size_t, std::unordered_set<std::uint64_t>> values;
+    for_each_rts([&stats, &parameters, &values](const std::vector<callpath_element> &cp,
+                     const std::unordered_map<identifier_set, configuration_t> &scenarios,
+                     std::chrono::milliseconds) {
+        stats.nrts++;
+        stats.nscenarios += scenarios.size();
+        stats.max_scenarios = std::max(stats.max_scenarios, scenarios.size());
+        if (stats.depth_histogram.size() <= cp.size())
+            stats.depth_histogram.resize(cp.size() + 1, 0);
+        stats.depth_histogram[cp.size()]++;
+        for (const auto &cpe : cp)
+            add_values(values, cpe.ids());
+        for (const auto &scenario : scenarios)
+        {
+            add_values(values, scenario.first);
+            for (const auto &parameter : scenario.second)
+                parameters.insert(parameter.first);
+        }
+    });
+    stats.nparameters = parameters.size();
+    stats.nclusters = clusters_.size();
+    for (const auto &value : values)
+        stats.identifier_cardinality[value.first] = value.second.size();
+    return stats;
 }
 
 bool tuning_model::is_root(const callpath_element &cpe) const noexcept
 {
-    RRL_DEBUG_ASSERT(scenarios_.size() != 0 && (*scenarios_.begin()).first.size() != 0);
-    logging::trace("TM") << "is_root tm:" << (*scenarios_.begin()).first[0];
-    logging::trace("TM") << "is_root cpe:" << cpe;
+    if (binary_)
+        return binary_->is_root(cpe);
 
-    return cpe == (*scenarios_.begin()).first[0];
+    /* all callpaths of the JSON model have the same root, see deserialize(). There is no root
+     * before the model is read, e.g. before it is broadcasted. */
+    RRL_TRACE("TM") << "is_root cpe:" << cpe;
+    return trie_.child(trie_.root(), cpe) != nullptr;
 }
 }
 }
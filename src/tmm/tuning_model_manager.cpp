@@ -13,6 +13,31 @@ namespace rrl
 {
 namespace tmm
 {
+void tuning_model_manager::store_configuration(callpath_id callpath,
+    const std::vector<parameter_tuple> &configuration,
+    std::chrono::milliseconds exectime)
+{
+    store_configuration(callpaths_.callpath(callpath), configuration, exectime);
+}
+
+void tuning_model_manager::store_configuration(callpath_id callpath,
+    const std::vector<parameter_tuple> &configuration,
+    std::chrono::milliseconds exectime,
+    double)
+{
+    store_configuration(callpath, configuration, exectime);
+}
+
+const std::vector<parameter_tuple> tuning_model_manager::get_current_rts_configuration(
+    callpath_id callpath, const std::unordered_map<std::string, std::string> &input_identifers)
+{
+    return get_current_rts_configuration(callpaths_.callpath(callpath), input_identifers);
+}
+
+std::chrono::milliseconds tuning_model_manager::get_exectime(callpath_id callpath) noexcept
+{
+    return get_exectime(callpaths_.callpath(callpath));
+}
 
 std::shared_ptr<tuning_model_manager> get_tuning_model_manager(std::string tuning_model_file_path)
 {
@@ -0,0 +1,173 @@
+/* Replays a stream of enter/exit events on the call tree, and reports the time per event.
+ *
+ * The stream is either read from a file, with one event per line ("enter <region id>" or
+ * "exit <region id>"), or generated: a random program of nested regions is called repeatedly,
+ * like the phase loop of an application.
+ *
+ * For comparison, the same stream is replayed on a call tree that stores its children in an
+ * std::unordered_map of std::unique_ptr, as the call tree did before it used a node_arena.
+ *
+ * USAGE: bench-call-tree [event file]
+ */
+
+#include <rrl/call_tree/region_node.hpp>
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace rrl;
+
+struct event
+{
+    bool enter;
+    std::uint32_t region_id;
+};
+
+/** call tree node with the former layout of the children */
+class legacy_node : public call_tree::base_node
+{
+public:
+    legacy_node(base_node *parent, call_tree::node_info info) : base_node(parent, info)
+    {
+    }
+
+    virtual base_node *enter_node(std::uint32_t region) override
+    {
+        auto node_it = child_regions.find(region);
+        if (node_it != child_regions.end())
+        {
+            return node_it->second.get();
+        }
+        auto node = child_regions.emplace(region,
+            std::make_unique<legacy_node>(
+                this, call_tree::node_info(region, call_tree::node_type::region)));
+        return node.first->second.get();
+    }
+
+private:
+    std::unordered_map<std::uint32_t, std::unique_ptr<legacy_node>> child_regions;
+};
+
+/** a region of the generated program, with the regions it calls */
+struct program_region
+{
+    std::uint32_t region_id;
+    std::vector<std::size_t> callees;
+};
+
+static void generate_calls(const std::vector<program_region> &program,
+    std::size_t region,
+    std::vector<event> &events)
+{
+    events.push_back({true, program[region].region_id});
+    for (auto callee : program[region].callees)
+    {
+        generate_calls(program, callee, events);
+    }
+    events.push_back({false, program[region].region_id});
+}
+
+static std::vector<event> generate_events()
+{
+    const std::size_t regions = 2000;
+    const std::size_t max_depth = 24;
+    const std::size_t phases = 200;
+
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<std::uint32_t> region_id(1, regions);
+    std::geometric_distribution<std::size_t> fanout(0.4);
+
+    /* random program: region 0 is the phase, the depth is limited to keep the stream finite */
+    std::vector<program_region> program;
+    std::vector<std::size_t> depth;
+    program.push_back({0, {}});
+    depth.push_back(0);
+    for (std::size_t i = 0; i < program.size() && program.size() < 5000; i++)
+    {
+        if (depth[i] >= max_depth)
+        {
+            continue;
+        }
+        auto callees = i == 0 ? 8 : fanout(generator);
+        for (std::size_t c = 0; c < callees; c++)
+        {
+            program[i].callees.push_back(program.size());
+            program.push_back({region_id(generator), {}});
+            depth.push_back(depth[i] + 1);
+        }
+    }
+
+    std::vector<event> events;
+    for (std::size_t phase = 0; phase < phases; phase++)
+    {
+        generate_calls(program, 0, events);
+    }
+    return events;
+}
+
+static std::vector<event> read_events(const std::string &file_name)
+{
+    std::vector<event> events;
+    std::ifstream file(file_name);
+    if (!file.is_open())
+    {
+        std::cerr << "can't open " << file_name << "\n";
+        std::exit(1);
+    }
+    std::string type;
+    std::uint32_t region_id;
+    while (file >> type >> region_id)
+    {
+        events.push_back({type == "enter", region_id});
+    }
+    return events;
+}
+
+template <typename RootType> static double replay(const std::vector<event> &events)
+{
+    RootType root(nullptr, call_tree::node_info(0, call_tree::node_type::root));
+    call_tree::base_node *current = &root;
+
+    auto begin = std::chrono::high_resolution_clock::now();
+    for (const auto &event : events)
+    {
+        if (event.enter)
+        {
+            current = current->enter_node(event.region_id);
+        }
+        else
+        {
+            current = current->return_to_parent();
+        }
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+
+    if (current != &root)
+    {
+        std::cerr << "the event stream is not balanced\n";
+        std::exit(1);
+    }
+    return std::chrono::duration<double, std::nano>(end - begin).count() / events.size();
+}
+
+int main(int argc, char **argv)
+{
+    auto events = argc > 1 ? read_events(argv[1]) : generate_events();
+    std::cout << "events: " << events.size() << "\n";
+
+    /* first round warms up caches and the allocator */
+    replay<legacy_node>(events);
+    replay<call_tree::region_node>(events);
+
+    std::cout << "unordered_map<unique_ptr> children: " << replay<legacy_node>(events)
+              << " ns/event\n";
+    std::cout << "arena with inline children:         " << replay<call_tree::region_node>(events)
+              << " ns/event\n";
+    return 0;
+}
@@ -0,0 +1,129 @@
+/* Compares the hash of std::vector<simple_callpath_element> with the former hash, which formatted
+ * all fields to a std::string and hashed the string.
+ *
+ * Reports the time to hash a callpath, and the time of a lookup in an std::unordered_map with
+ * callpath keys, like the configurations of dta_tmm.
+ *
+ * USAGE: bench-callpath-hash
+ */
+
+#include <tmm/simple_callpath.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace rrl::tmm;
+
+using callpath = std::vector<simple_callpath_element>;
+
+/** the former hash, formatting all fields to a string */
+struct string_hash
+{
+    std::size_t operator()(const identifier_set &ids) const
+    {
+        std::string s;
+        for (const auto &id : ids.uints)
+            s = strfmt(s, id.id, id.value);
+        for (const auto &id : ids.ints)
+            s = strfmt(s, id.id, id.value);
+        for (const auto &id : ids.strings)
+            s = strfmt(s, id.id, id.value);
+        return std::hash<std::string>{}(s);
+    }
+
+    std::size_t operator()(const callpath &cp) const
+    {
+        std::string s;
+        for (const auto &scpe : cp)
+        {
+            s = strfmt(s, strfmt(scpe.region_id, (*this)(scpe.id_set)));
+        }
+        return std::hash<std::string>{}(s);
+    }
+};
+
+static std::vector<callpath> generate_callpaths(std::size_t count)
+{
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<std::uint32_t> region_id(1, 3000);
+    std::uniform_int_distribution<std::size_t> depth(1, 12);
+    std::bernoulli_distribution has_identifier(0.1);
+
+    std::vector<callpath> callpaths;
+    for (std::size_t n = 0; n < count; n++)
+    {
+        callpath cp = {simple_callpath_element(1, identifier_set())};
+        auto d = depth(generator);
+        for (std::size_t i = 0; i < d; i++)
+        {
+            identifier_set ids;
+            if (has_identifier(generator))
+            {
+                ids.uints.push_back(identifier<std::uint64_t>(7, n));
+            }
+            cp.push_back(simple_callpath_element(region_id(generator), ids));
+        }
+        callpaths.push_back(cp);
+    }
+    return callpaths;
+}
+
+template <typename Hash> static double hash_time(const std::vector<callpath> &callpaths)
+{
+    Hash hasher;
+    std::size_t sum = 0;
+    auto begin = std::chrono::high_resolution_clock::now();
+    for (const auto &cp : callpaths)
+    {
+        sum += hasher(cp);
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    /* keeps the compiler from removing the loop */
+    if (sum == 42)
+    {
+        std::cout << "";
+    }
+    return std::chrono::duration<double, std::nano>(end - begin).count() / callpaths.size();
+}
+
+template <typename Hash> static double lookup_time(const std::vector<callpath> &callpaths)
+{
+    std::unordered_map<callpath, std::size_t, Hash> map;
+    for (std::size_t i = 0; i < callpaths.size(); i++)
+    {
+        map[callpaths[i]] = i;
+    }
+
+    std::size_t sum = 0;
+    auto begin = std::chrono::high_resolution_clock::now();
+    for (const auto &cp : callpaths)
+    {
+        sum += map.find(cp)->second;
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    if (sum == 42)
+    {
+        std::cout << "";
+    }
+    return std::chrono::duration<double, std::nano>(end - begin).count() / callpaths.size();
+}
+
+int main()
+{
+    auto callpaths = generate_callpaths(100000);
+    std::cout << "callpaths: " << callpaths.size() << "\n";
+
+    /* first round warms up caches and the allocator */
+    hash_time<string_hash>(callpaths);
+    hash_time<std::hash<callpath>>(callpaths);
+
+    std::cout << "string hash: " << hash_time<string_hash>(callpaths) << " ns/hash, "
+              << lookup_time<string_hash>(callpaths) << " ns/lookup\n";
+    std::cout << "mixing hash: " << hash_time<std::hash<callpath>>(callpaths) << " ns/hash, "
+              << lookup_time<std::hash<callpath>>(callpaths) << " ns/lookup\n";
+    return 0;
+}
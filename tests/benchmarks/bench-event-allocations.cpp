@@ -0,0 +1,99 @@
+/* Replays enter/exit events through the filter and the rts_handler, the same way
+ * rrl::control_center does, and counts the heap allocations per enter/exit pair once the call tree
+ * is built up.
+ *
+ * The design time tuning model manager is used with SCOREP_RRL_CHECK_ROOT=false, and no
+ * parameter control plugins are loaded, so all regions end up as known regions without
+ * configuration.
+ *
+ * USAGE: bench-event-allocations [call depth] [iterations]
+ */
+
+#include <cal/calibration.hpp>
+#include <rrl/filter.hpp>
+#include <rrl/metric_manager.hpp>
+#include <rrl/rts_handler.hpp>
+#include <tmm/tuning_model_manager.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+static std::atomic<std::size_t> allocations(0);
+
+void *operator new(std::size_t size)
+{
+    allocations++;
+    void *ptr = std::malloc(size);
+    if (ptr == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void operator delete(void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+int main(int argc, char **argv)
+{
+    std::uint32_t depth = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 16;
+    std::size_t iterations = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 100000;
+
+    setenv("SCOREP_RRL_CHECK_ROOT", "false", 1);
+
+    auto tmm = rrl::tmm::get_tuning_model_manager("");
+    auto mm = std::make_shared<rrl::metric_manager>();
+    auto cal = rrl::cal::get_calibration(mm, tmm->get_calibration_type());
+    rrl::rts_handler rts(tmm, cal);
+    rrl::filter filter;
+
+    auto replay = [&]() {
+        for (std::uint32_t region = 0; region <= depth; region++)
+        {
+            if (filter.cached_decision(region) != rrl::filter::decision::exclude)
+            {
+                rts.enter_region(region, nullptr);
+            }
+        }
+        for (std::uint32_t region = depth + 1; region-- > 0;)
+        {
+            if (filter.cached_decision(region) != rrl::filter::decision::exclude)
+            {
+                rts.exit_region(region, nullptr);
+            }
+        }
+    };
+
+    /* build up the call tree and let every node leave the measure_duration state */
+    for (int i = 0; i < 3; i++)
+    {
+        replay();
+    }
+
+    allocations = 0;
+    auto begin = std::chrono::high_resolution_clock::now();
+    for (std::size_t i = 0; i < iterations; i++)
+    {
+        replay();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    std::size_t counted = allocations;
+
+    double pairs = static_cast<double>(iterations) * (depth + 1);
+    std::cout << "enter/exit pairs: " << static_cast<std::size_t>(pairs) << "\n";
+    std::cout << "allocations per pair: " << counted / pairs << "\n";
+    std::cout << "time per pair: "
+              << std::chrono::duration<double, std::nano>(end - begin).count() / pairs << " ns\n";
+
+    return counted == 0 ? 0 : 1;
+}
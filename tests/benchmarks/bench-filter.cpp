@@ -0,0 +1,117 @@
+/* Compares the matching of region names against a large filter, using rrl::pattern_set and the
+ * former linear fnmatch() scan over all patterns.
+ *
+ * USAGE: bench-filter [number of rules] [number of names]
+ */
+
+#include <rrl/pattern_set.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <fnmatch.h>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+/** the implementation of rrl::filter::check_region() before pattern_set was introduced */
+static bool linear_match(const std::vector<std::string> &patterns, const std::string &name)
+{
+    for (std::string member : patterns)
+    {
+        if (fnmatch(member.c_str(), name.c_str(), 0) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/** generates rules similar to the ones produced by scorep-score: mostly full names, some prefix
+ * and suffix wildcards and a few general patterns.
+ */
+static std::vector<std::string> generate_rules(std::size_t count, std::mt19937 &gen)
+{
+    std::vector<std::string> rules;
+    std::uniform_int_distribution<int> kind(0, 99);
+    for (std::size_t i = 0; i < count; i++)
+    {
+        auto name = "module_" + std::to_string(i % 97) + "_function_" + std::to_string(i);
+        auto k = kind(gen);
+        if (k < 80)
+        {
+            rules.push_back(name);
+        }
+        else if (k < 90)
+        {
+            rules.push_back(name + "*");
+        }
+        else if (k < 98)
+        {
+            rules.push_back("*" + name);
+        }
+        else
+        {
+            rules.push_back("module_?_" + std::to_string(i) + "*");
+        }
+    }
+    return rules;
+}
+
+int main(int argc, char **argv)
+{
+    std::size_t rule_count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 10000;
+    std::size_t name_count = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 2000;
+
+    std::mt19937 gen(42);
+    auto rules = generate_rules(rule_count, gen);
+
+    std::vector<std::string> names;
+    std::uniform_int_distribution<std::size_t> idx(0, 2 * rule_count);
+    for (std::size_t i = 0; i < name_count; i++)
+    {
+        auto n = idx(gen);
+        names.push_back("module_" + std::to_string(n % 97) + "_function_" + std::to_string(n));
+    }
+
+    auto begin = std::chrono::high_resolution_clock::now();
+    rrl::pattern_set set;
+    for (const auto &rule : rules)
+    {
+        set.add(rule);
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    auto build = std::chrono::duration<double>(end - begin).count();
+
+    std::size_t matches_set = 0;
+    begin = std::chrono::high_resolution_clock::now();
+    for (const auto &name : names)
+    {
+        matches_set += set.match(name);
+    }
+    end = std::chrono::high_resolution_clock::now();
+    auto time_set = std::chrono::duration<double>(end - begin).count();
+
+    std::size_t matches_linear = 0;
+    begin = std::chrono::high_resolution_clock::now();
+    for (const auto &name : names)
+    {
+        matches_linear += linear_match(rules, name);
+    }
+    end = std::chrono::high_resolution_clock::now();
+    auto time_linear = std::chrono::duration<double>(end - begin).count();
+
+    std::cout << "rules: " << rule_count << ", names: " << name_count << "\n";
+    std::cout << "pattern_set build: " << build * 1e3 << " ms\n";
+    std::cout << "pattern_set match: " << time_set / name_count * 1e9 << " ns/name ("
+              << matches_set << " matches)\n";
+    std::cout << "linear fnmatch:    " << time_linear / name_count * 1e9 << " ns/name ("
+              << matches_linear << " matches)\n";
+
+    if (matches_set != matches_linear)
+    {
+        std::cerr << "results differ!\n";
+        return 1;
+    }
+    return 0;
+}
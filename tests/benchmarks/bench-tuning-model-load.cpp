@@ -0,0 +1,168 @@
+/* Compares the eager and the lazy deserialization of a synthetic JSON tuning model.
+ *
+ * Reports the time of tuning_model::deserialize, the resident memory of the deserialized model,
+ * and the time to look up the configurations of 1% of the callpaths, like a process which visits
+ * only a part of the model. Each mode runs in a child process, so the allocations of one mode do
+ * not influence the other one.
+ *
+ * USAGE: bench-tuning-model-load [number of rts, default 100000]
+ */
+
+#include <tmm/tuning_model.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <malloc.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace rrl::tmm;
+
+static const std::size_t nregions = 1000;
+static const std::size_t niids = 64;
+static const std::size_t nscenarios = 32;
+
+static std::string region_json(std::size_t region)
+{
+    std::ostringstream os;
+    os << "{\"file\": \"file" << region % 50 << ".c\", \"line\": " << region
+       << ", \"name\": \"region" << region << "\"}";
+    return os.str();
+}
+
+/** writes a model with count rts of the form main -> region -> region(id), with unique ids */
+static void write_model(std::ostream &os, std::size_t count)
+{
+    os << "{\"clusters\": [], \"iids\": [";
+    for (std::size_t n = 0; n < niids; n++)
+    {
+        os << (n ? "," : "") << "{\"id\": " << n
+           << ", \"identifiers\": [{\"type\": \"int\", \"name\": \"size\", \"value\": \"" << n
+           << "\"}]}";
+    }
+    os << "], \"regions\": [";
+    for (std::size_t n = 0; n < nregions; n++)
+    {
+        auto region = region_json(n);
+        os << (n ? "," : "") << "{\"id\": " << n << ", " << region.substr(1);
+    }
+    os << "], \"rtss\": [";
+    for (std::size_t n = 0; n < count; n++)
+    {
+        auto region = n % nregions;
+        os << (n ? "," : "") << "{\"region\": " << region << ", \"scenario\": " << n % nscenarios
+           << ", \"exectime\": 1.5, \"iid\": " << n % niids << ", \"callpath\": ["
+           << "{\"region\": " << region_json(nregions) << ", \"identifiers\": []},"
+           << "{\"region\": " << region_json((n / nregions) % nregions)
+           << ", \"identifiers\": []},"
+           << "{\"region\": " << region_json(region)
+           << ", \"identifiers\": [{\"type\": \"uint\", \"name\": \"step\", \"value\": \"" << n
+           << "\"}]}]}";
+    }
+    os << "], \"scenarios\": [";
+    for (std::size_t n = 0; n < nscenarios; n++)
+    {
+        os << (n ? "," : "") << "{\"id\": " << n
+           << ", \"configuration\": [{\"id\": \"CPU_FREQ\", \"value\": " << 1200 + n * 100
+           << "}, {\"id\": \"UNCORE_FREQ\", \"value\": " << 2000 + n * 50
+           << "}, {\"id\": \"OMP_THREADS\", \"value\": " << n % 24 + 1 << "}]}";
+    }
+    os << "]}";
+}
+
+static std::vector<callpath_element> callpath_of(std::size_t n)
+{
+    auto region = [](std::size_t r) {
+        return region_id("file" + std::to_string(r % 50) + ".c",
+            static_cast<std::uint32_t>(r),
+            "region" + std::to_string(r));
+    };
+    identifier_set ids;
+    ids.add_identifier("step", std::uint64_t(n));
+    return {{region(nregions), {}},
+        {region((n / nregions) % nregions), {}},
+        {region(n % nregions), ids}};
+}
+
+static std::size_t resident_kb()
+{
+    long pages = 0;
+    long resident = 0;
+    std::ifstream statm("/proc/self/statm");
+    statm >> pages >> resident;
+    return resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+static void run(const std::string &file_name, std::size_t count, bool lazy)
+{
+    auto before = resident_kb();
+    auto begin = std::chrono::high_resolution_clock::now();
+
+    tuning_model tm;
+    {
+        std::ifstream is(file_name);
+        tm.deserialize(is, lazy);
+    }
+
+    auto loaded = std::chrono::high_resolution_clock::now();
+    /* returns the memory of the parser to the system */
+    malloc_trim(0);
+    auto after = resident_kb();
+
+    std::size_t sum = 0;
+    auto lookup_begin = std::chrono::high_resolution_clock::now();
+    for (std::size_t n = 0; n < count; n += 100)
+    {
+        sum += tm.configurations(callpath_of(n))->size();
+    }
+    auto lookup_end = std::chrono::high_resolution_clock::now();
+    if (sum != (count + 99) / 100)
+    {
+        std::cerr << "unexpected configurations\n";
+    }
+
+    std::cout << (lazy ? "lazy:  " : "eager: ")
+              << std::chrono::duration<double, std::milli>(loaded - begin).count()
+              << " ms deserialize, " << (after - before) / 1024 << " MiB resident, "
+              << std::chrono::duration<double, std::milli>(lookup_end - lookup_begin).count()
+              << " ms for 1% of the configurations" << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    std::size_t count = argc > 1 ? std::stoul(argv[1]) : 100000;
+
+    char file_name[] = "/tmp/bench-tuning-model-loadXXXXXX";
+    int fd = mkstemp(file_name);
+    if (fd == -1)
+    {
+        std::cerr << "cannot create temporary file\n";
+        return 1;
+    }
+    close(fd);
+    {
+        std::ofstream os(file_name);
+        write_model(os, count);
+    }
+    std::cout << "rts: " << count << std::endl;
+
+    for (bool lazy : {false, true})
+    {
+        auto pid = fork();
+        if (pid == 0)
+        {
+            run(file_name, count, lazy);
+            return 0;
+        }
+        waitpid(pid, nullptr, 0);
+    }
+
+    std::remove(file_name);
+    return 0;
+}
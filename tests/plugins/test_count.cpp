@@ -0,0 +1,95 @@
+/** Stub tuning plugin for the tests, which counts its calls.
+ *
+ * It provides the tuning actions count_a and count_b with the default values 10 and 20, and
+ * implements the batched interface. The calls are counted in test_count_calls, which the tests
+ * look up with dlsym.
+ */
+
+#include <scorep/rrl_tuning_plugins.h>
+
+#include <cstring>
+
+extern "C" {
+
+/** calls of the plugin, the last array holds the current values */
+struct test_count_calls_t
+{
+    int single;
+    int batched;
+    int batched_parameters;
+    int values[2];
+} test_count_calls = {0, 0, 0, {10, 20}};
+
+static int32_t initialize()
+{
+    return 0;
+}
+
+static void finalize()
+{
+}
+
+static void location(RRL_LocationType, uint32_t)
+{
+}
+
+static int current_a()
+{
+    return test_count_calls.values[0];
+}
+
+static int current_b()
+{
+    return test_count_calls.values[1];
+}
+
+static int set_a(int value)
+{
+    test_count_calls.single++;
+    test_count_calls.values[0] = value;
+    return 0;
+}
+
+static int set_b(int value)
+{
+    test_count_calls.single++;
+    test_count_calls.values[1] = value;
+    return 0;
+}
+
+static int set_configs(uint32_t count, const uint32_t *actions, const int *values)
+{
+    test_count_calls.batched++;
+    test_count_calls.batched_parameters += count;
+    for (uint32_t n = 0; n < count; n++)
+    {
+        test_count_calls.values[actions[n]] = values[n];
+    }
+    return 0;
+}
+
+static rrl_tuning_action_info *get_tuning_info()
+{
+    static char name_a[] = "count_a";
+    static char name_b[] = "count_b";
+    static rrl_tuning_action_info infos[] = {{name_a, current_a, set_a, set_a},
+        {name_b, current_b, set_b, set_b},
+        {nullptr, nullptr, nullptr, nullptr}};
+    return infos;
+}
+
+RRL_TUNING_PLUGIN_ENTRY(test_count)
+{
+    rrl_tuning_plugin_info info;
+    std::memset(&info, 0, sizeof(rrl_tuning_plugin_info));
+    info.plugin_version = RRL_TUNING_PLUGIN_VERSION;
+    info.initialize = initialize;
+    info.finalize = finalize;
+    info.create_location = location;
+    info.delete_location = location;
+    info.get_tuning_info = get_tuning_info;
+    info.enter_region_set_configs = set_configs;
+    info.exit_region_set_configs = set_configs;
+    return info;
+}
+}
@@ -0,0 +1,74 @@
+#include "test-registry.hpp"
+
+#include <rrl/parameter_controller.hpp>
+
+#include <assert.h>
+#include <cstdlib>
+#include <dlfcn.h>
+#include <functional>
+#include <string>
+
+/** counters of the stub plugin in tests/plugins/test_count.cpp */
+struct test_count_calls_t
+{
+    int single;
+    int batched;
+    int batched_parameters;
+    int values[2];
+};
+
+/** Checks that one configuration change results in one call of a plugin with the batched
+ * interface.
+ *
+ * The stub plugin is loaded from TEST_PLUGIN_DIR before the parameter controller is created, so
+ * the controller finds it by its soname without a change of the library search path.
+ */
+static int test(const std::string &file_path)
+{
+    using namespace rrl;
+
+    setenv("SCOREP_RRL_PLUGINS", "test_count", 1);
+    unsetenv("SCOREP_RRL_ASYNC_SWITCH");
+    unsetenv("SCOREP_RRL_SWITCH_COST_FACTOR");
+    unsetenv("SCOREP_RRL_CHECK_IF_RESET");
+
+    auto handle = dlopen(TEST_PLUGIN_DIR "/libtest_count.so", RTLD_NOW);
+    assert(handle != nullptr);
+    auto &pc = parameter_controller::instance();
+    assert(pc.get_pcps().size() == 1);
+
+    auto calls = static_cast<test_count_calls_t *>(dlsym(handle, "test_count_calls"));
+    assert(calls != nullptr);
+
+    std::hash<std::string> hash;
+    auto a = hash("count_a");
+    auto b = hash("count_b");
+
+    /* both parameters change with one call */
+    assert(pc.set_parameters(pc.to_slots({{a, 1}, {b, 2}})));
+    assert(calls->batched == 1 && calls->batched_parameters == 2);
+    assert(calls->values[0] == 1 && calls->values[1] == 2);
+
+    /* only the changed parameter is passed */
+    assert(pc.set_parameters(pc.to_slots({{a, 1}, {b, 3}})));
+    assert(calls->batched == 2 && calls->batched_parameters == 3);
+    assert(calls->values[1] == 3);
+
+    /* nothing changes, so the plugin is not called */
+    assert(pc.set_parameters(pc.to_slots({{a, 1}})));
+    assert(calls->batched == 2);
+
+    pc.unset_parameters();
+    assert(calls->batched == 2);
+    pc.unset_parameters();
+    assert(calls->batched == 3 && calls->values[1] == 2);
+    pc.unset_parameters();
+    assert(calls->batched == 4 && calls->batched_parameters == 6);
+    assert(calls->values[0] == 10 && calls->values[1] == 20);
+
+    assert(calls->single == 0);
+    dlclose(handle);
+    return 0;
+}
+
+TEST_REGISTER("unit_tests/rrl/test-batched_plugin", test)
@@ -0,0 +1,92 @@
+#include "test-registry.hpp"
+
+#include <rrl/call_tree/region_node.hpp>
+
+#include <assert.h>
+#include <string>
+#include <vector>
+
+static int test(const std::string &file_path)
+{
+    using namespace rrl::call_tree;
+
+    region_node root(nullptr, node_info(0, node_type::root));
+
+    /* enough children to move them from the inline array to the hash map */
+    std::vector<base_node *> children;
+    for (std::uint32_t region = 1; region <= 10; region++)
+    {
+        auto child = root.enter_node(region);
+        assert(child->info.region_id == region);
+        assert(child->info.type == node_type::region);
+        assert(child->parent_ == &root);
+        assert(child->return_to_parent() == &root);
+        children.push_back(child);
+    }
+    for (std::uint32_t region = 1; region <= 10; region++)
+    {
+        assert(root.enter_node(region) == children[region - 1]);
+    }
+    assert(root.arena().size() == 10);
+
+    /* nested regions and additional identifiers */
+    auto child = root.enter_node(1);
+    auto grand_child = child->enter_node(2);
+    assert(grand_child != children[1]);
+    assert(child->enter_node(2) == grand_child);
+
+    std::string name = "foo";
+    auto add_id = dynamic_cast<add_id_node *>(grand_child->enter_node(name));
+    assert(add_id != nullptr);
+    assert(grand_child->enter_node(name) == add_id);
+    auto value = add_id->enter_node_uint(42);
+    assert(add_id->enter_node_uint(42) == value);
+    assert(add_id->enter_node_uint(43) != value);
+
+    auto callpath = value->build_callpath();
+    assert(callpath.size() == 2);
+    assert(callpath[0].region_id == 1);
+    assert(callpath[1].region_id == 2);
+    assert(callpath[1].id_set.uints.size() == 1);
+    assert(callpath[1].id_set.uints[0].value == 42);
+
+    assert(value->return_to_parent() == child);
+
+    /* reset_state reaches all nodes, including the ones in the hash map */
+    for (auto node : children)
+    {
+        node->info.state = node_state::known;
+    }
+    value->info.state = node_state::known;
+    root.reset_state();
+    for (auto node : children)
+    {
+        assert(node->info.state == node_state::unknown);
+    }
+    assert(value->info.state == node_state::unknown);
+
+    /* invalidate resets a single node, the arena visits all nodes */
+    rrl::tmm::callpath_table table;
+    rrl::tmm::callpath_id id;
+    assert(!value->cached_callpath_id(id));
+    auto value_id = value->callpath_id(table);
+    assert(value->cached_callpath_id(id) && id == value_id);
+    child->info.state = node_state::known;
+    value->info.state = node_state::known;
+    value->invalidate();
+    assert(value->info.state == node_state::unknown);
+    assert(child->info.state == node_state::known);
+    std::size_t nodes = 0;
+    root.arena().for_each([&nodes](base_node *) { nodes++; });
+    assert(nodes == root.arena().size());
+
+    /* a root with a parent continues the callpath of the parent, but has its own arena */
+    region_node team_root(grand_child, node_info(0, node_type::root));
+    auto worker_node = team_root.enter_node(7);
+    assert(&team_root.arena() != &root.arena());
+    assert(worker_node->build_callpath().size() == 3);
+
+    return 0;
+}
+
+TEST_REGISTER("unit_tests/rrl/test-call_tree", test)
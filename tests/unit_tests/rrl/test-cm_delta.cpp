@@ -0,0 +1,87 @@
+#include "test-registry.hpp"
+
+#include <rrl/cm/cm_base.hpp>
+
+#include <assert.h>
+#include <cstdint>
+#include <random>
+#include <string>
+
+static bool equal(const rrl::cm::slot_setting &a, const rrl::cm::slot_setting &b)
+{
+    if (a.mask != b.mask)
+    {
+        return false;
+    }
+    for (std::size_t slot = 0; slot < rrl::cm::max_slots; slot++)
+    {
+        if (a.has(slot) && a.values[slot] != b.values[slot])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static int test(const std::string &file_path)
+{
+    using namespace rrl::cm;
+
+    slot_setting defaults;
+    for (std::size_t slot = 0; slot < 4; slot++)
+    {
+        defaults.set(slot, 100 + slot);
+    }
+
+    auto delta = create_new_instance(defaults, "delta");
+    auto reset = create_new_instance(defaults, "reset");
+    assert(equal(delta->current(), defaults));
+
+    /* unset without set keeps the defaults */
+    assert(delta->unset() == 0);
+    assert(equal(delta->current(), defaults));
+
+    /* random nested configurations over TPs and ATPs behave like the full copies of cm_reset */
+    std::mt19937 gen(4711);
+    std::uniform_int_distribution<std::size_t> slot_dist(0, 9);
+    std::uniform_int_distribution<int> value_dist(0, 3);
+    std::uniform_int_distribution<int> action_dist(0, 9);
+    std::size_t depth = 0;
+    for (int n = 0; n < 100000; n++)
+    {
+        auto action = action_dist(gen);
+        if (action < 5 && depth < 100)
+        {
+            slot_setting config;
+            for (int k = value_dist(gen); k >= 0; k--)
+            {
+                config.set(slot_dist(gen), value_dist(gen));
+            }
+            delta->set(config);
+            reset->set(config);
+            depth++;
+        }
+        else if (action < 9 && depth > 0)
+        {
+            assert(delta->unset() == reset->unset());
+            depth--;
+        }
+        else
+        {
+            auto slot = slot_dist(gen);
+            auto value = value_dist(gen);
+            delta->atp_add(slot, value);
+            reset->atp_add(slot, value);
+        }
+        assert(equal(delta->current(), reset->current()));
+    }
+
+    while (depth-- > 0)
+    {
+        assert(delta->unset() == reset->unset());
+    }
+    assert(equal(delta->current(), reset->current()));
+    return 0;
+}
+
+TEST_REGISTER("unit_tests/rrl/test-cm_delta", test)
@@ -0,0 +1,105 @@
+#include "test-registry.hpp"
+
+#include <rrl/overhead_statistics.hpp>
+
+#include <assert.h>
+#include <chrono>
+#include <cstdint>
+#include <new>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+static int test(const std::string &file_path)
+{
+    using namespace rrl;
+
+    /* every value has to end up in a bucket whose bounds contain it */
+    std::vector<std::uint64_t> values = {
+        0, 1, 15, 16, 17, 31, 32, 33, 1000, 123456, 1ull << 40, (1ull << 40) + 1, UINT64_MAX};
+    for (auto value : values)
+    {
+        auto index = latency_histogram::index_of(value);
+        assert(index < latency_histogram::bucket_count);
+        assert(latency_histogram::lowest_value_of(index) <= value);
+        assert(latency_histogram::highest_value_of(index) >= value);
+    }
+    for (std::size_t i = 0; i + 1 < latency_histogram::bucket_count; i++)
+    {
+        assert(latency_histogram::highest_value_of(i) + 1 ==
+               latency_histogram::lowest_value_of(i + 1));
+    }
+
+    /* percentiles of 1..10000 have to be within the relative error of the histogram */
+    latency_histogram histogram;
+    for (std::uint64_t i = 1; i <= 10000; i++)
+    {
+        histogram.record(i);
+    }
+    assert(histogram.count() == 10000);
+    assert(histogram.max() == 10000);
+    for (double percent : {50.0, 90.0, 99.0, 99.9})
+    {
+        double expected = percent * 100;
+        double reported = histogram.percentile(percent);
+        assert(reported >= expected);
+        assert(reported <= expected * (1 + 1.0 / latency_histogram::sub_buckets));
+    }
+    assert(histogram.percentile(100) == 10000);
+    assert(latency_histogram().percentile(50) == 0);
+
+    /* statistics recorded by different threads are merged */
+    overhead_statistics statistics({"a", "b"});
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++)
+    {
+        threads.emplace_back([&statistics, t]() {
+            for (int i = 0; i < 1000; i++)
+            {
+                statistics.record(0, std::chrono::nanoseconds(t * 1000 + i));
+            }
+            statistics.record(1, std::chrono::nanoseconds(7));
+        });
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+    statistics.record(1, std::chrono::nanoseconds(7));
+
+    auto merged = statistics.merge();
+    assert(merged.size() == 2);
+    assert(merged[0].count == 4000);
+    assert(merged[0].histogram.count() == 4000);
+    assert(merged[0].histogram.max() == 3999);
+    assert(merged[0].duration.count() == 4000 * 3999 / 2);
+    assert(merged[1].count == 5);
+    assert(merged[1].histogram.percentile(50) == 7);
+
+    /* a thread alternating between instances records into the statistics of each */
+    overhead_statistics other({"a"});
+    for (int i = 0; i < 10; i++)
+    {
+        statistics.record(0, std::chrono::nanoseconds(1));
+        other.record(0, std::chrono::nanoseconds(1));
+    }
+    assert(statistics.merge()[0].count == 4010);
+    assert(other.merge()[0].count == 10);
+
+    /* a new instance at the address of a destroyed one starts with empty statistics */
+    typename std::aligned_storage<sizeof(overhead_statistics), alignof(overhead_statistics)>::type
+        storage;
+    auto first = new (&storage) overhead_statistics({"a"});
+    first->record(0, std::chrono::nanoseconds(1));
+    first->~overhead_statistics();
+    auto second = new (&storage) overhead_statistics({"a"});
+    assert(second->merge()[0].count == 0);
+    second->record(0, std::chrono::nanoseconds(1));
+    assert(second->merge()[0].count == 1);
+    second->~overhead_statistics();
+
+    return 0;
+}
+
+TEST_REGISTER("unit_tests/rrl/test-overhead_statistics", test)
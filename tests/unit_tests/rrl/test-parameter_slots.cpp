@@ -0,0 +1,107 @@
+#include "test-registry.hpp"
+
+#include <rrl/cm/cm_base.hpp>
+#include <rrl/cm/parameter_slots.hpp>
+
+#include <assert.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+static std::uint64_t bit(std::size_t slot)
+{
+    return std::uint64_t(1) << slot;
+}
+
+static int test(const std::string &file_path)
+{
+    using namespace rrl::cm;
+
+    /* slots are dense and stable */
+    parameter_slots slots;
+    assert(slots.find(4711) == parameter_slots::npos);
+    assert(slots.add(4711) == 0);
+    assert(slots.add(42) == 1);
+    assert(slots.add(4711) == 0);
+    assert(slots.find(42) == 1);
+    assert(slots.id(1) == 42);
+    assert(slots.size() == 2);
+
+    /* unknown parameters get a slot when first seen */
+    auto setting = slots.to_slots({{42, 3}, {7, 5}});
+    assert(slots.find(7) == 2);
+    assert(setting.mask == (bit(1) | bit(2)));
+    assert(setting.values[1] == 3 && setting.values[2] == 5);
+    auto configs = slots.to_tuples(setting);
+    assert(configs.size() == 2);
+    assert(configs[0].parameter_id == 42 && configs[0].parameter_value == 3);
+    assert(configs[1].parameter_id == 7 && configs[1].parameter_value == 5);
+
+    /* changes contains the slots of target which differ or which current does not have */
+    slot_setting current;
+    current.set(0, 1);
+    current.set(1, 1);
+    slot_setting target;
+    target.set(1, 1);
+    target.set(2, 1);
+    assert(slot_setting::changes(current, target) == bit(2));
+    target.set(1, 2);
+    assert(slot_setting::changes(current, target) == (bit(1) | bit(2)));
+    target.set(63, 0);
+    assert(slot_setting::changes(current, target) == (bit(1) | bit(2) | bit(63)));
+
+    current.merge(target);
+    assert(current.mask == (bit(0) | bit(1) | bit(2) | bit(63)));
+    assert(current.values[0] == 1 && current.values[1] == 2 && current.values[2] == 1);
+    assert(slot_setting::changes(current, target) == 0);
+
+    std::vector<std::size_t> visited;
+    for_each_slot(bit(0) | bit(5) | bit(63), [&visited](std::size_t slot) {
+        visited.push_back(slot);
+    });
+    assert(visited == (std::vector<std::size_t>{0, 5, 63}));
+
+    /* all slots are used */
+    for (std::size_t id = 100; slots.size() < max_slots; id++)
+    {
+        slots.add(id);
+    }
+    assert(slots.add(1) == parameter_slots::npos);
+    /* the ignored parameter is only reported once */
+    assert(slots.add(1) == parameter_slots::npos);
+    assert(slots.to_slots({{1, 5}, {4711, 6}}).mask == bit(0));
+    assert(slots.find(4711) == 0);
+
+    /* unset returns the slots whose value changes back, parameters without value before are not
+     * restored */
+    slot_setting defaults;
+    defaults.set(0, 10);
+    defaults.set(1, 20);
+    auto reset = create_new_instance(defaults, "reset");
+    slot_setting first;
+    first.set(0, 11);
+    reset->set(first);
+    slot_setting second;
+    second.set(0, 11);
+    second.set(1, 21);
+    second.set(2, 31);
+    reset->set(second);
+    assert(reset->current().values[1] == 21 && reset->current().has(2));
+    reset->atp_add(3, 41);
+    assert(reset->unset() == bit(1));
+    assert(reset->current().values[0] == 11 && reset->current().values[1] == 20);
+    assert(!reset->current().has(2));
+    assert(reset->unset() == bit(0));
+    assert(reset->current().values[0] == 10);
+    assert(reset->unset() == 0);
+
+    /* without reset, the values stay */
+    auto no_reset = create_new_instance(defaults, "no_reset");
+    no_reset->set(second);
+    assert(no_reset->unset() == 0);
+    assert(no_reset->current().values[1] == 21);
+
+    return 0;
+}
+
+TEST_REGISTER("unit_tests/rrl/test-parameter_slots", test)
@@ -0,0 +1,119 @@
+#include "test-registry.hpp"
+
+#include <rrl/parameter_switcher.hpp>
+
+#include <assert.h>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <vector>
+
+using namespace rrl;
+
+using call = std::tuple<std::size_t, int, bool>;
+
+/** records the calls of the switcher thread
+ */
+class recorder
+{
+public:
+    parameter_switcher::apply_function function()
+    {
+        return [this](tmm::parameter_tuple config, bool unset) {
+            std::lock_guard<std::mutex> lock(lock_);
+            calls_.emplace_back(config.parameter_id, config.parameter_value, unset);
+        };
+    }
+
+    std::vector<call> take()
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        auto result = std::move(calls_);
+        calls_.clear();
+        return result;
+    }
+
+private:
+    std::mutex lock_;
+    std::vector<call> calls_;
+};
+
+static int test(const std::string &file_path)
+{
+    const std::vector<tmm::parameter_tuple> defaults = {{1, 1}, {2, 1}};
+    recorder calls;
+
+    /* without delay, every submitted change is applied */
+    {
+        parameter_switcher switcher(defaults, calls.function(), std::chrono::microseconds(0));
+        switcher.request({1, 2}, false);
+        switcher.submit();
+        switcher.flush();
+        assert(calls.take() == std::vector<call>{call(1, 2, false)});
+        auto statistics = switcher.statistics();
+        assert(statistics.requests == 1 && statistics.coalesced == 0);
+        assert(statistics.latency.count == 1 && statistics.duration.count == 1);
+
+        /* a value that is already applied is not set again */
+        switcher.request({2, 1}, true);
+        switcher.flush();
+        assert(calls.take().empty());
+        assert(switcher.statistics().coalesced == 1);
+    }
+
+    /* the set and unset of a short region within the delay cancel each other out */
+    {
+        parameter_switcher switcher(defaults, calls.function(), std::chrono::milliseconds(200));
+        switcher.request({1, 2}, false);
+        switcher.request({2, 3}, false);
+        switcher.submit();
+        switcher.request({1, 1}, true);
+        switcher.request({2, 1}, true);
+        switcher.submit();
+        switcher.flush();
+        assert(calls.take().empty());
+
+        /* only the final value of each parameter is applied */
+        switcher.request({1, 5}, false);
+        switcher.submit();
+        switcher.request({1, 6}, false);
+        switcher.request({2, 3}, false);
+        switcher.submit();
+        switcher.flush();
+        auto applied = calls.take();
+        assert(applied.size() == 2);
+        assert((applied[0] == call(1, 6, false) && applied[1] == call(2, 3, false)) ||
+               (applied[0] == call(2, 3, false) && applied[1] == call(1, 6, false)));
+        auto statistics = switcher.statistics();
+        assert(statistics.requests == 7 && statistics.coalesced == 5);
+    }
+
+    /* more requests than the queue can hold */
+    {
+        parameter_switcher switcher(defaults, calls.function(), std::chrono::microseconds(0), 4);
+        for (int n = 0; n < 1000; n++)
+        {
+            switcher.request({1, n}, n % 2 == 1);
+        }
+        switcher.flush();
+        auto applied = calls.take();
+        assert(!applied.empty() && applied.back() == call(1, 999, true));
+        assert(switcher.statistics().requests == 1000);
+    }
+
+    /* pending changes are applied when the switcher is destroyed, without waiting for the delay */
+    {
+        auto begin = std::chrono::steady_clock::now();
+        {
+            parameter_switcher switcher(defaults, calls.function(), std::chrono::seconds(10));
+            switcher.request({2, 4}, false);
+            switcher.submit();
+        }
+        assert(std::chrono::steady_clock::now() - begin < std::chrono::seconds(5));
+        assert(calls.take() == std::vector<call>{call(2, 4, false)});
+    }
+    return 0;
+}
+
+TEST_REGISTER("unit_tests/rrl/test-parameter_switcher", test)
@@ -0,0 +1,86 @@
+#include "test-registry.hpp"
+
+#include <rrl/pattern_set.hpp>
+
+#include <assert.h>
+#include <fnmatch.h>
+#include <string>
+#include <vector>
+
+static int test(const std::string &file_path)
+{
+    using namespace rrl;
+
+    std::vector<std::string> patterns = {"main",
+        "MPI_*",
+        "*_omp_fn.0",
+        "*",
+        "foo?bar",
+        "[ab]baz*",
+        "pre*post",
+        "esc\\#aped",
+        "",
+        "exact*name*"};
+    std::vector<std::string> names = {"main",
+        "main2",
+        "MPI_Send",
+        "MPI_",
+        "mpi_send",
+        "solve._omp_fn.0",
+        "_omp_fn.0",
+        "fooXbar",
+        "foobar",
+        "abaz",
+        "bbazinga",
+        "cbaz",
+        "pre_and_post",
+        "prepost",
+        "esc#aped",
+        "",
+        "exact_name_",
+        "exactname"};
+
+    /* each single pattern has to behave exactly like fnmatch */
+    for (const auto &pattern : patterns)
+    {
+        pattern_set set;
+        set.add(pattern);
+        assert(set.size() == 1);
+        for (const auto &name : names)
+        {
+            bool expected = fnmatch(pattern.c_str(), name.c_str(), 0) == 0;
+            assert(set.match(name) == expected);
+        }
+    }
+
+    /* all patterns but "*" together */
+    pattern_set set;
+    for (const auto &pattern : patterns)
+    {
+        if (pattern != "*")
+        {
+            set.add(pattern);
+        }
+    }
+    assert(set.size() == patterns.size() - 1);
+    for (const auto &name : names)
+    {
+        bool expected = false;
+        for (const auto &pattern : patterns)
+        {
+            if (pattern != "*" && fnmatch(pattern.c_str(), name.c_str(), 0) == 0)
+            {
+                expected = true;
+            }
+        }
+        assert(set.match(name) == expected);
+    }
+
+    pattern_set empty_set;
+    assert(empty_set.empty());
+    assert(!empty_set.match("main"));
+
+    return 0;
+}
+
+TEST_REGISTER("unit_tests/rrl/test-pattern_set", test)
@@ -0,0 +1,56 @@
+#include "test-registry.hpp"
+
+#include <rrl/phase_classifier.hpp>
+
+#include <assert.h>
+#include <cmath>
+#include <string>
+#include <vector>
+
+static int test(const std::string &file_path)
+{
+    using namespace rrl;
+
+    std::unordered_map<int, tmm::phase_data_t> clusters;
+    clusters[3] = tmm::phase_data_t({1, 2}, {{"duration", {0.0, 1.0}}, {"energy", {0.0, 100.0}}});
+    clusters[1] = tmm::phase_data_t({3}, {{"duration", {1.0, 2.0}}});
+    clusters[7] = tmm::phase_data_t({4, 5}, {{"duration", {0.5, 3.0}}, {"energy", {50.0, 60.0}}});
+
+    phase_classifier classifier(clusters);
+    assert(classifier.features() == std::vector<std::string>({"duration", "energy"}));
+
+    auto nan = std::nan("");
+    assert(classifier.classify({0.2, 10.0}) == 3);
+    /* ranges are closed, and the lowest id wins */
+    assert(classifier.classify({1.0, 10.0}) == 1);
+    assert(classifier.classify({0.0, 0.0}) == 3);
+    assert(classifier.classify({0.7, 55.0}) == 3);
+    assert(classifier.classify({2.5, 55.0}) == 7);
+    /* cluster 1 ignores the energy */
+    assert(classifier.classify({1.5, 1000.0}) == 1);
+    assert(classifier.classify({2.5, 10.0}) == phase_classifier::no_cluster);
+    assert(classifier.classify({-1.0, 10.0}) == phase_classifier::no_cluster);
+    assert(classifier.classify({5.0, nan}) == phase_classifier::no_cluster);
+    /* values which are not known are ignored, but one has to be known */
+    assert(classifier.classify({nan, 55.0}) == 3);
+    assert(classifier.classify({nan, 70.0}) == 3);
+    assert(classifier.classify({nan, nan}) == phase_classifier::no_cluster);
+    assert(classifier.classify({}) == phase_classifier::no_cluster);
+
+    /* more clusters than bits in a word */
+    std::unordered_map<int, tmm::phase_data_t> many;
+    for (int i = 0; i < 200; i++)
+        many[i] = tmm::phase_data_t({}, {{"duration", {i * 1.0, i + 0.5}}});
+    phase_classifier many_classifier(many);
+    assert(many_classifier.classify({0.25}) == 0);
+    assert(many_classifier.classify({150.5}) == 150);
+    assert(many_classifier.classify({199.0}) == 199);
+    assert(many_classifier.classify({150.75}) == phase_classifier::no_cluster);
+
+    phase_classifier empty({});
+    assert(empty.classify({1.0}) == phase_classifier::no_cluster);
+
+    return 0;
+}
+
+TEST_REGISTER("unit_tests/rrl/test-phase_classifier", test)
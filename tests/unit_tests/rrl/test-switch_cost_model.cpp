@@ -0,0 +1,54 @@
+#include "test-registry.hpp"
+
+#include <rrl/switch_cost_model.hpp>
+
+#include <assert.h>
+#include <chrono>
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+
+static int test(const std::string &file_path)
+{
+    using namespace rrl;
+    using std::chrono::microseconds;
+    using std::chrono::milliseconds;
+
+    switch_cost_model model(10);
+    model.add_parameter(1, microseconds(100));
+    model.add_parameter(2, microseconds(400));
+    assert(model.latency(1) == microseconds(100));
+    assert(model.latency(3) == microseconds(0));
+
+    auto mask = [](std::initializer_list<std::size_t> slots) {
+        std::uint64_t mask = 0;
+        for (auto slot : slots)
+        {
+            mask |= std::uint64_t(1) << slot;
+        }
+        return mask;
+    };
+
+    /* only parameters that change are counted, for the switch and back */
+    assert(model.cost(0) == microseconds(0));
+    assert(model.cost(mask({1})) == microseconds(200));
+    assert(model.cost(mask({1, 2})) == microseconds(1000));
+    /* ATPs have no latency */
+    assert(model.cost(mask({3, 63})) == microseconds(0));
+
+    /* a region has to be factor times longer than the cost */
+    assert(model.pays_off(mask({1, 2}), milliseconds(10)));
+    assert(!model.pays_off(mask({1, 2}), milliseconds(9)));
+    assert(model.pays_off(mask({3}), milliseconds(0)));
+    assert(model.pays_off(mask({2}), milliseconds::max()));
+
+    /* measured switches move the latency towards the measurement */
+    for (int n = 0; n < 100; n++)
+    {
+        model.record(1, microseconds(900));
+    }
+    assert(model.latency(1) > microseconds(850) && model.latency(1) <= microseconds(900));
+    return 0;
+}
+
+TEST_REGISTER("unit_tests/rrl/test-switch_cost_model", test)
@@ -0,0 +1,63 @@
+#include "test-registry.hpp"
+
+#include <rrl/call_tree/region_node.hpp>
+#include <rrl/team_registry.hpp>
+
+#include <assert.h>
+#include <string>
+
+static int test(const std::string &file_path)
+{
+    using namespace rrl;
+    using namespace rrl::call_tree;
+
+    region_node root(nullptr, node_info(0, node_type::root));
+    auto outer_node = root.enter_node(1);
+    auto nested_node = outer_node->enter_node(2);
+    auto worker_node = root.enter_node(3);
+
+    team_registry teams;
+    assert(teams.node(teams.new_member(0)) == nullptr);
+
+    /* the outer team of the master */
+    teams.fork(0, outer_node);
+    auto outer_worker = teams.new_member(0);
+    auto late_outer_worker = teams.new_member(0);
+    assert(teams.node(outer_worker) == outer_node);
+
+    /* a nested team of a worker does not change the team of the outer workers */
+    teams.fork(5, worker_node);
+    auto nested_worker = teams.new_member(5);
+    assert(teams.node(nested_worker) == worker_node);
+    assert(teams.node(late_outer_worker) == outer_node);
+
+    /* neither does a nested team of the master */
+    teams.fork(0, nested_node);
+    auto nested_master_worker = teams.new_member(0);
+    assert(teams.node(nested_master_worker) == nested_node);
+    assert(teams.node(late_outer_worker) == outer_node);
+
+    teams.join(0);
+    teams.join(5);
+    assert(teams.node(nested_master_worker) == nullptr);
+    assert(teams.node(nested_worker) == nullptr);
+    assert(teams.node(outer_worker) == outer_node);
+
+    /* workers entering after the join are not attached */
+    teams.join(0);
+    assert(teams.node(late_outer_worker) == nullptr);
+
+    /* the next team reuses the workers of the pool */
+    teams.fork(0, worker_node);
+    assert(teams.node(outer_worker) == worker_node);
+    assert(teams.node(nested_master_worker) == nullptr);
+    teams.join(0);
+
+    /* a team forked outside of the root is not tuned */
+    teams.fork(0, nullptr);
+    assert(teams.node(teams.new_member(0)) == nullptr);
+    teams.join(0);
+    return 0;
+}
+
+TEST_REGISTER("unit_tests/rrl/test-team_registry", test)
@@ -0,0 +1,210 @@
+#include "test-registry.hpp"
+
+#include <tmm/binary_model.hpp>
+#include <tmm/parameter_tuple.hpp>
+#include <tmm/tuning_model.hpp>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <stdexcept>
+
+#include <unistd.h>
+
+using namespace rrl::tmm;
+
+/** copies the binary model to memory aligned to 8 bytes */
+static std::shared_ptr<const binary_model> to_binary(const tuning_model &tm)
+{
+    std::ostringstream os;
+    binary_model::write(tm, os);
+    auto s = os.str();
+
+    std::shared_ptr<char> data(
+        reinterpret_cast<char *>(new std::uint64_t[s.size() / 8 + 1]), [](char *p) {
+            delete[] reinterpret_cast<std::uint64_t *>(p);
+        });
+    std::memcpy(data.get(), s.data(), s.size());
+    return std::make_shared<const binary_model>(data, s.size());
+}
+
+static binary::header *header_of(char *data)
+{
+    return reinterpret_cast<binary::header *>(data);
+}
+
+/** returns a record of an unchecked binary model */
+template <typename Record> static Record &record(char *data, binary::section s, std::size_t index)
+{
+    return reinterpret_cast<Record *>(data + header_of(data)->sections[s].offset)[index];
+}
+
+/** checks if the binary model s is rejected after it is modified by corrupt */
+static bool rejected(const std::string &s, std::function<void(char *)> corrupt)
+{
+    std::shared_ptr<char> data(
+        reinterpret_cast<char *>(new std::uint64_t[s.size() / 8 + 1]), [](char *p) {
+            delete[] reinterpret_cast<std::uint64_t *>(p);
+        });
+    std::memcpy(data.get(), s.data(), s.size());
+    corrupt(data.get());
+    try
+    {
+        binary_model model(data, s.size());
+    }
+    catch (std::runtime_error &)
+    {
+        return true;
+    }
+    return false;
+}
+
+static void test_stored_model()
+{
+    region_id main("main.c", 1, "main");
+    region_id r0("foo.c", 45, "r0");
+    identifier_set ids;
+    ids.add_identifier("p3", std::string("foobar"));
+    ids.add_identifier("p4", std::uint64_t(4));
+    ids.add_identifier("p5", std::int64_t(-5));
+
+    std::vector<callpath_element> cp1({{main, {}}, {r0, ids}});
+    std::vector<callpath_element> cp2({{main, {}}, {r0, {}}});
+
+    tuning_model tm;
+    tm.store_configuration(cp1, {parameter_tuple(1, 42), parameter_tuple(2, 3)},
+        std::chrono::milliseconds(100));
+    tm.store_configuration(cp2, {parameter_tuple(1, 43)}, std::chrono::milliseconds(200));
+
+    tuning_model binary_tm;
+    binary_tm.load_binary(to_binary(tm));
+
+    assert(binary_tm.ncallpaths() == 2);
+    assert(binary_tm.has_rts(cp1));
+    assert(binary_tm.has_rts(cp2));
+    assert(!binary_tm.has_rts({{main, {}}}));
+    assert(binary_tm.exectime(cp1) == std::chrono::milliseconds(100));
+    assert(binary_tm.exectime(cp2) == std::chrono::milliseconds(200));
+    assert(binary_tm.ninputidsets(cp1) == 1);
+    assert(binary_tm.is_root({main, {}}));
+    assert(!binary_tm.is_root({r0, {}}));
+
+    auto configurations = binary_tm.configurations(cp1);
+    assert(configurations != nullptr);
+    assert(*configurations == *tm.configurations(cp1));
+    assert(binary_tm.configurations(cp1) == configurations);
+    assert(binary_tm.configurations({{main, {}}}) == nullptr);
+
+    /* configurations stored later take precedence over the binary model */
+    binary_tm.store_configuration(cp1, {parameter_tuple(1, 44)}, std::chrono::milliseconds(50));
+    assert(binary_tm.ncallpaths() == 2);
+    assert(binary_tm.exectime(cp1) == std::chrono::milliseconds(50));
+    assert(binary_tm.configurations(cp1)->begin()->second.at(1) == 44);
+
+    /* files written with other hash functions or versions are rejected */
+    std::ostringstream os;
+    binary_model::write(tm, os);
+    auto s = os.str();
+    assert(!rejected(s, [](char *data) {}));
+    assert(rejected(s, [](char *data) { header_of(data)->hash_fingerprint++; }));
+
+    /* as well as records that reference other records or strings outside of their section */
+    assert(rejected(s, [](char *data) {
+        record<binary::element_record>(data, binary::elements, 1).region = 1000;
+    }));
+    assert(rejected(s, [](char *data) {
+        record<binary::element_record>(data, binary::elements, 1).id_set = ~0ull;
+    }));
+    assert(rejected(s, [](char *data) {
+        record<binary::callpath_record>(data, binary::callpaths, 0).nelements = 1000;
+    }));
+    assert(rejected(s, [](char *data) {
+        record<binary::callpath_record>(data, binary::callpaths, 1).first_scenario = ~0ull;
+    }));
+    assert(rejected(s, [](char *data) {
+        record<binary::scenario_record>(data, binary::scenarios, 0).nparameters = 1000;
+    }));
+    assert(rejected(s, [](char *data) {
+        record<binary::scenario_record>(data, binary::scenarios, 0).input_id_set = 1000;
+    }));
+    assert(rejected(s, [](char *data) {
+        record<binary::id_set_record>(data, binary::id_sets, 0).nstrings = 1000;
+    }));
+    assert(rejected(s, [](char *data) {
+        record<binary::region_record>(data, binary::regions, 0).name.length = 100000;
+    }));
+    assert(rejected(s, [](char *data) {
+        record<binary::identifier_record>(data, binary::identifiers, 0).string.offset = ~0u;
+    }));
+}
+
+static void test_deserialized_model(const std::string &json_path)
+{
+    std::ifstream is(json_path);
+    tuning_model tm;
+    tm.deserialize(is);
+
+    /* convert through a file, like tmviewer -b */
+    char file_name[] = "/tmp/test-binary_modelXXXXXX";
+    int fd = mkstemp(file_name);
+    assert(fd != -1);
+    close(fd);
+    {
+        std::ofstream os(file_name, std::ios::binary);
+        binary_model::write(tm, os);
+    }
+    assert(binary_model::is_binary(file_name));
+    assert(!binary_model::is_binary(json_path));
+
+    tuning_model binary_tm;
+    binary_tm.load_binary(binary_model::map(file_name));
+    std::remove(file_name);
+
+    region_id main("main.c", 1, "main");
+    region_id reg("reg.c", 90, "reg");
+    region_id r0("foo.c", 45, "r0");
+    region_id r1("bar.c", 12, "r1");
+
+    identifier_set ids0;
+    identifier_set ids1;
+    ids0.add_identifier("p3", "foobar");
+    ids1.add_identifier("p1", "bla");
+
+    std::vector<callpath_element> cp1({{main, {}}, {r0, {ids0}}});
+    std::vector<callpath_element> cp2({{main, {}}, {r1, {ids1}}});
+    std::vector<callpath_element> cp3({{main, {}}, {reg, {ids1}}, {r1, {ids1}}});
+
+    assert(binary_tm.ncallpaths() == tm.ncallpaths());
+    assert(!binary_tm.has_region(main));
+    assert(binary_tm.has_region(r0));
+    assert(binary_tm.has_region(r1));
+    assert(binary_tm.nidentifiers(r0) == 1);
+    assert(binary_tm.nidentifiers(r1) == 1);
+
+    for (const auto &cp : {cp1, cp2, cp3})
+    {
+        assert(binary_tm.has_rts(cp));
+        assert(binary_tm.ninputidsets(cp) == tm.ninputidsets(cp));
+        assert(binary_tm.exectime(cp) == tm.exectime(cp));
+        assert(*binary_tm.configurations(cp) == *tm.configurations(cp));
+    }
+    assert(binary_tm.is_root({main, {}}));
+
+    assert(binary_tm.clusters().size() == 2);
+    assert(binary_tm.clusters() == tm.clusters());
+}
+
+static int test(const std::string &file_path)
+{
+    test_stored_model();
+
+    /* uses the model of test-deserialization */
+    auto directory = file_path.substr(0, file_path.find_last_of('/'));
+    test_deserialized_model(directory + "/test-deserialization.json");
+
+    return 0;
+}
+
+TEST_REGISTER("unit_tests/tmm/test-binary_model", test)
@@ -0,0 +1,114 @@
+#include "test-registry.hpp"
+
+#include <tmm/simple_callpath.hpp>
+
+#include <assert.h>
+#include <random>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+using namespace rrl::tmm;
+
+using callpath = std::vector<simple_callpath_element>;
+
+/** Generates callpaths as they occur in applications: all start with the same phase region, many
+ * share long prefixes, and some regions carry an uint identifier like an iteration counter.
+ */
+static std::unordered_set<callpath> generate_callpaths(std::size_t count)
+{
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<std::uint32_t> region_id(1, 3000);
+    std::uniform_int_distribution<std::size_t> depth(1, 12);
+    std::uniform_int_distribution<std::uint64_t> iteration(0, 999);
+    std::bernoulli_distribution has_identifier(0.1);
+
+    std::unordered_set<callpath> callpaths;
+    while (callpaths.size() < count)
+    {
+        callpath cp = {simple_callpath_element(1, identifier_set())};
+        auto d = depth(generator);
+        for (std::size_t i = 0; i < d; i++)
+        {
+            identifier_set ids;
+            if (has_identifier(generator))
+            {
+                ids.uints.push_back(identifier<std::uint64_t>(7, iteration(generator)));
+            }
+            cp.push_back(simple_callpath_element(region_id(generator) % (100 * (i + 1)), ids));
+        }
+        callpaths.insert(cp);
+    }
+
+    /* the same callpath, only differing in the value of the identifier of the last element */
+    callpath base = {simple_callpath_element(1, identifier_set()),
+        simple_callpath_element(12, identifier_set()),
+        simple_callpath_element(13, identifier_set())};
+    for (std::uint64_t value = 0; value < 10000; value++)
+    {
+        auto cp = base;
+        cp.back().id_set.uints.push_back(identifier<std::uint64_t>(7, value));
+        callpaths.insert(cp);
+    }
+    return callpaths;
+}
+
+static int test(const std::string &file_path)
+{
+    std::hash<callpath> hasher;
+
+    /* structurally different callpaths */
+    simple_callpath_element a(1, identifier_set());
+    simple_callpath_element b(2, identifier_set());
+    assert(hasher({a, b}) != hasher({b, a}));
+    assert(hasher({a}) != hasher({a, a}));
+    assert(hasher({}) != hasher({simple_callpath_element(0, identifier_set())}));
+
+    identifier_set uint_ids;
+    uint_ids.uints.push_back(identifier<std::uint64_t>(3, 4));
+    identifier_set int_ids;
+    int_ids.ints.push_back(identifier<std::int64_t>(3, 4));
+    identifier_set swapped_ids;
+    swapped_ids.uints.push_back(identifier<std::uint64_t>(4, 3));
+    std::hash<identifier_set> id_hasher;
+    assert(id_hasher(uint_ids) != id_hasher(int_ids));
+    assert(id_hasher(uint_ids) != id_hasher(swapped_ids));
+    assert(id_hasher(uint_ids) != id_hasher(identifier_set()));
+
+    identifier_set string_ids;
+    string_ids.add_identifier("input", std::string("small"));
+    identifier_set other_string_ids;
+    other_string_ids.add_identifier("input", std::string("large"));
+    assert(id_hasher(string_ids) != id_hasher(other_string_ids));
+
+    /* equal callpaths have equal hashes */
+    simple_callpath_element c(5, uint_ids);
+    simple_callpath_element d(5, uint_ids);
+    assert(hasher({a, c}) == hasher({a, d}));
+
+    /* no 64 bit collisions, and an even distribution of the low bits over the buckets */
+    auto callpaths = generate_callpaths(200000);
+    std::unordered_set<std::size_t> hashes;
+    const std::size_t buckets = 1024;
+    std::vector<std::size_t> bucket_load(buckets, 0);
+    for (const auto &cp : callpaths)
+    {
+        auto h = hasher(cp);
+        hashes.insert(h);
+        bucket_load[h % buckets]++;
+    }
+    assert(hashes.size() == callpaths.size());
+
+    double expected = static_cast<double>(callpaths.size()) / buckets;
+    double chi_square = 0;
+    for (auto load : bucket_load)
+    {
+        chi_square += (load - expected) * (load - expected) / expected;
+    }
+    /* the chi square statistic has a mean of buckets - 1 and a standard deviation of ~45 */
+    assert(chi_square < buckets + 300);
+
+    return 0;
+}
+
+TEST_REGISTER("unit_tests/tmm/test-callpath_hash", test)
@@ -0,0 +1,50 @@
+#include "test-registry.hpp"
+
+#include <rrl/call_tree/region_node.hpp>
+#include <tmm/callpath_table.hpp>
+
+#include <assert.h>
+#include <string>
+#include <vector>
+
+static int test(const std::string &file_path)
+{
+    using namespace rrl;
+
+    tmm::callpath_table table;
+
+    std::vector<tmm::simple_callpath_element> a = {
+        tmm::simple_callpath_element(1, tmm::identifier_set()),
+        tmm::simple_callpath_element(2, tmm::identifier_set())};
+    std::vector<tmm::simple_callpath_element> b = {
+        tmm::simple_callpath_element(2, tmm::identifier_set()),
+        tmm::simple_callpath_element(1, tmm::identifier_set())};
+
+    auto id_a = table.intern(a);
+    auto id_b = table.intern(b);
+    assert(id_a != id_b);
+    assert(table.intern(a) == id_a);
+    assert(table.callpath(id_a) == a);
+    assert(table.hash(id_a) == tmm::callpath_table::hash_callpath(a));
+    assert(table.size() == 2);
+
+    /* identifiers are part of the callpath */
+    auto c = a;
+    c.back().id_set.uints.push_back(tmm::identifier<std::uint64_t>(1, 42));
+    assert(table.intern(c) != id_a);
+    assert(table.size() == 3);
+
+    /* the nodes of a call tree cache their callpath id */
+    call_tree::region_node root(nullptr, call_tree::node_info(0, call_tree::node_type::root));
+    auto node = root.enter_node(1)->enter_node(2);
+    assert(node->callpath_id(table) == id_a);
+    assert(node->callpath_id(table) == id_a);
+    assert(table.size() == 3);
+
+    auto other = root.enter_node(2)->enter_node(1);
+    assert(other->callpath_id(table) == id_b);
+
+    return 0;
+}
+
+TEST_REGISTER("unit_tests/tmm/test-callpath_table", test)
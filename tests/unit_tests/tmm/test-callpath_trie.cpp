@@ -0,0 +1,62 @@
+#include "test-registry.hpp"
+
+#include <tmm/callpath_trie.hpp>
+
+#include <assert.h>
+#include <string>
+#include <vector>
+
+static int test(const std::string &file_path)
+{
+    using namespace rrl::tmm;
+
+    region_id main("main.c", 1, "main");
+    region_id r0("foo.c", 45, "r0");
+    region_id r1("bar.c", 12, "r1");
+    identifier_set ids;
+    ids.add_identifier("p3", std::string("foobar"));
+
+    std::vector<callpath_element> a({{main, {}}, {r0, ids}});
+    std::vector<callpath_element> b({{main, {}}, {r0, {}}, {r1, {}}});
+    std::vector<callpath_element> c({{main, {}}, {r0, ids}, {r1, {}}});
+
+    callpath_trie trie;
+    assert(trie.size() == 1);
+    assert(trie.root().depth == 0);
+    assert(trie.find({}) == &trie.root());
+    assert(trie.find(a) == nullptr);
+
+    auto node_a = trie.insert(a);
+    node_a->value = 0;
+    auto node_b = trie.insert(b);
+    node_b->value = 1;
+    assert(trie.size() == 5);
+    assert(trie.insert(a) == node_a);
+    assert(trie.find(a) == node_a);
+    assert(trie.find(b) == node_b);
+    assert(node_b->depth == 3);
+    assert(trie.path(*node_b) == b);
+
+    /* the nodes of the prefixes exist, but have no value */
+    auto prefix = trie.find({{main, {}}});
+    assert(prefix != nullptr && !prefix->has_value());
+    assert(trie.child(trie.root(), {main, {}}) == prefix);
+    assert(trie.child(*prefix, {r0, ids}) == node_a);
+    assert(trie.child(*prefix, {r1, {}}) == nullptr);
+    assert(node_a->parent == prefix);
+
+    /* c is not in the trie, but a is its longest prefix with a value */
+    assert(trie.find(c) == nullptr);
+    assert(trie.longest_prefix(c) == node_a);
+    assert(trie.longest_prefix(a) == node_a);
+    assert(trie.longest_prefix({{main, {}}, {r0, {}}}) == nullptr);
+    assert(trie.longest_prefix({{r1, {}}}) == nullptr);
+
+    trie.clear();
+    assert(trie.size() == 1);
+    assert(trie.find(a) == nullptr);
+
+    return 0;
+}
+
+TEST_REGISTER("unit_tests/tmm/test-callpath_trie", test)
@@ -1,8 +1,20 @@
 #include "test-registry.hpp"
 
+#include <tmm/parameter_tuple.hpp>
 #include <tmm/tuning_model.hpp>
 
+#include <algorithm>
 #include <fstream>
+#include <sstream>
+#include <string>
+
+static std::size_t count(const std::string &s, const std::string &pattern)
+{
+    std::size_t n = 0;
+    for (auto pos = s.find(pattern); pos != std::string::npos; pos = s.find(pattern, pos + 1))
+        n++;
+    return n;
+}
 
 static int test(const std::string &file_path)
 {
@@ -69,6 +81,74 @@ static int test(const std::string &file_path)
     assert(phases.size() == 3);
     assert(ranges.size() == 1);
 
+    auto stats = tm.statistics();
+    assert(stats.nrts == 3);
+    assert(stats.nscenarios == 4);
+    assert(stats.max_scenarios == 2);
+    assert(stats.nparameters == 3);
+    assert(stats.nclusters == 2);
+    assert((stats.depth_histogram == std::vector<std::size_t>{0, 0, 2, 1}));
+    assert(stats.identifier_cardinality.size() == 3);
+    assert(stats.identifier_cardinality.at(std::hash<std::string>{}("size")) == 2);
+    assert(stats.identifier_cardinality.at(std::hash<std::string>{}("p1")) == 1);
+
+    /* the rts share the nodes of their common prefix */
+    std::ostringstream dot;
+    tm.to_dot(dot);
+    assert(dot.str().find("strict digraph") == 0);
+    assert(count(dot.str(), "shape=box") == 3);
+    assert(count(dot.str(), " -> ") == 4);
+    assert(count(dot.str(), "2 scenarios, 9000 ms") == 1);
+
+    /* a header line and a line per scenario */
+    std::ostringstream matrix;
+    tm.to_matrix(matrix);
+    assert(count(matrix.str(), "\n") == 5);
+    assert(count(matrix.str(), "reg[reg.c:90]") == 1);
+
+    /* a lazily deserialized model answers like the eager one */
+    std::ifstream lazy_is(file_path);
+    tuning_model lazy_tm;
+    lazy_tm.deserialize(lazy_is, true);
+
+    assert(lazy_tm.ncallpaths() == 3);
+    assert(!lazy_tm.has_region(main));
+    assert(lazy_tm.has_region(r0));
+    assert(lazy_tm.nidentifiers(r1) == 1);
+    assert(lazy_tm.is_root({main, {}}));
+    assert(!lazy_tm.is_root({r0, {}}));
+    assert(!lazy_tm.has_rts({{main, {}}}));
+    assert(lazy_tm.configurations({{main, {}}}) == nullptr);
+
+    /* visiting all rts decodes the same scenarios as the eager model */
+    std::size_t nvisited = 0;
+    lazy_tm.for_each_rts([&](const std::vector<callpath_element> &cp,
+                             const std::unordered_map<identifier_set, configuration_t> &scenarios,
+                             std::chrono::milliseconds exectime) {
+        assert(scenarios == *tm.configurations(cp));
+        assert(exectime == tm.exectime(cp));
+        nvisited++;
+    });
+    assert(nvisited == 3);
+    assert(lazy_tm.statistics().nscenarios == stats.nscenarios);
+    assert(lazy_tm.statistics().nparameters == stats.nparameters);
+
+    for (const auto &cp : {cp1, cp2, cp3})
+    {
+        assert(lazy_tm.has_rts(cp));
+        assert(lazy_tm.ninputidsets(cp) == tm.ninputidsets(cp));
+        assert(lazy_tm.exectime(cp) == tm.exectime(cp));
+        assert(*lazy_tm.configurations(cp) == *tm.configurations(cp));
+        assert(lazy_tm.configurations(cp) == lazy_tm.configurations(cp));
+    }
+    assert(lazy_tm.clusters() == tm.clusters());
+
+    /* configurations stored later take precedence over the lazy model */
+    lazy_tm.store_configuration(cp1, {}, std::chrono::milliseconds(50));
+    assert(lazy_tm.ncallpaths() == 3);
+    assert(lazy_tm.exectime(cp1) == std::chrono::milliseconds(50));
+    assert(lazy_tm.configurations(cp1)->begin()->second.empty());
+
     return 0;
 }
 
@@ -0,0 +1,188 @@
+#include "test-registry.hpp"
+
+#include <tmm/binary_model.hpp>
+#include <tmm/dta_tmm.hpp>
+#include <tmm/journal.hpp>
+#include <tmm/tuning_model.hpp>
+
+#include <assert.h>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+using namespace rrl::tmm;
+
+static bool equal(const std::vector<parameter_tuple> &a, const std::vector<parameter_tuple> &b)
+{
+    if (a.size() != b.size())
+        return false;
+    for (std::size_t i = 0; i < a.size(); i++)
+    {
+        if (a[i].parameter_id != b[i].parameter_id ||
+            a[i].parameter_value != b[i].parameter_value)
+            return false;
+    }
+    return true;
+}
+
+static std::vector<journal_entry> read_all(const std::string &file_name)
+{
+    std::vector<journal_entry> entries;
+    read_journal(file_name, [&entries](journal_entry &&e) { entries.push_back(std::move(e)); });
+    return entries;
+}
+
+static void test_journal_path()
+{
+    for (auto name : {"OMPI_COMM_WORLD_RANK", "PMI_RANK", "PMIX_RANK", "SLURM_PROCID"})
+        unsetenv(name);
+    auto pid = std::to_string(getpid());
+
+    /* a single process keeps the path */
+    assert(journal_path("/tmp/journal") == "/tmp/journal");
+    assert(journal_path("/tmp/journal.%r") == "/tmp/journal." + pid);
+    assert(journal_path("/tmp/%%p.%p") == "/tmp/%p." + pid);
+
+    setenv("PMI_RANK", "3", 1);
+    assert(journal_path("/tmp/journal") == "/tmp/journal.3");
+    assert(journal_path("/tmp/journal-%r.bin") == "/tmp/journal-3.bin");
+    assert(journal_path("/tmp/%p-%r") == "/tmp/" + pid + "-3");
+    unsetenv("PMI_RANK");
+}
+
+static void test_dta_tmm(const std::string &file_name)
+{
+    std::remove(file_name.c_str());
+    setenv("SCOREP_RRL_TMM_JOURNAL", file_name.c_str(), 1);
+
+    identifier_set ids;
+    ids.add_identifier("p1", std::uint64_t(7));
+    {
+        dta_tmm tmm;
+        tmm.register_region("main", 1, "main.c", 3);
+        tmm.register_region("r0", 45, "foo.c", 4);
+        tmm.store_configuration(
+            {{3, {}}, {4, ids}}, {parameter_tuple(1, 42)}, std::chrono::milliseconds(10));
+        auto id = tmm.callpaths().intern({{3, {}}, {4, ids}});
+        tmm.store_configuration(id, {parameter_tuple(2, 3)}, std::chrono::milliseconds(20), 5.5);
+    }
+
+    /* the merged configuration is journaled */
+    auto entries = read_all(file_name);
+    assert(entries.size() == 2);
+    assert(std::isnan(entries[0].energy));
+    assert(entries[1].energy == 5.5);
+    assert(equal(entries[1].configuration, {parameter_tuple(1, 42), parameter_tuple(2, 3)}));
+
+    /* a later run resumes the configurations once the regions are registered, even with other
+     * Score-P region ids */
+    {
+        dta_tmm tmm;
+        tmm.register_region("r0", 45, "foo.c", 0);
+        assert(tmm.is_significant(0) != significant);
+        tmm.register_region("main", 1, "main.c", 1);
+        assert(tmm.is_significant(0) == significant);
+        assert(tmm.is_root({1, {}}));
+        auto config = tmm.get_current_rts_configuration({{1, {}}, {0, ids}}, {});
+        assert(equal(config, {parameter_tuple(1, 42), parameter_tuple(2, 3)}));
+    }
+    /* the resumed configurations are not journaled again */
+    assert(read_all(file_name).size() == 2);
+
+    unsetenv("SCOREP_RRL_TMM_JOURNAL");
+    std::remove(file_name.c_str());
+}
+
+static int test(const std::string &file_path)
+{
+    region_id main("main.c", 1, "main");
+    region_id r0("foo.c", 45, "r0");
+    region_id r1("bar.c", 12, "r1");
+    identifier_set ids;
+    ids.add_identifier("p3", std::string("foobar"));
+    ids.add_identifier("p4", std::uint64_t(4));
+    ids.add_identifier("p5", std::int64_t(-5));
+
+    std::vector<callpath_element> cp1({{main, {}}, {r0, ids}});
+    std::vector<callpath_element> cp2({{main, {}}, {r0, {}}, {r1, {}}});
+
+    char file_name[] = "/tmp/test-journalXXXXXX";
+    int fd = mkstemp(file_name);
+    assert(fd != -1);
+    close(fd);
+
+    /* an empty file is an empty journal */
+    assert(read_journal(file_name, [](journal_entry &&) { assert(0); }) == 0);
+    {
+        journal_writer writer(file_name, 2);
+        writer.append(cp1, {parameter_tuple(1, 42)}, std::chrono::milliseconds(100), 1.0);
+        writer.append(cp2, {parameter_tuple(1, 43), parameter_tuple(2, -1)},
+            std::chrono::milliseconds(200), 2.0);
+        writer.append(cp1, {parameter_tuple(1, 44)}, std::chrono::milliseconds(300), 3.0);
+    }
+    assert(is_journal(file_name));
+
+    auto entries = read_all(file_name);
+    assert(entries.size() == 3);
+    assert(entries[0].callpath == cp1);
+    assert(entries[1].callpath == cp2);
+    assert(equal(entries[1].configuration, {parameter_tuple(1, 43), parameter_tuple(2, -1)}));
+    assert(entries[2].exectime == std::chrono::milliseconds(300));
+    assert(entries[2].energy == 3.0);
+
+    /* a record which was not written completely is ignored, and removed by the next writer */
+    auto valid = read_journal(file_name, [](journal_entry &&) {});
+    {
+        std::ofstream os(file_name, std::ios::binary | std::ios::app);
+        os.write("\x40\0\0\0garbage", 11);
+    }
+    assert(read_all(file_name).size() == 3);
+    {
+        journal_writer writer(file_name, 1);
+        writer.append(cp2, {parameter_tuple(1, 45)}, std::chrono::milliseconds(400), 4.0);
+    }
+    assert(read_journal(file_name, [](journal_entry &&) {}) > valid);
+    assert(read_all(file_name).size() == 4);
+
+    /* the last entry of a callpath wins */
+    tuning_model tm;
+    assert(replay_journal(file_name, tm) == 4);
+    assert(tm.ncallpaths() == 2);
+    assert(tm.exectime(cp1) == std::chrono::milliseconds(300));
+    assert(tm.exectime(cp2) == std::chrono::milliseconds(400));
+    assert(tm.configurations(cp1)->at(identifier_set()).at(1) == 44);
+    assert(tm.configurations(cp2)->at(identifier_set()).at(1) == 45);
+    assert(!tm.has_region(main));
+    assert(tm.has_region(r0));
+    assert(tm.has_region(r1));
+    assert(tm.nidentifiers(r0) == 3);
+    assert(tm.is_root({main, {}}));
+
+    /* the replayed model can be converted like a JSON model */
+    char binary_name[] = "/tmp/test-journal-binaryXXXXXX";
+    fd = mkstemp(binary_name);
+    assert(fd != -1);
+    close(fd);
+    {
+        std::ofstream os(binary_name, std::ios::binary);
+        binary_model::write(tm, os);
+    }
+    tuning_model binary_tm;
+    binary_tm.load_binary(binary_model::map(binary_name));
+    assert(binary_tm.has_region(r1));
+    assert(binary_tm.exectime(cp2) == std::chrono::milliseconds(400));
+    std::remove(binary_name);
+
+    assert(!is_journal(file_path));
+    test_journal_path();
+    test_dta_tmm(file_name);
+
+    return 0;
+}
+
+TEST_REGISTER("unit_tests/tmm/test-journal", test)
@@ -0,0 +1,94 @@
+#include "test-registry.hpp"
+
+#include <tmm/binary_model.hpp>
+#include <tmm/model_distribution.hpp>
+#include <tmm/parameter_tuple.hpp>
+#include <tmm/tuning_model.hpp>
+
+#include <fstream>
+#include <stdexcept>
+
+#include <mpi.h>
+#include <unistd.h>
+
+using namespace rrl::tmm;
+
+/** Has to be started with several ranks, e.g. mpirun -n 4 test-runner
+ * unit_tests/tmm/test-model_distribution
+ */
+static void test_distribution(const std::string &json_path)
+{
+    int rank;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+    region_id main("main.c", 1, "main");
+    region_id r0("foo.c", 45, "r0");
+    identifier_set ids;
+    ids.add_identifier("p3", std::string("foobar"));
+    std::vector<callpath_element> cp({{main, {}}, {r0, ids}});
+
+    /* only rank 0 has the file */
+    char file_name[] = "/tmp/test-model_distributionXXXXXX";
+    if (rank == 0)
+    {
+        tuning_model tm;
+        tm.store_configuration(cp, {parameter_tuple(1, 42)}, std::chrono::milliseconds(100));
+
+        int fd = mkstemp(file_name);
+        assert(fd != -1);
+        close(fd);
+        std::ofstream os(file_name, std::ios::binary);
+        binary_model::write(tm, os);
+    }
+    MPI_Bcast(file_name, sizeof(file_name), MPI_CHAR, 0, MPI_COMM_WORLD);
+
+    {
+        tuning_model tm;
+        tm.load_binary(distribute_tuning_model(file_name, MPI_COMM_WORLD));
+        assert(tm.ncallpaths() == 1);
+        assert(tm.has_rts(cp));
+        assert(tm.exectime(cp) == std::chrono::milliseconds(100));
+        assert(tm.configurations(cp)->begin()->second.at(1) == 42);
+        assert(tm.is_root({main, {}}));
+    }
+    MPI_Barrier(MPI_COMM_WORLD);
+    if (rank == 0)
+    {
+        std::remove(file_name);
+    }
+
+    /* a JSON model is converted by rank 0 */
+    {
+        tuning_model tm;
+        tm.load_binary(distribute_tuning_model(json_path, MPI_COMM_WORLD));
+        assert(tm.ncallpaths() == 3);
+        assert(tm.has_region(region_id("foo.c", 45, "r0")));
+        assert(tm.clusters().size() == 2);
+    }
+
+    /* all ranks fail, if rank 0 cannot read the model */
+    bool thrown = false;
+    try
+    {
+        distribute_tuning_model("/nonexistent/tuning_model.json", MPI_COMM_WORLD);
+    }
+    catch (std::runtime_error &)
+    {
+        thrown = true;
+    }
+    assert(thrown);
+}
+
+static int test(const std::string &file_path)
+{
+    MPI_Init(nullptr, nullptr);
+
+    /* uses the model of test-deserialization */
+    auto directory = file_path.substr(0, file_path.find_last_of('/'));
+    test_distribution(directory + "/test-deserialization.json");
+
+    MPI_Finalize();
+    return 0;
+}
+
+TEST_REGISTER("unit_tests/tmm/test-model_distribution", test)
@@ -0,0 +1,113 @@
+#include "test-registry.hpp"
+
+#include <tmm/binary_model.hpp>
+#include <tmm/journal.hpp>
+#include <tmm/model_merge.hpp>
+#include <tmm/tuning_model.hpp>
+
+#include <assert.h>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+
+#include <unistd.h>
+
+using namespace rrl::tmm;
+
+static std::string temp_file(const std::string &prefix)
+{
+    std::string name = "/tmp/" + prefix + "XXXXXX";
+    int fd = mkstemp(&name[0]);
+    assert(fd != -1);
+    close(fd);
+    return name;
+}
+
+static int test(const std::string &file_path)
+{
+    region_id main("main.c", 1, "main");
+    region_id r0("foo.c", 45, "r0");
+    region_id r1("bar.c", 12, "r1");
+    identifier_set ids;
+    ids.add_identifier("p1", std::uint64_t(4));
+
+    std::vector<callpath_element> cp1({{main, {}}, {r0, {}}});
+    std::vector<callpath_element> cp2({{main, {}}, {r1, {}}});
+    std::vector<callpath_element> cp3({{main, {}}, {r0, {}}, {r1, {}}});
+
+    auto journal_a = temp_file("test-model_merge-a");
+    auto journal_b = temp_file("test-model_merge-b");
+    auto binary_c = temp_file("test-model_merge-c");
+    {
+        journal_writer writer(journal_a, 32);
+        writer.append(cp1, {parameter_tuple(1, 10)}, std::chrono::milliseconds(100), 5.0);
+        writer.append(cp2, {parameter_tuple(1, 20)}, std::chrono::milliseconds(100), std::nan(""));
+    }
+    {
+        /* the last entry of a callpath in a journal wins, even if its energy is higher */
+        journal_writer writer(journal_b, 32);
+        writer.append(cp1, {parameter_tuple(1, 11)}, std::chrono::milliseconds(50), 1.0);
+        writer.append(cp2, {parameter_tuple(1, 21)}, std::chrono::milliseconds(80), std::nan(""));
+        writer.append(cp1, {parameter_tuple(1, 12)}, std::chrono::milliseconds(50), 3.0);
+    }
+    {
+        tuning_model tm;
+        tm.store_scenario(cp2, identifier_set(), {{1, 22}}, std::chrono::milliseconds(80));
+        tm.store_scenario(cp3, identifier_set(), {{2, 1}}, std::chrono::milliseconds(30));
+        tm.store_scenario(cp3, ids, {{2, 2}}, std::chrono::milliseconds(30));
+        tm.add_cluster(1, {{1, 2}, {{"duration", {0.5, 1.5}}}});
+        std::ofstream os(binary_c, std::ios::binary);
+        binary_model::write(tm, os);
+    }
+
+    /* the inputs are merged in an arbitrary order */
+    model_merger merger;
+    merger.add_file(binary_c, 2);
+    model_merger other;
+    other.add_file(journal_b, 1);
+    other.add_file(journal_a, 0);
+    merger.merge(std::move(other));
+
+    assert(merger.nscenarios() == 4);
+    assert(merger.nconflicts() == 2);
+
+    tuning_model tm;
+    merger.store(tm);
+    assert(tm.ncallpaths() == 3);
+    /* lower energy */
+    assert(tm.configurations(cp1)->at(identifier_set()).at(1) == 12);
+    /* lower execution time, then the earlier input */
+    assert(tm.configurations(cp2)->at(identifier_set()).at(1) == 21);
+    assert(tm.exectime(cp2) == std::chrono::milliseconds(80));
+    assert(tm.configurations(cp3)->size() == 2);
+    assert(tm.configurations(cp3)->at(ids).at(2) == 2);
+    assert(tm.has_region(r0));
+    assert(tm.has_region(r1));
+    assert(tm.clusters().size() == 1);
+    assert(tm.clusters().at(1).second.at("duration").second == 1.5);
+
+    /* a JSON model is merged with all its scenarios */
+    auto json_path = file_path.substr(0, file_path.find_last_of('/')) + "/test-deserialization.json";
+    tuning_model json_tm;
+    {
+        std::ifstream is(json_path);
+        json_tm.deserialize(is);
+    }
+    std::size_t nscenarios = 0;
+    json_tm.for_each_rts([&nscenarios](const std::vector<callpath_element> &,
+                             const std::unordered_map<identifier_set, configuration_t> &scenarios,
+                             std::chrono::milliseconds) { nscenarios += scenarios.size(); });
+    model_merger json_merger;
+    json_merger.add_file(json_path, 0);
+    assert(json_merger.nscenarios() == nscenarios);
+    assert(json_merger.nconflicts() == 0);
+
+    std::remove(journal_a.c_str());
+    std::remove(journal_b.c_str());
+    std::remove(binary_c.c_str());
+    return 0;
+}
+
+TEST_REGISTER("unit_tests/tmm/test-model_merge", test)
@@ -0,0 +1,206 @@
+#include "test-registry.hpp"
+
+#include <tmm/binary_model.hpp>
+#include <tmm/dta_tmm.hpp>
+#include <tmm/rat_tmm.hpp>
+#include <tmm/tuning_model.hpp>
+
+#include <assert.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include <unistd.h>
+
+using namespace rrl::tmm;
+
+static const region_id main_region("main.c", 1, "main");
+static const region_id r0("foo.c", 45, "r0");
+static const region_id r1("bar.c", 12, "r1");
+static const region_id r2("baz.c", 7, "r2");
+
+static std::string temp_file(const std::string &prefix)
+{
+    std::string name = "/tmp/" + prefix + "XXXXXX";
+    int fd = mkstemp(&name[0]);
+    assert(fd != -1);
+    close(fd);
+    return name;
+}
+
+/** writes a model with rts for r0 and r1, and optionally for r2 and a cluster
+ */
+static void write_model(const std::string &file_path, int r1_value, bool with_r2, bool cluster)
+{
+    tuning_model tm;
+    auto exectime = std::chrono::milliseconds(200);
+    tm.store_scenario({{main_region, {}}, {r0, {}}}, {}, {{1, 1}}, exectime);
+    tm.store_scenario({{main_region, {}}, {r1, {}}}, {}, {{1, r1_value}}, exectime);
+    if (with_r2)
+        tm.store_scenario({{main_region, {}}, {r2, {}}}, {}, {{1, 4}}, exectime);
+    if (cluster)
+        tm.add_cluster(1, {{1}, {{"duration", {0.0, 1.0}}}});
+    std::ofstream os(file_path, std::ios::binary);
+    binary_model::write(tm, os);
+}
+
+static int value_of(const std::vector<parameter_tuple> &configuration)
+{
+    assert(configuration.size() == 1);
+    return configuration[0].parameter_value;
+}
+
+static void register_regions(rat_tmm &tmm)
+{
+    tmm.register_region("main", 1, "main.c", 0);
+    tmm.register_region("r0", 45, "foo.c", 1);
+    tmm.register_region("r1", 12, "bar.c", 2);
+    tmm.register_region("r2", 7, "baz.c", 3);
+}
+
+static void test_watch(const std::string &file_path)
+{
+    write_model(file_path, 2, false, false);
+    setenv("SCOREP_RRL_TMM_RELOAD", "watch", 1);
+    setenv("SCOREP_RRL_TMM_RELOAD_INTERVAL_MS", "5", 1);
+    rat_tmm tmm(file_path);
+    unsetenv("SCOREP_RRL_TMM_RELOAD");
+    unsetenv("SCOREP_RRL_TMM_RELOAD_INTERVAL_MS");
+    register_regions(tmm);
+    assert(tmm.is_significant(3) == insignificant);
+
+    /* the new model is written next to the old one and renamed */
+    auto new_path = file_path + ".new";
+    write_model(new_path, 3, true, false);
+    assert(std::rename(new_path.c_str(), file_path.c_str()) == 0);
+
+    for (int n = 0; n < 1000 && !tmm.has_changed(); n++)
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    assert(tmm.has_changed());
+    auto change = tmm.take_change();
+    assert(!change.all);
+    assert(change.regions == std::vector<std::uint32_t>{3});
+    assert(tmm.is_significant(3) == significant);
+}
+
+/** a broadcasted model is shared by the ranks of a node, it is not reloaded */
+static void test_broadcast(const std::string &file_path)
+{
+    write_model(file_path, 2, false, false);
+    setenv("SCOREP_RRL_TMM_DISTRIBUTION", "broadcast", 1);
+    setenv("SCOREP_RRL_TMM_RELOAD", "watch", 1);
+    setenv("SCOREP_RRL_TMM_RELOAD_INTERVAL_MS", "5", 1);
+    rat_tmm tmm(file_path);
+    unsetenv("SCOREP_RRL_TMM_DISTRIBUTION");
+    unsetenv("SCOREP_RRL_TMM_RELOAD");
+    unsetenv("SCOREP_RRL_TMM_RELOAD_INTERVAL_MS");
+    register_regions(tmm);
+
+    /* without MPI, init_mpp reads the model from the file */
+    tmm.init_mpp();
+    assert(tmm.has_changed());
+    tmm.take_change();
+    assert(tmm.is_significant(2) == significant);
+
+    bool thrown = false;
+    try
+    {
+        tmm.reload(file_path);
+    }
+    catch (std::runtime_error &)
+    {
+        thrown = true;
+    }
+    assert(thrown && !tmm.has_changed());
+
+    /* the file is not watched */
+    auto new_path = file_path + ".new";
+    write_model(new_path, 3, true, false);
+    assert(std::rename(new_path.c_str(), file_path.c_str()) == 0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    assert(!tmm.has_changed());
+    assert(tmm.is_significant(3) == insignificant);
+}
+
+static int test(const std::string &)
+{
+    auto file_a = temp_file("test-model_reload-a");
+    auto file_b = temp_file("test-model_reload-b");
+    auto file_c = temp_file("test-model_reload-c");
+    write_model(file_a, 2, false, false);
+    write_model(file_b, 3, true, false);
+    write_model(file_c, 2, false, true);
+
+    rat_tmm tmm(file_a);
+    register_regions(tmm);
+    std::unordered_map<std::string, std::string> input_identifiers;
+    auto cp0 = tmm.callpaths().intern({{0, {}}, {1, {}}});
+    auto cp1 = tmm.callpaths().intern({{0, {}}, {2, {}}});
+    auto cp2 = tmm.callpaths().intern({{0, {}}, {3, {}}});
+    assert(value_of(tmm.get_current_rts_configuration(cp1, input_identifiers)) == 2);
+    assert(tmm.get_current_rts_configuration(cp2, input_identifiers).empty());
+    assert(tmm.is_significant(3) == insignificant);
+    assert(!tmm.has_changed());
+
+    /* the new model is only used once the change is taken */
+    tmm.reload(file_b);
+    assert(tmm.has_changed());
+    assert(value_of(tmm.get_current_rts_configuration(cp1, input_identifiers)) == 2);
+    auto change = tmm.take_change();
+    assert(!tmm.has_changed());
+
+    /* only the changed callpaths and regions are reported */
+    assert(!change.all);
+    assert((change.callpaths == std::vector<callpath_id>{cp1, cp2}));
+    assert(change.regions == std::vector<std::uint32_t>{3});
+    assert(value_of(tmm.get_current_rts_configuration(cp0, input_identifiers)) == 1);
+    assert(value_of(tmm.get_current_rts_configuration(cp1, input_identifiers)) == 3);
+    assert(value_of(tmm.get_current_rts_configuration(cp2, input_identifiers)) == 4);
+    assert(tmm.is_significant(3) == significant);
+
+    /* different clusters affect all nodes */
+    tmm.reload(file_c);
+    change = tmm.take_change();
+    assert(change.all);
+    assert(tmm.is_significant(3) == insignificant);
+    assert(tmm.get_current_rts_configuration(cp2, input_identifiers).empty());
+
+    /* a model that cannot be read keeps the current one */
+    bool thrown = false;
+    try
+    {
+        tmm.reload("/nonexistent/model.json");
+    }
+    catch (std::runtime_error &)
+    {
+        thrown = true;
+    }
+    assert(thrown && !tmm.has_changed());
+
+    /* the tmm of the calibration mode cannot reload */
+    thrown = false;
+    try
+    {
+        dta_tmm dta;
+        dta.reload(file_a);
+    }
+    catch (std::runtime_error &)
+    {
+        thrown = true;
+    }
+    assert(thrown);
+
+    test_watch(file_a);
+    test_broadcast(file_a);
+
+    std::remove(file_a.c_str());
+    std::remove(file_b.c_str());
+    std::remove(file_c.c_str());
+    return 0;
+}
+
+TEST_REGISTER("unit_tests/tmm/test-model_reload", test)
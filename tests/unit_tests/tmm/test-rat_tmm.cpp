@@ -2,6 +2,17 @@
 
 #include <tmm/rat_tmm.hpp>
 
+#include <algorithm>
+#include <cstdlib>
+
+static bool equal(const std::vector<rrl::tmm::parameter_tuple> &a,
+    const std::vector<rrl::tmm::parameter_tuple> &b)
+{
+    return std::equal(a.begin(), a.end(), b.begin(), b.end(), [](const auto &x, const auto &y) {
+        return x.parameter_id == y.parameter_id && x.parameter_value == y.parameter_value;
+    });
+}
+
 static int test(const std::string &file_path)
 {
     using namespace rrl::tmm;
@@ -44,6 +55,37 @@ static int test(const std::string &file_path)
 
     tmm.store_configuration({cpe1, cpe2}, {pt}, ms);
 
+    /* interned callpaths are resolved to the trie of the tuning model */
+    auto known = tmm.callpaths().intern({{0, ids2}, {2, {ids0}}});
+    auto deeper = tmm.callpaths().intern({{0, ids2}, {2, {ids0}}, {1, ids2}});
+    assert(equal(tmm.get_current_rts_configuration(known, input_identifiers),
+        tmm.get_current_rts_configuration({{0, ids2}, {2, {ids0}}}, input_identifiers)));
+    assert(tmm.get_exectime(known).count() == 10000);
+    assert(tmm.get_current_rts_configuration(deeper, input_identifiers).empty());
+
+    /* with the prefix fallback, unknown callpaths use the rts of their longest known prefix */
+    setenv("SCOREP_RRL_TMM_PREFIX_FALLBACK", "true", 1);
+    rat_tmm fallback_tmm(file_path);
+    unsetenv("SCOREP_RRL_TMM_PREFIX_FALLBACK");
+    fallback_tmm.register_region("main", 12, "main.c", 0);
+    fallback_tmm.register_region("reg", 45, "reg.c", 1);
+    fallback_tmm.register_region("r0", 45, "file.c", 2);
+    deeper = fallback_tmm.callpaths().intern({{0, ids2}, {2, {ids0}}, {1, ids2}});
+    assert(equal(fallback_tmm.get_current_rts_configuration(deeper, input_identifiers),
+        tmm.get_current_rts_configuration(known, input_identifiers)));
+    assert(fallback_tmm.get_exectime(deeper).count() == 10000);
+    auto unknown = fallback_tmm.callpaths().intern({{0, ids2}, {1, ids1}});
+    assert(fallback_tmm.get_current_rts_configuration(unknown, input_identifiers).empty());
+
+    /* a configuration stored for a callpath replaces the prefix its descendants use */
+    auto deepest = fallback_tmm.callpaths().intern({{0, ids2}, {2, {ids0}}, {1, ids2}, {1, ids1}});
+    assert(equal(fallback_tmm.get_current_rts_configuration(deepest, input_identifiers),
+        tmm.get_current_rts_configuration(known, input_identifiers)));
+    fallback_tmm.store_configuration(deeper, {parameter_tuple(7, 3)}, ms);
+    assert(equal(fallback_tmm.get_current_rts_configuration(deepest, input_identifiers),
+        {parameter_tuple(7, 3)}));
+    assert(fallback_tmm.get_exectime(deepest) == ms);
+
     return 0;
 }
 
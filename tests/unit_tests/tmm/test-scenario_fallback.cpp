@@ -0,0 +1,69 @@
+#include "test-registry.hpp"
+
+#include <tmm/scenario_fallback.hpp>
+
+#include <assert.h>
+#include <stdexcept>
+#include <string>
+
+static int test(const std::string &file_path)
+{
+    using namespace rrl::tmm;
+
+    auto scenario = [](std::int64_t size, const std::string &mode) {
+        identifier_set ids;
+        ids.add_identifier("size", size);
+        ids.add_identifier("mode", mode);
+        return ids;
+    };
+    configuration_t slow({{1, 1200}});
+    configuration_t fast({{1, 2400}});
+
+    scenario_fallback::scenario_map scenarios({{scenario(10, "a"), slow},
+        {scenario(100, "a"), fast},
+        {scenario(1000, "a"), fast},
+        {scenario(20, "b"), fast}});
+
+    std::unordered_map<int, phase_data_t> clusters;
+    clusters[1] = phase_data_t({1, 2}, {{"size", {0.0, 50.0}}});
+    clusters[2] = phase_data_t({3}, {{"size", {51.0, 5000.0}}});
+
+    /* nearest numeric identifier, scenarios with other strings are skipped */
+    scenario_fallback nearest(fallback_mode::nearest, scenarios, clusters);
+    assert(*nearest.select({{"size", "120"}, {"mode", "a"}}) == fast);
+    assert(*nearest.select({{"size", "30"}, {"mode", "a"}}) == slow);
+    assert(*nearest.select({{"size", "30"}, {"mode", "b"}}) == fast);
+    assert(nearest.select({{"size", "30"}, {"mode", "c"}}) == nullptr);
+    assert(*nearest.select({{"size", "12"}}) == slow);
+
+    scenario_fallback majority(fallback_mode::majority, scenarios, clusters);
+    assert(*majority.select({{"size", "12"}}) == fast);
+    assert(*majority.select({}) == fast);
+
+    /* cluster 1 contains the scenarios 10 and 20, which have different configurations */
+    scenario_fallback cluster(fallback_mode::cluster, scenarios, clusters);
+    auto config = cluster.select({{"size", "42"}});
+    assert(config != nullptr && (*config == slow || *config == fast));
+    assert(*cluster.select({{"size", "3000"}}) == fast);
+    assert(cluster.select({{"size", "6000"}}) == nullptr);
+    assert(cluster.select({{"size", "large"}}) == nullptr);
+
+    scenario_fallback none(fallback_mode::none, scenarios, clusters);
+    assert(none.select({{"size", "100"}}) == nullptr);
+
+    assert(parse_fallback_mode("nearest") == fallback_mode::nearest);
+    bool thrown = false;
+    try
+    {
+        parse_fallback_mode("closest");
+    }
+    catch (std::invalid_argument &)
+    {
+        thrown = true;
+    }
+    assert(thrown);
+
+    return 0;
+}
+
+TEST_REGISTER("unit_tests/tmm/test-scenario_fallback", test)
@@ -0,0 +1,69 @@
+#include "test-registry.hpp"
+
+#include <tmm/callpath.hpp>
+#include <tmm/region.hpp>
+#include <tmm/string_pool.hpp>
+
+#include <assert.h>
+#include <functional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using namespace rrl::tmm;
+
+static int test(const std::string &)
+{
+    auto &pool = string_pool::instance();
+
+    /* the empty string is a default constructed symbol */
+    assert(symbol() == symbol(""));
+    assert(symbol().empty());
+    assert(symbol().str().empty());
+
+    symbol a("test-string_pool-a");
+    symbol b("test-string_pool-b");
+    assert(a != b);
+    assert(symbol(std::string("test-string_pool-a")) == a);
+    assert(a.str() == "test-string_pool-a");
+    assert(a.hash() == std::hash<std::string>{}("test-string_pool-a"));
+
+    /* strings are interned from several threads at the same time, and span several chunks */
+    const int nthreads = 4;
+    const int nstrings = 1000;
+    std::vector<std::vector<std::uint32_t>> ids(nthreads);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < nthreads; t++)
+    {
+        threads.emplace_back([&ids, t]() {
+            for (int n = 0; n < nstrings; n++)
+                ids[t].push_back(symbol("test-string_pool-" + std::to_string(n)).id());
+        });
+    }
+    for (auto &thread : threads)
+        thread.join();
+    for (int t = 1; t < nthreads; t++)
+        assert(ids[t] == ids[0]);
+    for (int n = 0; n < nstrings; n++)
+        assert(pool.str(ids[0][n]) == "test-string_pool-" + std::to_string(n));
+    assert(pool.size() >= nstrings + 3);
+
+    /* the hashes of regions and callpath elements do not change with interning */
+    region_id rid("foo.c", 45, "r0");
+    assert(rid.file.str() == "foo.c" && rid.name.str() == "r0");
+    assert(std::hash<region_id>{}(rid) ==
+           rrl::hash::finalize(rrl::hash::combine(45, std::hash<std::string>{}("r0"))));
+    /* regions only differ in their file, see region_id::operator== */
+    assert(rid == region_id("/path/to/foo.c", 45, "r0"));
+    assert(rid != region_id("foo.c", 46, "r0"));
+
+    callpath_element cpe(rid, identifier_set());
+    assert(cpe.name() == "r0" && cpe.file() == "foo.c");
+    std::unordered_map<region_id, int> regions;
+    regions[rid] = 1;
+    assert(regions.at(region_id("foo.c", 45, "r0")) == 1);
+    return 0;
+}
+
+TEST_REGISTER("unit_tests/tmm/test-string_pool", test)
@@ -0,0 +1,155 @@
+#include <tmm/binary_model.hpp>
+#include <tmm/model_merge.hpp>
+#include <tmm/tuning_model.hpp>
+
+#include <atomic>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+void print_help()
+{
+    std::cout << "tmmerge - merge the tuning models and journals of several processes\n";
+    std::cout << "USAGE: tmmerge [OPTIONS] -o out [file...]\n";
+    std::cout << "file is a tuning model in the JSON or in the binary format, or a journal of a\n";
+    std::cout << "calibration run. If several files have a configuration for the same scenario,\n";
+    std::cout << "the one with the lowest energy wins, then the one with the lowest execution\n";
+    std::cout << "time, then the first file.\n";
+    std::cout << "OPTIONS:\n";
+    std::cout << "-o out\twrite the merged tuning model in the binary format to out\n";
+    std::cout << "-l list\tmerge the files listed in list as well, one per line\n";
+    std::cout << "-t n\tread the files with n threads (default: number of cores)\n";
+}
+
+class cmdargs final
+{
+public:
+    inline cmdargs() : nthreads(std::thread::hardware_concurrency())
+    {
+    }
+
+    unsigned nthreads;
+    std::string out_file;
+    std::vector<std::string> files;
+};
+
+cmdargs parse_args(int argc, char *argv[])
+{
+    cmdargs args;
+    for (int n = 1; n < argc; n++)
+    {
+        std::string arg = argv[n];
+        if (arg == "-o" && n + 1 < argc)
+        {
+            args.out_file = argv[++n];
+        }
+        else if (arg == "-l" && n + 1 < argc)
+        {
+            std::ifstream is(argv[++n]);
+            if (!is.is_open())
+            {
+                std::cerr << "cannot open " << argv[n] << "\n";
+                exit(1);
+            }
+            std::string line;
+            while (std::getline(is, line))
+                if (!line.empty())
+                    args.files.push_back(line);
+        }
+        else if (arg == "-t" && n + 1 < argc)
+        {
+            args.nthreads = std::stoul(argv[++n]);
+        }
+        else if (!arg.empty() && arg[0] == '-')
+        {
+            print_help();
+            exit(1);
+        }
+        else
+        {
+            args.files.push_back(arg);
+        }
+    }
+
+    if (args.out_file.empty() || args.files.empty())
+    {
+        print_help();
+        exit(1);
+    }
+    if (args.nthreads == 0)
+        args.nthreads = 1;
+
+    return args;
+}
+
+/** Merges the files with nthreads threads. Each thread reads one file at a time into its own
+ * merger, the mergers are merged at the end.
+ */
+rrl::tmm::model_merger merge_files(const std::vector<std::string> &files, unsigned nthreads)
+{
+    std::vector<rrl::tmm::model_merger> mergers(nthreads);
+    std::vector<std::exception_ptr> errors(nthreads);
+    std::atomic<std::size_t> next(0);
+
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < nthreads; t++)
+    {
+        threads.emplace_back([&files, &mergers, &errors, &next, t]() {
+            try
+            {
+                for (auto n = next++; n < files.size(); n = next++)
+                    mergers[t].add_file(files[n], n);
+            }
+            catch (...)
+            {
+                errors[t] = std::current_exception();
+                next = files.size();
+            }
+        });
+    }
+    for (auto &thread : threads)
+        thread.join();
+
+    for (const auto &error : errors)
+        if (error)
+            std::rethrow_exception(error);
+
+    for (unsigned t = 1; t < nthreads; t++)
+        mergers[0].merge(std::move(mergers[t]));
+    return std::move(mergers[0]);
+}
+
+int main(int argc, char *argv[])
+{
+    cmdargs args = parse_args(argc, argv);
+
+    rrl::tmm::model_merger merger;
+    try
+    {
+        merger = merge_files(args.files, args.nthreads);
+    }
+    catch (std::exception &e)
+    {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+
+    rrl::tmm::tuning_model tm;
+    merger.store(tm);
+
+    std::ofstream os(args.out_file, std::ios::binary);
+    rrl::tmm::binary_model::write(tm, os);
+    if (!os)
+    {
+        std::cerr << "cannot write " << args.out_file << "\n";
+        return 1;
+    }
+
+    std::cout << "merged " << args.files.size() << " files: " << tm.ncallpaths() << " rts, "
+              << merger.nscenarios() << " scenarios, " << merger.nconflicts()
+              << " scenarios with conflicting configurations\n";
+    return 0;
+}
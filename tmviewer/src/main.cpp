@@ -1,27 +1,38 @@
+#include <tmm/binary_model.hpp>
+#include <tmm/journal.hpp>
 #include <tmm/tuning_model.hpp>
 
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <memory>
+#include <utility>
+#include <vector>
 
 void print_help()
 {
     std::cout << "tmviewer - print tuning model\n";
     std::cout << "USAGE: tmviewer [OPTIONS] file\n";
+    std::cout << "file is a tuning model in the JSON or in the binary format, a journal of a\n";
+    std::cout << "calibration run, or - for a JSON tuning model from stdin.\n";
     std::cout << "OPTIONS:\n";
     std::cout << "-d\tprint tuning model as dot\n";
     std::cout << "-m\tprint tuning model as matrix\n";
+    std::cout << "-s\tprint statistics of the tuning model\n";
+    std::cout << "-b out\twrite tuning model in the binary format to out\n";
 }
 
 class cmdargs final
 {
 public:
-    inline cmdargs() : print_dot(false), print_mat(false)
+    inline cmdargs() : print_dot(false), print_mat(false), print_stats(false)
     {
     }
 
     bool print_dot;
     bool print_mat;
+    bool print_stats;
+    std::string binary_file;
     std::string file;
 };
 
@@ -45,6 +56,14 @@ cmdargs parse_args(int argc, char *argv[])
         {
             args.print_mat = true;
         }
+        else if (arg == "-s")
+        {
+            args.print_stats = true;
+        }
+        else if (arg == "-b" && n + 1 < argc - 1)
+        {
+            args.binary_file = argv[++n];
+        }
         else
         {
             print_help();
@@ -56,6 +75,31 @@ cmdargs parse_args(int argc, char *argv[])
     return args;
 }
 
+void print_statistics(const rrl::tmm::tuning_model_statistics &stats)
+{
+    std::cout << "rts: " << stats.nrts << "\n";
+    std::cout << "scenarios: " << stats.nscenarios << " (at most " << stats.max_scenarios
+              << " per rts)\n";
+    std::cout << "parameters: " << stats.nparameters << "\n";
+    std::cout << "clusters: " << stats.nclusters << "\n";
+    std::cout << "callpath length histogram:\n";
+    for (std::size_t depth = 0; depth < stats.depth_histogram.size(); depth++)
+        if (stats.depth_histogram[depth] > 0)
+            std::cout << "\t" << depth << ": " << stats.depth_histogram[depth] << "\n";
+
+    std::vector<std::pair<std::size_t, std::size_t>> cardinality(
+        stats.identifier_cardinality.begin(), stats.identifier_cardinality.end());
+    std::sort(cardinality.begin(),
+        cardinality.end(),
+        [](const std::pair<std::size_t, std::size_t> &a,
+            const std::pair<std::size_t, std::size_t> &b) {
+            return a.second > b.second || (a.second == b.second && a.first < b.first);
+        });
+    std::cout << "identifier values (by identifier id):\n";
+    for (const auto &identifier : cardinality)
+        std::cout << "\t" << identifier.first << ": " << identifier.second << "\n";
+}
+
 int main(int argc, char *argv[])
 {
     cmdargs args = parse_args(argc, argv);
@@ -65,17 +109,39 @@ int main(int argc, char *argv[])
     {
         tm.deserialize(std::cin);
     }
+    else if (rrl::tmm::binary_model::is_binary(args.file))
+    {
+        tm.load_binary(rrl::tmm::binary_model::map(args.file));
+    }
+    else if (rrl::tmm::is_journal(args.file))
+    {
+        rrl::tmm::replay_journal(args.file, tm);
+    }
     else
     {
         std::ifstream is(args.file);
         tm.deserialize(is);
     }
 
+    if (!args.binary_file.empty())
+    {
+        std::ofstream os(args.binary_file, std::ios::binary);
+        rrl::tmm::binary_model::write(tm, os);
+        if (!os)
+        {
+            std::cerr << "cannot write " << args.binary_file << "\n";
+            return 1;
+        }
+    }
+
     if (args.print_dot)
-        std::cout << tm.to_dot();
+        tm.to_dot(std::cout);
 
     if (args.print_mat)
-        std::cout << tm.to_matrix();
+        tm.to_matrix(std::cout);
+
+    if (args.print_stats)
+        print_statistics(tm.statistics());
 
     return 0;
 }